@@ -0,0 +1,34 @@
+#include "coffee_timer.h"
+#include <stdlib.h>
+
+// ============================================================
+// Bump arena: one heap block handed out front to back and freed
+// in one go, for load phases that would otherwise malloc and
+// free per item
+// ============================================================
+bool arena_init(Arena* a, size_t size) {
+    a->base = malloc(size);
+    a->size = a->base ? size : 0;
+    a->used = 0;
+    return a->base != NULL;
+}
+
+// 8-byte aligned; NULL once the block is used up
+void* arena_alloc(Arena* a, size_t n) {
+    size_t at = (a->used + 7) & ~(size_t)7;
+    if(at > a->size || n > a->size - at) return NULL;
+    a->used = at + n;
+    return a->base + at;
+}
+
+// Everything allocated after mark is given back
+void arena_rewind(Arena* a, size_t mark) {
+    if(mark < a->used) a->used = mark;
+}
+
+void arena_release(Arena* a) {
+    free(a->base);
+    a->base = NULL;
+    a->size = 0;
+    a->used = 0;
+}
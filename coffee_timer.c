@@ -3,29 +3,6 @@
 #include <string.h>
 #include <coffee_timer_icons.h>
 
-// ============================================================
-// LED / sound sequences
-// ============================================================
-static const NotificationSequence seq_led_green = {
-    &message_green_255, &message_delay_100, &message_green_0, NULL,
-};
-static const NotificationSequence seq_led_orange = {
-    &message_red_255, &message_green_255, &message_delay_100,
-    &message_red_0, &message_green_0, NULL,
-};
-static const NotificationSequence seq_led_red_blink = {
-    &message_red_255, &message_delay_50, &message_red_0,
-    &message_delay_50, &message_red_255, &message_delay_50, &message_red_0, NULL,
-};
-static const NotificationSequence seq_beep = {
-    &message_note_c7, &message_delay_50, &message_sound_off, NULL,
-};
-static const NotificationSequence seq_beep_done = {
-    &message_note_c7, &message_delay_100, &message_sound_off,
-    &message_delay_50,
-    &message_note_e7, &message_delay_100, &message_sound_off, NULL,
-};
-
 // ============================================================
 // Helpers
 // ============================================================
@@ -33,30 +10,16 @@ static void fmt_time(uint32_t sec, char* b, size_t n) {
     snprintf(b, n, "%lu:%02lu", (unsigned long)(sec / 60), (unsigned long)(sec % 60));
 }
 
-static const char* step_badge(StepType t) {
-    switch(t) {
-    case StepAdd:   return "ADD";
-    case StepStir:  return "STIR";
-    case StepWait:  return "WAIT";
-    case StepPress: return "PRESS";
-    case StepFlip:  return "FLIP";
-    case StepPrep:  return "PREP";
-    case StepPour:  return "POUR";
-    case StepSwirl: return "SWIRL";
-    default:        return "?";
-    }
-}
-
 // ============================================================
 // Unified recipe accessors
 // ============================================================
 static const char* get_rname(CoffeeApp* a) {
     return a->s.using_custom ? a->custom[a->s.cur_recipe].name :
-        methods[a->s.cur_method].recipes[a->s.cur_recipe].name;
+        rstr(methods[a->s.cur_method].recipes[a->s.cur_recipe].name);
 }
 static const char* get_rgrind(CoffeeApp* a) {
     return a->s.using_custom ? a->custom[a->s.cur_recipe].grind :
-        methods[a->s.cur_method].recipes[a->s.cur_recipe].grind;
+        rstr(methods[a->s.cur_method].recipes[a->s.cur_recipe].grind);
 }
 static uint8_t get_rcoffee(CoffeeApp* a) {
     return a->s.using_custom ? a->custom[a->s.cur_recipe].coffee_grams :
@@ -70,52 +33,222 @@ static uint16_t get_rtemp(CoffeeApp* a) {
     return a->s.using_custom ? a->custom[a->s.cur_recipe].water_temp_c :
         methods[a->s.cur_method].recipes[a->s.cur_recipe].water_temp_c;
 }
-static uint8_t get_scount(CoffeeApp* a) {
+static uint8_t get_rows(CoffeeApp* a) {
     return a->s.using_custom ? a->custom[a->s.cur_recipe].step_count :
         methods[a->s.cur_method].recipes[a->s.cur_recipe].step_count;
 }
-static const char* get_sinst(CoffeeApp* a, uint8_t i) {
-    return a->s.using_custom ? a->custom[a->s.cur_recipe].steps[i].instruction :
-        methods[a->s.cur_method].recipes[a->s.cur_recipe].steps[i].instruction;
+static const char* row_inst(CoffeeApp* a, uint8_t r) {
+    return a->s.using_custom ? a->custom[a->s.cur_recipe].steps[r].instruction :
+        rstr(methods[a->s.cur_method].recipes[a->s.cur_recipe].steps[r].instruction);
 }
-static const char* get_sdetail(CoffeeApp* a, uint8_t i) {
-    return a->s.using_custom ? a->custom[a->s.cur_recipe].steps[i].detail :
-        methods[a->s.cur_method].recipes[a->s.cur_recipe].steps[i].detail;
+static const char* row_detail(CoffeeApp* a, uint8_t r) {
+    return a->s.using_custom ? a->custom[a->s.cur_recipe].steps[r].detail :
+        rstr(methods[a->s.cur_method].recipes[a->s.cur_recipe].steps[r].detail);
 }
-static uint16_t get_sdur(CoffeeApp* a, uint8_t i) {
-    return a->s.using_custom ? a->custom[a->s.cur_recipe].steps[i].duration_sec :
-        methods[a->s.cur_method].recipes[a->s.cur_recipe].steps[i].duration_sec;
+static uint16_t row_dur(CoffeeApp* a, uint8_t r) {
+    return a->s.using_custom ? a->custom[a->s.cur_recipe].steps[r].duration_sec :
+        methods[a->s.cur_method].recipes[a->s.cur_recipe].steps[r].duration_sec;
+}
+static StepType row_type(CoffeeApp* a, uint8_t r) {
+    return a->s.using_custom ? a->custom[a->s.cur_recipe].steps[r].type :
+        (StepType)methods[a->s.cur_method].recipes[a->s.cur_recipe].steps[r].type;
 }
-static StepType get_stype(CoffeeApp* a, uint8_t i) {
-    return a->s.using_custom ? a->custom[a->s.cur_recipe].steps[i].type :
-        methods[a->s.cur_method].recipes[a->s.cur_recipe].steps[i].type;
+static uint8_t row_weight(CoffeeApp* a, uint8_t r) {
+    return a->s.using_custom ? a->custom[a->s.cur_recipe].steps[r].weight_grams :
+        methods[a->s.cur_method].recipes[a->s.cur_recipe].steps[r].weight_grams;
 }
-static uint8_t get_sweight(CoffeeApp* a, uint8_t i) {
-    return a->s.using_custom ? a->custom[a->s.cur_recipe].steps[i].weight_grams :
-        methods[a->s.cur_method].recipes[a->s.cur_recipe].steps[i].weight_grams;
+static StepAdvance row_advance(CoffeeApp* a, uint8_t r) {
+    uint8_t adv = a->s.using_custom ? a->custom[a->s.cur_recipe].steps[r].advance :
+        methods[a->s.cur_method].recipes[a->s.cur_recipe].steps[r].advance;
+    if(adv == AdvanceDefault || adv >= AdvanceCount) adv = step_types[row_type(a, r)].advance;
+    return (StepAdvance)adv;
 }
-static uint16_t get_swml(CoffeeApp* a, uint8_t i) {
+static uint16_t row_wml(CoffeeApp* a, uint8_t r) {
     return a->s.using_custom ?
-        custom_step_water_ml(&a->custom[a->s.cur_recipe].steps[i]) :
-        step_water_ml(&methods[a->s.cur_method].recipes[a->s.cur_recipe].steps[i]);
+        custom_step_water_ml(&a->custom[a->s.cur_recipe].steps[r]) :
+        step_water_ml(&methods[a->s.cur_method].recipes[a->s.cur_recipe].steps[r]);
+}
+
+// ============================================================
+// Step program walk: brew step i -> program row and pass
+// ============================================================
+static uint8_t block_len(CoffeeApp* a, uint8_t row, uint8_t rows) {
+    uint8_t want = row_weight(a, row);
+    uint8_t n = 0;
+    while(n < want && row + 1 + n < rows && row_type(a, row + 1 + n) != StepRepeat) n++;
+    return n;
+}
+
+// Returns the number of brew steps; fills ref when step i exists
+static uint8_t step_walk(CoffeeApp* a, uint8_t i, StepRef* ref) {
+    uint8_t rows = get_rows(a);
+    uint16_t flat = 0;
+    uint8_t row = 0;
+    while(row < rows && flat < MAX_BREW_STEPS) {
+        if(row_type(a, row) == StepRepeat) {
+            uint8_t body = block_len(a, row, rows);
+            uint8_t passes = row_dur(a, row) > 0 ? (uint8_t)row_dur(a, row) : 1;
+            uint16_t span = (uint16_t)body * passes;
+            if(ref && i >= flat && i < flat + span) {
+                ref->row = row + 1 + (i - flat) % body;
+                ref->pass = (uint8_t)((i - flat) / body);
+                ref->passes = passes;
+            }
+            flat += span;
+            row += 1 + body;
+        } else {
+            if(ref && i == flat) {
+                ref->row = row;
+                ref->pass = 0;
+                ref->passes = 1;
+            }
+            flat++;
+            row++;
+        }
+    }
+    return flat > MAX_BREW_STEPS ? MAX_BREW_STEPS : (uint8_t)flat;
+}
+
+static uint8_t step_row(CoffeeApp* a, uint8_t i) {
+    StepRef ref = {0, 0, 1};
+    step_walk(a, i, &ref);
+    return ref.row;
+}
+
+static uint8_t get_scount(CoffeeApp* a) {
+    return step_walk(a, 0, NULL);
+}
+// Detail text of step i, its amounts at the current dose and batch
+static const char* get_sdetail(CoffeeApp* a, uint8_t i, char* b, size_t n) {
+    const char* d = row_detail(a, step_row(a, i));
+    if(a->scale.factor_q16 == 0 || a->scale.factor_q16 == 1u << 16) return d;
+    dose_scale_text(d, a->scale.factor_q16, b, n);
+    return b;
+}
+static uint16_t get_sdur(CoffeeApp* a, uint8_t i) {
+    return row_dur(a, step_row(a, i));
+}
+// Time the current step has actually run, manual steps included
+static uint32_t step_run_ms(CoffeeApp* a) {
+    return furi_get_tick() - a->s.step_started - a->s.step_paused_ms;
+}
+// What step i does at its deadline. Moving on to a manual step stops
+// the clock there: it waits for OK like any manual step.
+static StepAdvance get_sadvance(CoffeeApp* a, uint8_t i) {
+    if(!a->settings.auto_advance || i + 1 >= get_scount(a)) return AdvanceConfirm;
+    return row_advance(a, step_row(a, i));
+}
+
+// Instruction with its pass inside a repeat block, e.g. "Pour 2/3"
+static const char* step_label(CoffeeApp* a, uint8_t i, char* b, size_t n) {
+    StepRef ref = {0, 0, 1};
+    step_walk(a, i, &ref);
+    if(ref.passes <= 1) return row_inst(a, ref.row);
+    snprintf(b, n, "%s %d/%d", row_inst(a, ref.row), ref.pass + 1, ref.passes);
+    return b;
+}
+// ============================================================
+// Dose scaling: run when the recipe, dose or batch changes
+// ============================================================
+static void apply_scale(CoffeeApp* a) {
+    BrewScale* sc = &a->scale;
+    uint8_t base = get_rcoffee(a);
+    sc->factor_q16 = dose_scale_q16(base, a->s.ratio_adjust, a->s.batch);
+    sc->coffee_g = dose_scale(base, sc->factor_q16);
+    sc->water_ml = dose_scale(get_rwater(a), sc->factor_q16);
+    uint8_t n = get_rows(a);
+    for(uint8_t r = 0; r < n && r < MAX_STEPS; r++) {
+        sc->step_grams[r] = dose_scale(row_weight(a, r), sc->factor_q16);
+        sc->step_ml[r] = dose_scale(row_wml(a, r), sc->factor_q16);
+    }
 }
 
 // ============================================================
-// Notifications
+// Service mode: queued brews run through the same accessors by
+// making each one the current recipe in turn
 // ============================================================
-static void nfy_step_done(CoffeeApp* a) {
-    notification_message(a->notif, &sequence_single_vibro);
-    if(a->settings.sound_on) notification_message(a->notif, &seq_beep);
-    if(a->settings.led_on) notification_message(a->notif, &seq_led_red_blink);
+static void service_select(CoffeeApp* app, uint8_t i) {
+    const ServiceBrew* b = &app->service.brew[i];
+    AppState* s = &app->s;
+    s->using_custom = b->custom;
+    s->cur_method = b->method;
+    s->cur_recipe = b->recipe;
+    s->ratio_adjust = b->ratio_adjust;
+    s->batch = b->batch;
+    apply_scale(app);
+}
+
+// Flattens the current recipe into queue entry i
+static void service_load(CoffeeApp* app, uint8_t i) {
+    ServiceBrew* b = &app->service.brew[i];
+    AppState* s = &app->s;
+    b->custom = s->using_custom;
+    b->method = s->cur_method;
+    b->recipe = s->cur_recipe;
+    b->ratio_adjust = s->ratio_adjust;
+    b->batch = s->batch ? s->batch : 1;
+    snprintf(b->name, NAME_LEN, "%s", get_rname(app));
+    uint8_t n = get_scount(app);
+    if(n > SERVICE_MAX_STEPS) n = SERVICE_MAX_STEPS;
+    for(uint8_t k = 0; k < n; k++) {
+        uint8_t row = step_row(app, k);
+        b->dur[k] = row_dur(app, row);
+        b->type[k] = (uint8_t)row_type(app, row);
+    }
+    b->step_count = n;
+}
+
+// Custom recipes may have been edited since they were queued
+static void service_refresh(CoffeeApp* app) {
+    for(uint8_t i = 0; i < app->service.count; i++) {
+        service_select(app, i);
+        service_load(app, i);
+    }
+    service_plan(&app->service);
+}
+
+// ============================================================
+// List sources: each row is formatted only when it is on screen
+// ============================================================
+// Letter index keys
+#define LIST_KEY_RECIPES(m) (0x100 | (m))  // method m; method_count is Custom
+
+static void method_row(CoffeeApp* app, uint8_t idx, char* lb, size_t n) {
+    if(idx < method_count)
+        snprintf(lb, n, "%s (%d)", rstr(methods[idx].name), methods[idx].recipe_count);
+    else if(idx > method_count)
+        snprintf(lb, n, "Service queue (%d)", app->service.count);
+    else if(!app->custom_loaded)
+        snprintf(lb, n, "Custom (...)");
+    else
+        snprintf(lb, n, "Custom (%d) [>]Edit", app->custom_count);
 }
-static void nfy_brew_done(CoffeeApp* a) {
-    notification_message(a->notif, &sequence_double_vibro);
-    if(a->settings.sound_on) notification_message(a->notif, &seq_beep_done);
-    if(a->settings.led_on) notification_message(a->notif, &seq_led_red_blink);
+
+static ListSource method_list(CoffeeApp* app) {
+    return (ListSource){method_count + 1 + (app->service.count > 0), method_row, NULL};
+}
+
+static void recipe_row(CoffeeApp* app, uint8_t idx, char* lb, size_t n) {
+    uint8_t m = app->s.method_sel;
+    if(m >= method_count) {
+        const CustomRecipe* cr = custom_at(app, idx);
+        snprintf(lb, n, "  %s %dg", cr->name, cr->coffee_grams);
+    } else {
+        const Recipe* r = &methods[m].recipes[idx];
+        bool fav = settings_is_favourite(&app->settings, m, idx);
+        snprintf(lb, n, "%s %s %dg/%dml", fav ? "*" : " ", rstr(r->name), r->coffee_grams, r->water_ml);
+    }
+}
+
+static const char* recipe_name(CoffeeApp* app, uint8_t idx) {
+    uint8_t m = app->s.method_sel;
+    return m >= method_count ? custom_at(app, idx)->name : rstr(methods[m].recipes[idx].name);
 }
-static void nfy_step_chg(CoffeeApp* a) {
-    notification_message(a->notif, &sequence_single_vibro);
-    if(a->settings.led_on) notification_message(a->notif, &seq_led_green);
+
+static ListSource recipe_list(CoffeeApp* app) {
+    uint8_t m = app->s.method_sel;
+    uint8_t count = m >= method_count ? app->custom_count : methods[m].recipe_count;
+    return (ListSource){count, recipe_row, recipe_name};
 }
 
 // ============================================================
@@ -127,29 +260,8 @@ static void draw_method_menu(Canvas* c, AppState* s, CoffeeApp* app) {
     canvas_draw_line(c, 0, 13, 127, 13);
     canvas_set_font(c, FontSecondary);
 
-    uint8_t total = method_count + 1;
-    uint8_t vs = 0;
-    if(s->method_sel > 2) vs = s->method_sel - 2;
-    if(total > 4 && vs + 4 > total) vs = total - 4;
-
-    char lb[36];
-    for(uint8_t i = 0; i < 4 && (vs + i) < total; i++) {
-        uint8_t idx = vs + i;
-        uint8_t y = 17 + (i * 10);
-        if(idx == s->method_sel) {
-            canvas_set_color(c, ColorBlack);
-            canvas_draw_box(c, 0, y - 1, 128, 11);
-            canvas_set_color(c, ColorWhite);
-        } else {
-            canvas_set_color(c, ColorBlack);
-        }
-        if(idx < method_count)
-            snprintf(lb, sizeof(lb), "%s (%d)", methods[idx].name, methods[idx].recipe_count);
-        else
-            snprintf(lb, sizeof(lb), "Custom (%d) [>]Edit", app->custom_count);
-        canvas_draw_str(c, 4, y + 7, lb);
-    }
-    canvas_set_color(c, ColorBlack);
+    ListSource src = method_list(app);
+    list_draw(c, app, &src, s->method_sel, 4);
     canvas_draw_line(c, 0, 56, 127, 56);
     canvas_draw_str_aligned(c, 64, 63, AlignCenter, AlignBottom, "[OK]Select [<]Exit");
 }
@@ -159,47 +271,22 @@ static void draw_method_menu(Canvas* c, AppState* s, CoffeeApp* app) {
 // ============================================================
 static void draw_recipe_menu(Canvas* c, AppState* s, CoffeeApp* app) {
     bool is_cust = (s->method_sel >= method_count);
-    const char* title = is_cust ? "Custom" : methods[s->method_sel].name;
-    uint8_t count = is_cust ? app->custom_count : methods[s->method_sel].recipe_count;
+    const char* title = is_cust ? "Custom" : rstr(methods[s->method_sel].name);
+    ListSource src = recipe_list(app);
 
     canvas_set_font(c, FontPrimary);
     canvas_draw_str_aligned(c, 64, 2, AlignCenter, AlignTop, title);
     canvas_draw_line(c, 0, 13, 127, 13);
     canvas_set_font(c, FontSecondary);
 
-    if(count == 0) {
+    if(src.count == 0) {
         canvas_draw_str_aligned(c, 64, 35, AlignCenter, AlignBottom, "No recipes yet");
         canvas_draw_line(c, 0, 56, 127, 56);
         canvas_draw_str_aligned(c, 64, 63, AlignCenter, AlignBottom, "[<] Back");
         return;
     }
 
-    uint8_t vs = 0;
-    if(s->recipe_sel > 2) vs = s->recipe_sel - 2;
-    if(count > 4 && vs + 4 > count) vs = count - 4;
-
-    char lb[36];
-    for(uint8_t i = 0; i < 4 && (vs + i) < count; i++) {
-        uint8_t idx = vs + i;
-        uint8_t y = 17 + (i * 10);
-        if(idx == s->recipe_sel) {
-            canvas_set_color(c, ColorBlack);
-            canvas_draw_box(c, 0, y - 1, 128, 11);
-            canvas_set_color(c, ColorWhite);
-        } else {
-            canvas_set_color(c, ColorBlack);
-        }
-        if(is_cust) {
-            snprintf(lb, sizeof(lb), "  %s %dg", app->custom[idx].name, app->custom[idx].coffee_grams);
-        } else {
-            const Recipe* r = &methods[s->method_sel].recipes[idx];
-            bool fav = settings_is_favourite(&app->settings, s->method_sel, idx);
-            snprintf(lb, sizeof(lb), "%s %s %dg/%dml",
-                fav ? "*" : " ", r->name, r->coffee_grams, r->water_ml);
-        }
-        canvas_draw_str(c, 2, y + 7, lb);
-    }
-    canvas_set_color(c, ColorBlack);
+    list_draw(c, app, &src, s->recipe_sel, 2);
     canvas_draw_line(c, 0, 56, 127, 56);
     canvas_draw_str_aligned(c, 64, 63, AlignCenter, AlignBottom,
         is_cust ? "[OK]Brew [<]Back" : "[OK]Sel [>]Fav [<]Back");
@@ -211,81 +298,152 @@ static void draw_recipe_menu(Canvas* c, AppState* s, CoffeeApp* app) {
 static void draw_info(Canvas* c, CoffeeApp* app) {
     AppState* s = &app->s;
     char b[36];
-    uint8_t cof = adjusted_coffee(get_rcoffee(app), s->ratio_adjust);
-    uint16_t wat = adjusted_water(get_rwater(app), get_rcoffee(app), s->ratio_adjust);
+    uint16_t cof = app->scale.coffee_g;
+    uint16_t wat = app->scale.water_ml;
 
     canvas_set_font(c, FontPrimary);
     canvas_draw_str_aligned(c, 64, 2, AlignCenter, AlignTop, get_rname(app));
     canvas_draw_line(c, 0, 13, 127, 13);
     canvas_set_font(c, FontSecondary);
 
-    snprintf(b, sizeof(b), "%s%s%s",
+    static const char* const launch_tag[LaunchCount] = {"", ">Info ", ">Brew "};
+    snprintf(b, sizeof(b), "%s%s%s%s%s",
+        launch_tag[app->settings.launch],
         app->settings.auto_advance ? "Auto " : "",
         app->settings.sound_on ? "Snd " : "",
-        app->settings.led_on ? "LED" : "");
+        app->settings.led_on ? "LED " : "",
+        app->settings.power_save_types ? "Eco" : "");
     canvas_draw_str_aligned(c, 126, 15, AlignRight, AlignTop, b);
 
     snprintf(b, sizeof(b), "Coffee: %dg (%s)", cof, get_rgrind(app));
     canvas_draw_str(c, 2, 26, b);
     snprintf(b, sizeof(b), "Water: %dml at %dC", wat, get_rtemp(app));
     canvas_draw_str(c, 2, 36, b);
-    if(s->ratio_adjust != 0)
-        snprintf(b, sizeof(b), "Adjusted: %+d dose", s->ratio_adjust);
+    if(s->ratio_adjust != 0 || s->batch > 1)
+        snprintf(b, sizeof(b), "Dose %+dg  Batch x%d", s->ratio_adjust, s->batch);
     else
-        snprintf(b, sizeof(b), "Steps: %d  [</>]dose", get_scount(app));
+        snprintf(b, sizeof(b), "Steps: %d [</>]Dose [v]x2", get_scount(app));
     canvas_draw_str(c, 2, 46, b);
 
     canvas_draw_line(c, 0, 56, 127, 56);
-    canvas_draw_str_aligned(c, 64, 63, AlignCenter, AlignBottom, "[OK]Start [Up]Opts [<]Back");
+    canvas_draw_str_aligned(c, 64, 63, AlignCenter, AlignBottom,
+        app->service.refused ? app->service.refused : "[OK]Start [Up]Opts [<]Back");
+}
+
+// ============================================================
+// Brew ETA: timers for timed steps (or their usual overrun), learned
+// times for manual ones. unknown counts manual steps never timed yet.
+// ============================================================
+static uint32_t brew_eta(CoffeeApp* app, uint8_t* unknown, float* var) {
+    AppState* s = &app->s;
+    uint8_t sc = get_scount(app);
+    float left = 0.0f;
+    *unknown = 0;
+    *var = 0.0f;
+    for(uint8_t i = s->cur_step; i < sc; i++) {
+        uint8_t row = step_row(app, i);
+        const StepStat* st = &app->stats.cur.row[row];
+        uint16_t dur = row_dur(app, row);
+        float expect = dur;
+        if(st->n > 0) {
+            if(st->mean_sec > expect) expect = st->mean_sec;
+            *var += stats_variance(st);
+        } else if(dur == 0) {
+            (*unknown)++;
+            continue;
+        }
+        if(i == s->cur_step) {
+            float el = dur > 0 ? s->step_elapsed_ms / 1000.0f :
+                                 step_run_ms(app) / 1000.0f;
+            expect = expect > el ? expect - el : 0.0f;
+        }
+        left += expect;
+    }
+    return (uint32_t)(left + 0.5f);
+}
+
+static void draw_eta(Canvas* c, CoffeeApp* app) {
+    uint8_t unknown;
+    float var;
+    uint32_t left = brew_eta(app, &unknown, &var);
+    if(left == 0 && unknown > 0) return;
+    char ts[12], b[20];
+    fmt_time(left, ts, sizeof(ts));
+    snprintf(b, sizeof(b), "%s%s%s left",
+        var >= STATS_ROUGH_SEC * STATS_ROUGH_SEC ? "~" : "", ts, unknown ? "+" : "");
+    canvas_draw_str_aligned(c, 126, 62, AlignRight, AlignBottom, b);
 }
 
 // ============================================================
 // Draw: Brewing
 // ============================================================
+// Top bar: position on the left, name centred, step type badge
+static void draw_step_header(Canvas* c, const char* pos, const char* name, const char* badge) {
+    canvas_set_font(c, FontSecondary);
+    canvas_draw_str(c, 2, 8, pos);
+    if(badge) {
+        uint8_t bw = canvas_string_width(c, badge) + 6;
+        canvas_draw_rframe(c, 128 - bw - 2, 0, bw, 11, 2);
+        canvas_draw_str_aligned(c, 128 - bw / 2 - 2, 8, AlignCenter, AlignBottom, badge);
+    }
+    canvas_draw_str_aligned(c, 64, 8, AlignCenter, AlignBottom, name);
+    canvas_draw_line(c, 0, 10, 127, 10);
+}
+
+// Instruction, detail and scaled amounts of brew step i
+static void draw_step_body(Canvas* c, CoffeeApp* app, uint8_t i) {
+    uint8_t row = step_row(app, i);
+    char lb[28], db[DETAIL_LEN + 8];
+    canvas_set_font(c, FontPrimary);
+    canvas_draw_str_aligned(c, 64, 22, AlignCenter, AlignBottom, step_label(app, i, lb, sizeof(lb)));
+    canvas_set_font(c, FontSecondary);
+    canvas_draw_str_aligned(c, 64, 32, AlignCenter, AlignBottom, get_sdetail(app, i, db, sizeof(db)));
+
+    uint16_t wml = app->scale.step_ml[row];
+    uint16_t wg = app->scale.step_grams[row];
+    const AppSensor* sn = &app->sensor;
+    if(wml > 0 && !app->service.active && sensor_live(sn, furi_get_tick())) {
+        // Poured so far against this step's target, and the flow
+        char ex[36];
+        int32_t g = sensor_poured(sn) / 10;
+        int32_t flow = sn->flow > 0 ? sn->flow : 0;
+        snprintf(ex, sizeof(ex), "%ld/%dg  %ld.%ldg/s", (long)g, app->s.cumulative_water_ml + wml,
+            (long)(flow / 10), (long)(flow % 10));
+        canvas_draw_str_aligned(c, 64, 40, AlignCenter, AlignBottom, ex);
+    } else if(wg > 0 || wml > 0) {
+        char ex[24];
+        if(wg > 0 && wml > 0) snprintf(ex, sizeof(ex), "%dg / %dml", wg, wml);
+        else if(wg > 0) snprintf(ex, sizeof(ex), "%dg", wg);
+        else snprintf(ex, sizeof(ex), "%dml", wml);
+        canvas_draw_str_aligned(c, 64, 40, AlignCenter, AlignBottom, ex);
+    }
+    canvas_draw_line(c, 0, 42, 127, 42);
+}
+
 static void draw_brewing(Canvas* c, CoffeeApp* app) {
     AppState* s = &app->s;
     uint8_t sc = get_scount(app);
+    uint8_t row = step_row(app, s->cur_step);
     char b[36];
+    char lb[28];
 
-    canvas_set_font(c, FontSecondary);
     snprintf(b, sizeof(b), "%d/%d", s->cur_step + 1, sc);
-    canvas_draw_str(c, 2, 8, b);
-
-    const char* bg = step_badge(get_stype(app, s->cur_step));
-    uint8_t bw = canvas_string_width(c, bg) + 6;
-    canvas_draw_rframe(c, 128 - bw - 2, 0, bw, 11, 2);
-    canvas_draw_str_aligned(c, 128 - bw / 2 - 2, 8, AlignCenter, AlignBottom, bg);
-    canvas_draw_str_aligned(c, 64, 8, AlignCenter, AlignBottom, get_rname(app));
-    canvas_draw_line(c, 0, 10, 127, 10);
+    draw_step_header(c, b, get_rname(app), step_type_token(row_type(app, row)));
 
     if(s->show_upcoming) {
         canvas_draw_str_aligned(c, 64, 13, AlignCenter, AlignTop, "Upcoming:");
         for(uint8_t i = 0; i < 3; i++) {
             uint8_t si = s->cur_step + 1 + i;
             if(si >= sc) break;
-            snprintf(b, sizeof(b), "%d. %s", si + 1, get_sinst(app, si));
+            snprintf(b, sizeof(b), "%d. %s", si + 1, step_label(app, si, lb, sizeof(lb)));
             canvas_draw_str(c, 4, 24 + (i * 10), b);
         }
         snprintf(b, sizeof(b), "Water: %dml", s->cumulative_water_ml);
         canvas_draw_str(c, 2, 54, b);
     } else {
-        canvas_set_font(c, FontPrimary);
-        canvas_draw_str_aligned(c, 64, 22, AlignCenter, AlignBottom, get_sinst(app, s->cur_step));
-        canvas_set_font(c, FontSecondary);
-        canvas_draw_str_aligned(c, 64, 32, AlignCenter, AlignBottom, get_sdetail(app, s->cur_step));
-
-        uint16_t wml = get_swml(app, s->cur_step);
-        uint8_t wg = get_sweight(app, s->cur_step);
-        if(wg > 0 || wml > 0) {
-            char ex[24];
-            if(wg > 0 && wml > 0) snprintf(ex, sizeof(ex), "%dg / %dml", wg, wml);
-            else if(wg > 0) snprintf(ex, sizeof(ex), "%dg", wg);
-            else snprintf(ex, sizeof(ex), "%dml", wml);
-            canvas_draw_str_aligned(c, 64, 40, AlignCenter, AlignBottom, ex);
-        }
-        canvas_draw_line(c, 0, 42, 127, 42);
+        draw_step_body(c, app, s->cur_step);
 
-        uint16_t dur = get_sdur(app, s->cur_step);
+        uint16_t dur = row_dur(app, row);
         if(dur > 0) {
             uint32_t el = s->step_elapsed_ms / 1000;
             canvas_set_font(c, FontBigNumbers);
@@ -304,11 +462,16 @@ static void draw_brewing(Canvas* c, CoffeeApp* app) {
             canvas_set_font(c, FontSecondary);
             if(s->timer_state == TimerPaused)
                 canvas_draw_str_aligned(c, 97, 62, AlignCenter, AlignBottom, "PAUSED");
+            else if(s->step_complete && get_sadvance(app, s->cur_step) == AdvanceArm)
+                canvas_draw_str_aligned(c, 97, 62, AlignCenter, AlignBottom, "NEXT>");
             else if(s->step_complete)
                 canvas_draw_str_aligned(c, 97, 62, AlignCenter, AlignBottom, "DONE>");
+            else
+                draw_eta(c, app);
         } else {
             canvas_set_font(c, FontSecondary);
             canvas_draw_str_aligned(c, 64, 52, AlignCenter, AlignBottom, "[OK] when ready");
+            draw_eta(c, app);
         }
     }
 
@@ -319,169 +482,165 @@ static void draw_brewing(Canvas* c, CoffeeApp* app) {
 }
 
 static void draw_complete(Canvas* c, CoffeeApp* app) {
+    AppService* sv = &app->service;
+    char tb[12], b[32];
     canvas_set_font(c, FontPrimary);
-    canvas_draw_str_aligned(c, 64, 14, AlignCenter, AlignBottom, "Brew Complete!");
+    canvas_draw_str_aligned(c, 64, 14, AlignCenter, AlignBottom,
+        sv->active ? "Service Complete!" : "Brew Complete!");
     canvas_set_font(c, FontSecondary);
-    char tb[12]; fmt_time(app->s.total_elapsed_ms / 1000, tb, sizeof(tb));
-    char b[32]; snprintf(b, sizeof(b), "Total: %s", tb);
-    canvas_draw_str_aligned(c, 64, 28, AlignCenter, AlignBottom, b);
-    canvas_draw_str_aligned(c, 64, 40, AlignCenter, AlignBottom, get_rname(app));
-    canvas_draw_str_aligned(c, 64, 50, AlignCenter, AlignBottom, "Enjoy your coffee!");
+    if(sv->active) {
+        uint32_t sec = (sv->ended - sv->started) / 1000;
+        fmt_time(sec, tb, sizeof(tb));
+        snprintf(b, sizeof(b), "%d drinks in %s", service_drinks(sv), tb);
+        canvas_draw_str_aligned(c, 64, 28, AlignCenter, AlignBottom, b);
+        fmt_time(sv->plan_sec, tb, sizeof(tb));
+        snprintf(b, sizeof(b), "Planned %s", tb);
+        canvas_draw_str_aligned(c, 64, 40, AlignCenter, AlignBottom, b);
+        fmt_time(sv->serial_sec, tb, sizeof(tb));
+        snprintf(b, sizeof(b), "One by one: %s", tb);
+        canvas_draw_str_aligned(c, 64, 50, AlignCenter, AlignBottom, b);
+    } else {
+        fmt_time(app->s.total_elapsed_ms / 1000, tb, sizeof(tb));
+        snprintf(b, sizeof(b), "Total: %s", tb);
+        canvas_draw_str_aligned(c, 64, 28, AlignCenter, AlignBottom, b);
+        canvas_draw_str_aligned(c, 64, 40, AlignCenter, AlignBottom, get_rname(app));
+        canvas_draw_str_aligned(c, 64, 50, AlignCenter, AlignBottom, "Enjoy your coffee!");
+    }
     canvas_draw_line(c, 0, 56, 127, 56);
     canvas_draw_str_aligned(c, 64, 63, AlignCenter, AlignBottom, "[OK] Menu  [<] Exit");
 }
 
-static void draw_confirm_box(Canvas* c, const char* msg) {
-    canvas_draw_rframe(c, 14, 16, 100, 32, 4);
-    canvas_set_color(c, ColorWhite);
-    canvas_draw_box(c, 15, 17, 98, 30);
-    canvas_set_color(c, ColorBlack);
-    canvas_set_font(c, FontPrimary);
-    canvas_draw_str_aligned(c, 64, 28, AlignCenter, AlignBottom, msg);
-    canvas_set_font(c, FontSecondary);
-    canvas_draw_str_aligned(c, 64, 42, AlignCenter, AlignBottom, "[OK] Yes  [<] No");
-}
-
 // ============================================================
-// Editor draw functions
+// Draw: Service queue and session
 // ============================================================
-static void draw_edit_menu(Canvas* c, CoffeeApp* app) {
+static void draw_service_queue(Canvas* c, CoffeeApp* app) {
+    AppService* sv = &app->service;
+    char b[36], ts[12];
+
     canvas_set_font(c, FontPrimary);
-    canvas_draw_str_aligned(c, 64, 2, AlignCenter, AlignTop, "Custom Recipes");
+    fmt_time(sv->plan_sec, ts, sizeof(ts));
+    uint32_t per_hour = sv->plan_sec ? service_drinks(sv) * 3600UL / sv->plan_sec : 0;
+    snprintf(b, sizeof(b), "Plan %s, %lu/h", ts, (unsigned long)per_hour);
+    canvas_draw_str_aligned(c, 64, 2, AlignCenter, AlignTop, b);
     canvas_draw_line(c, 0, 13, 127, 13);
     canvas_set_font(c, FontSecondary);
 
-    uint8_t total = app->custom_count + 1;
-    uint8_t sel = app->editor.sel;
-    uint8_t vs = 0;
-    if(sel > 2) vs = sel - 2;
-    if(total > 4 && vs + 4 > total) vs = total - 4;
-
-    char lb[36];
-    for(uint8_t i = 0; i < 4 && (vs + i) < total; i++) {
-        uint8_t idx = vs + i;
+    for(uint8_t i = 0; i < sv->count; i++) {
+        const ServiceBrew* br = &sv->brew[i];
         uint8_t y = 17 + (i * 10);
-        if(idx == sel) {
+        if(i == sv->sel) {
             canvas_set_color(c, ColorBlack);
             canvas_draw_box(c, 0, y - 1, 128, 11);
             canvas_set_color(c, ColorWhite);
         } else { canvas_set_color(c, ColorBlack); }
-        snprintf(lb, sizeof(lb), "%s",
-            idx < app->custom_count ? app->custom[idx].name : "+ New Recipe");
-        canvas_draw_str(c, 4, y + 7, lb);
+        snprintf(b, sizeof(b), "B%d %s", i + 1, br->name);
+        canvas_draw_str(c, 4, y + 7, b);
+        if(br->batch > 1 || br->ratio_adjust != 0) {
+            if(br->ratio_adjust != 0) snprintf(b, sizeof(b), "%+dg x%d", br->ratio_adjust, br->batch);
+            else snprintf(b, sizeof(b), "x%d", br->batch);
+            canvas_draw_str_aligned(c, 124, y + 8, AlignRight, AlignBottom, b);
+        }
     }
     canvas_set_color(c, ColorBlack);
     canvas_draw_line(c, 0, 56, 127, 56);
-    canvas_draw_str_aligned(c, 64, 63, AlignCenter, AlignBottom, "[OK]Edit [<]Back");
+    canvas_draw_str_aligned(c, 64, 63, AlignCenter, AlignBottom, "[OK]Go [>]Del [<]Back");
 }
 
-static void draw_edit_recipe(Canvas* c, CoffeeApp* app) {
-    EditorState* ed = &app->editor;
-    CustomRecipe* cr = &app->custom[ed->recipe_idx];
-    char b[36];
-
-    canvas_set_font(c, FontPrimary);
-    canvas_draw_str_aligned(c, 64, 2, AlignCenter, AlignTop, "Edit Recipe");
-    canvas_draw_line(c, 0, 13, 127, 13);
-    canvas_set_font(c, FontSecondary);
-
-    const char* labels[] = {"Name:", "Grind:", "Coffee:", "Water:", "Temp:", ">> SAVE", ">> DELETE"};
-
-    uint8_t vs = 0;
-    if((uint8_t)ed->field > 3) vs = (uint8_t)ed->field - 3;
-
-    for(uint8_t i = 0; i < 4 && (vs + i) < EditFieldCount; i++) {
-        uint8_t fi = vs + i;
-        uint8_t y = 17 + (i * 10);
-        if(fi == (uint8_t)ed->field) {
-            canvas_set_color(c, ColorBlack);
-            canvas_draw_box(c, 0, y - 1, 128, 11);
-            canvas_set_color(c, ColorWhite);
-        } else { canvas_set_color(c, ColorBlack); }
-
-        switch(fi) {
-        case EditFieldName:
-            snprintf(b, sizeof(b), ed->editing ? "%s %s_" : "%s %s", labels[fi], cr->name);
-            break;
-        case EditFieldGrind: snprintf(b, sizeof(b), "%s %s", labels[fi], cr->grind); break;
-        case EditFieldCoffee: snprintf(b, sizeof(b), "%s %dg", labels[fi], cr->coffee_grams); break;
-        case EditFieldWater: snprintf(b, sizeof(b), "%s %dml", labels[fi], cr->water_ml); break;
-        case EditFieldTemp: snprintf(b, sizeof(b), "%s %dC", labels[fi], cr->water_temp_c); break;
-        default: snprintf(b, sizeof(b), "%s", labels[fi]); break;
+// Next action: the step in hand, or what comes next and when. The
+// bottom line counts down the other brews' waits.
+static void draw_service(Canvas* c, CoffeeApp* app) {
+    AppService* sv = &app->service;
+    uint32_t now = furi_get_tick();
+    char b[40], ts[12], pos[8];
+
+    uint8_t done = 0;
+    for(uint8_t i = 0; i < sv->count; i++)
+        if(sv->brew[i].step >= sv->brew[i].step_count) done++;
+    snprintf(pos, sizeof(pos), "%d/%d", done, sv->count);
+
+    if(sv->act >= 0) {
+        const ServiceBrew* br = &sv->brew[sv->act];
+        uint8_t row = step_row(app, br->step);
+        snprintf(pos, sizeof(pos), "B%d", sv->act + 1);
+        draw_step_header(c, pos, br->name, step_type_token(row_type(app, row)));
+        draw_step_body(c, app, br->step);
+        uint16_t dur = row_dur(app, row);
+        uint32_t el = (now - sv->act_started) / 1000;
+        if(dur > 0) {
+            fmt_time(el < dur ? dur - el : el - dur, ts, sizeof(ts));
+            snprintf(b, sizeof(b), el < dur ? "%s left" : "+%s", ts);
+        } else {
+            snprintf(b, sizeof(b), "[OK] when done");
         }
-        canvas_draw_str(c, 4, y + 7, b);
+        canvas_draw_str(c, 2, 52, b);
+    } else {
+        draw_step_header(c, pos, "Service", NULL);
+        uint32_t wait;
+        int8_t next = service_next(sv, now, &wait);
+        canvas_set_font(c, FontPrimary);
+        fmt_time((wait + 999) / 1000, ts, sizeof(ts));
+        snprintf(b, sizeof(b), next >= 0 ? "Next in %s" : "Finishing", ts);
+        canvas_draw_str_aligned(c, 64, 22, AlignCenter, AlignBottom, b);
+        canvas_set_font(c, FontSecondary);
+        if(next >= 0) {
+            const ServiceBrew* br = &sv->brew[next];
+            snprintf(b, sizeof(b), "B%d %s: %s", next + 1, br->name,
+                step_type_name((StepType)br->type[br->step]));
+            canvas_draw_str_aligned(c, 64, 32, AlignCenter, AlignBottom, b);
+        }
+        canvas_draw_line(c, 0, 42, 127, 42);
     }
-    canvas_set_color(c, ColorBlack);
-    canvas_draw_line(c, 0, 56, 127, 56);
-    canvas_draw_str_aligned(c, 64, 63, AlignCenter, AlignBottom,
-        ed->editing ? "[</>]Adj [OK]Done" : "[OK]Edit [>]Steps [<]Back");
-}
 
-static void draw_edit_steps(Canvas* c, CoffeeApp* app) {
-    EditorState* ed = &app->editor;
-    CustomRecipe* cr = &app->custom[ed->recipe_idx];
-    char b[36];
+    fmt_time((service_eta(sv, now) + 999) / 1000, ts, sizeof(ts));
+    snprintf(b, sizeof(b), "~%s all", ts);
+    canvas_draw_str_aligned(c, 126, 52, AlignRight, AlignBottom, b);
+
+    // Brews in a wait, with the time it has left
+    size_t len = 0;
+    b[0] = 0;
+    for(uint8_t i = 0; i < sv->count && len < sizeof(b); i++) {
+        const ServiceBrew* br = &sv->brew[i];
+        if(i == sv->act || !br->started || (int32_t)(now - br->ready) >= 0) continue;
+        fmt_time((br->ready - now + 999) / 1000, ts, sizeof(ts));
+        len += snprintf(b + len, sizeof(b) - len, "%sB%d %s", len ? "  " : "", i + 1, ts);
+    }
+    canvas_draw_str(c, 2, 62, b);
+}
 
+static void draw_confirm_box(Canvas* c, const char* msg) {
+    canvas_draw_rframe(c, 14, 16, 100, 32, 4);
+    canvas_set_color(c, ColorWhite);
+    canvas_draw_box(c, 15, 17, 98, 30);
+    canvas_set_color(c, ColorBlack);
     canvas_set_font(c, FontPrimary);
-    snprintf(b, sizeof(b), "Steps (%d/%d)", cr->step_count, MAX_STEPS);
-    canvas_draw_str_aligned(c, 64, 2, AlignCenter, AlignTop, b);
-    canvas_draw_line(c, 0, 13, 127, 13);
+    canvas_draw_str_aligned(c, 64, 28, AlignCenter, AlignBottom, msg);
     canvas_set_font(c, FontSecondary);
-
-    uint8_t total = cr->step_count + (cr->step_count < MAX_STEPS ? 1 : 0);
-    uint8_t sel = ed->sel;
-    uint8_t vs = 0;
-    if(sel > 2) vs = sel - 2;
-    if(total > 4 && vs + 4 > total) vs = total - 4;
-
-    for(uint8_t i = 0; i < 4 && (vs + i) < total; i++) {
-        uint8_t idx = vs + i;
-        uint8_t y = 17 + (i * 10);
-        if(idx == sel) {
-            canvas_set_color(c, ColorBlack);
-            canvas_draw_box(c, 0, y - 1, 128, 11);
-            canvas_set_color(c, ColorWhite);
-        } else { canvas_set_color(c, ColorBlack); }
-        if(idx < cr->step_count)
-            snprintf(b, sizeof(b), "%d.%s %ds", idx + 1, step_type_name(cr->steps[idx].type), cr->steps[idx].duration_sec);
-        else
-            snprintf(b, sizeof(b), "+ Add Step");
-        canvas_draw_str(c, 4, y + 7, b);
-    }
-    canvas_set_color(c, ColorBlack);
-    canvas_draw_line(c, 0, 56, 127, 56);
-    canvas_draw_str_aligned(c, 64, 63, AlignCenter, AlignBottom, "[OK]Edit [>]Del [<]Back");
+    canvas_draw_str_aligned(c, 64, 42, AlignCenter, AlignBottom, "[OK] Yes  [<] No");
 }
 
-static void draw_edit_step(Canvas* c, CoffeeApp* app) {
-    EditorState* ed = &app->editor;
-    CustomStep* st = &app->custom[ed->recipe_idx].steps[ed->step_idx];
-    char b[36];
-
+// ============================================================
+// Debug: metrics
+// ============================================================
+static void draw_debug(Canvas* c, CoffeeApp* app) {
     canvas_set_font(c, FontPrimary);
-    snprintf(b, sizeof(b), "Step %d", ed->step_idx + 1);
-    canvas_draw_str_aligned(c, 64, 2, AlignCenter, AlignTop, b);
+    const char* title = app->trace.mode == TraceReplaying ? "Metrics (replay)" :
+                        app->trace.mode == TraceLoading   ? "Metrics (loading)" :
+                                                            "Metrics";
+    canvas_draw_str_aligned(c, 64, 2, AlignCenter, AlignTop, title);
     canvas_draw_line(c, 0, 13, 127, 13);
     canvas_set_font(c, FontSecondary);
 
-    for(uint8_t i = 0; i < StepFieldCount; i++) {
-        uint8_t y = 17 + (i * 10);
-        if(i == (uint8_t)ed->step_field) {
-            canvas_set_color(c, ColorBlack);
-            canvas_draw_box(c, 0, y - 1, 128, 11);
-            canvas_set_color(c, ColorWhite);
-        } else { canvas_set_color(c, ColorBlack); }
-        switch(i) {
-        case StepFieldType: snprintf(b, sizeof(b), "Type: %s", step_type_name(st->type)); break;
-        case StepFieldDuration: snprintf(b, sizeof(b), "Time: %ds", st->duration_sec); break;
-        case StepFieldWater: snprintf(b, sizeof(b), "Water: %dml", custom_step_water_ml(st)); break;
-        case StepFieldWeight: snprintf(b, sizeof(b), "Weight: %dg", st->weight_grams); break;
-        }
-        canvas_draw_str(c, 4, y + 7, b);
+    uint8_t total = metrics_line_count(app);
+    uint8_t vs = app->metrics.debug_line;
+    if(total > 4 && vs + 4 > total) vs = total - 4;
+
+    char lb[36];
+    for(uint8_t i = 0; i < 4 && (vs + i) < total; i++) {
+        metrics_format_line(app, vs + i, lb, sizeof(lb));
+        canvas_draw_str(c, 2, 24 + (i * 10), lb);
     }
-    canvas_set_color(c, ColorBlack);
     canvas_draw_line(c, 0, 56, 127, 56);
-    canvas_draw_str_aligned(c, 64, 63, AlignCenter, AlignBottom, "[</>]Adj [OK/Bk]Done");
+    canvas_draw_str_aligned(c, 64, 63, AlignCenter, AlignBottom, "[OK]Dump [>]Rst [<]Rec");
 }
 
 // ============================================================
@@ -489,7 +648,11 @@ static void draw_edit_step(Canvas* c, CoffeeApp* app) {
 // ============================================================
 static void draw_cb(Canvas* c, void* ctx) {
     CoffeeApp* app = ctx;
-    if(furi_mutex_acquire(app->mutex, 25) != FuriStatusOk) return;
+    if(furi_mutex_acquire(app->mutex, 25) != FuriStatusOk) {
+        __atomic_fetch_add(&app->metrics.frame_misses, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    uint32_t c0 = metrics_cycles();
     canvas_clear(c);
     switch(app->s.screen) {
     case ScreenMethodMenu:    draw_method_menu(c, &app->s, app); break;
@@ -497,36 +660,33 @@ static void draw_cb(Canvas* c, void* ctx) {
     case ScreenRecipeInfo:    draw_info(c, app); break;
     case ScreenBrewing:       draw_brewing(c, app); break;
     case ScreenComplete:      draw_complete(c, app); break;
-    case ScreenConfirmAbort:  draw_brewing(c, app); draw_confirm_box(c, "Cancel brew?"); break;
-    case ScreenEditMenu:      draw_edit_menu(c, app); break;
-    case ScreenEditRecipe:    draw_edit_recipe(c, app); break;
-    case ScreenEditSteps:     draw_edit_steps(c, app); break;
-    case ScreenEditStep:      draw_edit_step(c, app); break;
-    case ScreenConfirmDelete: draw_edit_recipe(c, app); draw_confirm_box(c, "Delete recipe?"); break;
-    }
-    furi_mutex_release(app->mutex);
-}
-
-static void input_cb(InputEvent* ev, void* ctx) {
-    CoffeeApp* app = ctx;
-    furi_message_queue_put(app->queue, ev, FuriWaitForever);
-}
-
-static void tick_cb(void* ctx) {
-    CoffeeApp* app = ctx;
-    if(furi_mutex_acquire(app->mutex, 10) != FuriStatusOk) return;
-    if(app->s.screen == ScreenBrewing && app->s.timer_state == TimerRunning) {
-        app->s.step_elapsed_ms += 100;
-        app->s.total_elapsed_ms += 100;
-        uint16_t dur = get_sdur(app, app->s.cur_step);
-        if(dur > 0 && app->s.step_elapsed_ms / 1000 >= dur && !app->s.step_complete) {
-            app->s.step_complete = true;
-            nfy_step_done(app);
+    case ScreenConfirmAbort:
+        if(app->service.active) {
+            draw_service(c, app);
+            draw_confirm_box(c, "Stop service?");
+        } else {
+            draw_brewing(c, app);
+            draw_confirm_box(c, "Cancel brew?");
         }
-        if(app->s.step_elapsed_ms % 5000 == 0 && app->settings.led_on &&
-           app->s.timer_state == TimerPaused)
-            notification_message(app->notif, &seq_led_orange);
-        view_port_update(app->view_port);
+        break;
+    case ScreenEditMenu:
+    case ScreenEditRecipe:
+    case ScreenEditSteps:
+    case ScreenEditStep:
+    case ScreenConfirmDelete:
+        if(app->editor_api) app->editor_api->draw(c, app);
+        break;
+    case ScreenDebug:         draw_debug(c, app); break;
+    case ScreenServiceQueue:  draw_service_queue(c, app); break;
+    case ScreenService:       draw_service(c, app); break;
+    default: break;
+    }
+    uint32_t dt = metrics_us_since(c0);
+    metrics_record(&app->metrics.frame, dt);
+    metrics_record(&app->metrics.draw[app->s.screen], dt);
+    if(app->metrics.first_frame_ms == 0) {
+        app->metrics.first_frame_ms = furi_get_tick() - app->metrics.launch_tick;
+        FURI_LOG_I(COFFEE_TIMER_TAG, "First frame after %lums", app->metrics.first_frame_ms);
     }
     furi_mutex_release(app->mutex);
 }
@@ -536,281 +696,500 @@ static void tick_cb(void* ctx) {
 // ============================================================
 static void advance(CoffeeApp* app) {
     uint8_t sc = get_scount(app);
-    app->s.cumulative_water_ml += get_swml(app, app->s.cur_step);
+    app->s.cumulative_water_ml += app->scale.step_ml[step_row(app, app->s.cur_step)];
 
     if(app->s.cur_step + 1 >= sc) {
         app->s.screen = ScreenComplete;
         app->s.timer_state = TimerStopped;
-        nfy_brew_done(app);
+        notify_post(app, NotifyBrewDone);
+        stats_flush(app);
+        stats_log_brew(app);
     } else {
         app->s.cur_step++;
+        app->s.step_started = furi_get_tick();
+        app->s.step_paused_ms = 0;
         app->s.step_elapsed_ms = 0;
         app->s.step_complete = false;
         app->s.timer_state = (get_sdur(app, app->s.cur_step) > 0) ? TimerRunning : TimerStopped;
-        nfy_step_chg(app);
+        notify_post(app, NotifyStepChange);
     }
 }
 
-static void check_auto_advance(CoffeeApp* app) {
-    if(!app->settings.auto_advance || !app->s.step_complete || app->s.screen != ScreenBrewing) return;
-    uint8_t sc = get_scount(app);
-    if(app->s.cur_step + 1 < sc && get_sdur(app, app->s.cur_step + 1) > 0) {
-        advance(app);
+// Moving past a step that was actually done makes its time a sample;
+// skips and steps back don't count
+static void complete_step(CoffeeApp* app) {
+    stats_add(&app->stats.cur, step_row(app, app->s.cur_step), step_run_ms(app));
+    app->stats.dirty = true;
+    advance(app);
+}
+
+// Past a deadline the next step keeps the time already run, so its clock
+// starts at the deadline however late the move is
+static void chain_step(CoffeeApp* app) {
+    AppState* s = &app->s;
+    uint32_t over = s->step_elapsed_ms - get_sdur(app, s->cur_step) * 1000U;
+    complete_step(app);
+    if(s->screen != ScreenBrewing) return;
+    s->step_started -= over;
+    if(s->timer_state == TimerRunning) s->step_elapsed_ms = over;
+}
+
+static void input_cb(InputEvent* ev, void* ctx) {
+    CoffeeApp* app = ctx;
+    AppEvent e = {.type = AppEventInput, .tick = furi_get_tick(), .input = *ev};
+    furi_message_queue_put(app->queue, &e, FuriWaitForever);
+}
+
+// Brew time goes by the clock, so a tick dropped or held off by the lock
+// is made up by the next one. Input counts it up to the key press before
+// it starts or stops the timer.
+static void brew_clock(CoffeeApp* app) {
+    AppState* s = &app->s;
+    uint32_t now = furi_get_tick();
+    uint32_t dt = now - s->clock_tick;
+    s->clock_tick = now;
+    if(s->screen == ScreenBrewing && s->timer_state == TimerRunning) {
+        s->step_elapsed_ms += dt;
+        s->total_elapsed_ms += dt;
+    } else if((s->screen == ScreenBrewing || s->screen == ScreenConfirmAbort) &&
+              s->timer_state == TimerPaused) {
+        s->step_paused_ms += dt;
     }
 }
 
+// The step's time is up: a chained step hands over, others say they
+// are done. Runs on every main loop pass, so a lost deadline event
+// costs one pass at most. True if it moved anything.
+static bool step_deadline(CoffeeApp* app) {
+    AppState* s = &app->s;
+    brew_clock(app);
+    if(s->screen != ScreenBrewing || s->timer_state != TimerRunning || s->step_complete) return false;
+    uint16_t dur = get_sdur(app, s->cur_step);
+    if(dur == 0 || s->step_elapsed_ms < dur * 1000U) return false;
+    s->step_complete = true;
+    if(get_sadvance(app, s->cur_step) == AdvanceChain) chain_step(app);
+    else notify_post(app, NotifyStepDone);
+    return true;
+}
+
+// Keeps the deadline timer on the running step's end, which pauses
+// push back; stopped when no step is counting down
+static void deadline_update(CoffeeApp* app) {
+    const AppState* s = &app->s;
+    uint16_t dur = 0;
+    if(s->screen == ScreenBrewing && s->timer_state == TimerRunning && !s->step_complete)
+        dur = get_sdur(app, s->cur_step);
+    uint32_t at = dur > 0 ? s->step_started + s->step_paused_ms + dur * 1000U : 0;
+    if(at == app->deadline_at) return;
+    app->deadline_at = at;
+    if(at == 0) {
+        furi_timer_stop(app->deadline);
+        return;
+    }
+    int32_t left = (int32_t)(at - furi_get_tick());
+    furi_timer_start(app->deadline, furi_ms_to_ticks(left > 1 ? (uint32_t)left : 1));
+}
+
+// Timer service: the main loop wakes on the event and moves the step
+static void deadline_cb(void* ctx) {
+    CoffeeApp* app = ctx;
+    AppEvent e = {.type = AppEventDeadline, .tick = furi_get_tick()};
+    furi_message_queue_put(app->queue, &e, 0);
+}
+
+// Redraw only: step ends come from the deadline timer
+static void tick_cb(void* ctx) {
+    CoffeeApp* app = ctx;
+    AppMetrics* m = &app->metrics;
+    // Misses are the only count taken without the lock the metrics
+    // screen reads and resets under; a missed tick shows up in the next
+    // interval as well
+    if(furi_mutex_acquire(app->mutex, 10) != FuriStatusOk) {
+        __atomic_fetch_add(&m->tick_misses, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    uint32_t now = furi_get_tick();
+    if(m->ticks > 0) metrics_record(&m->tick_interval, now - m->last_tick);
+    m->last_tick = now;
+    m->ticks++;
+    brew_clock(app);
+    if(app->s.screen == ScreenBrewing && app->s.timer_state == TimerRunning) {
+        if(app->s.step_elapsed_ms % 5000 == 0 && app->settings.led_on &&
+           app->s.timer_state == TimerPaused)
+            notify_post(app, NotifyPaused);
+        if(power_frame_due(app)) view_port_update(app->view_port);
+    }
+    furi_mutex_release(app->mutex);
+}
+
+// The power policy works from the current step's type and length
+static void power_step_update(CoffeeApp* app) {
+    StepType type = StepTypeCount;
+    uint16_t dur = 0;
+    if(app->s.screen == ScreenBrewing) {
+        uint8_t row = step_row(app, app->s.cur_step);
+        type = row_type(app, row);
+        dur = row_dur(app, row);
+    }
+    power_update(app, type, dur);
+}
+
+// Brew state for the telemetry stream; an idle app sends all zeroes
+static void telemetry_step_update(CoffeeApp* app) {
+    if(!app->telemetry.active) return;
+    AppState* s = &app->s;
+    TelemetryState st = {0};
+    bool brewing = s->screen == ScreenBrewing || s->screen == ScreenConfirmAbort;
+    // A service session reads as idle: its brews share no single step
+    if(!app->service.active && (brewing || s->screen == ScreenComplete)) {
+        uint32_t el = s->step_elapsed_ms / 1000;
+        uint32_t total = s->total_elapsed_ms / 1000;
+        st.method = s->cur_method;
+        st.recipe = s->cur_recipe;
+        st.step = s->cur_step;
+        st.step_count = get_scount(app);
+        st.step_sec = get_sdur(app, s->cur_step);
+        st.remaining_sec = el < st.step_sec ? (uint16_t)(st.step_sec - el) : 0;
+        st.total_sec = total > 0xFFFF ? 0xFFFF : (uint16_t)total;
+        st.water_ml = s->cumulative_water_ml;
+        if(brewing) st.flags |= TELEMETRY_F_BREWING;
+        if(s->screen == ScreenComplete) st.flags |= TELEMETRY_F_COMPLETE;
+        // The clock also stands still behind the abort dialog
+        if(s->timer_state == TimerPaused || s->screen == ScreenConfirmAbort)
+            st.flags |= TELEMETRY_F_PAUSED;
+        if(s->step_complete) st.flags |= TELEMETRY_F_STEP_DUE;
+        if(s->using_custom) st.flags |= TELEMETRY_F_CUSTOM;
+    }
+    telemetry_update(app, &st);
+}
+
+// Service mode: announce waits that ran out, hand the barista the next
+// action once it is due, and finish when every brew has
+static void service_step_update(CoffeeApp* app) {
+    AppService* sv = &app->service;
+    if(!sv->active) return;
+    uint32_t now = furi_get_tick();
+    if(service_wait_over(sv, now)) notify_post(app, NotifyStepDone);
+    if(app->s.screen != ScreenService) return;
+    if(service_finished(sv, now)) {
+        sv->ended = now;
+        app->s.screen = ScreenComplete;
+        notify_post(app, NotifyBrewDone);
+        return;
+    }
+    if(sv->act >= 0) return;
+    uint32_t wait;
+    int8_t next = service_next(sv, now, &wait);
+    if(next < 0 || wait > 0) return;
+    sv->act = next;
+    sv->act_started = now;
+    service_select(app, (uint8_t)next);
+    notify_post(app, NotifyStepChange);
+}
+
+// Scale: a step that adds water is done once the scale has gone from
+// under its target to over it, so stepping back doesn't bounce forward.
+// The filtered weight trails the pour, so the flow makes up the delay.
+static void sensor_step_update(CoffeeApp* app) {
+    AppState* s = &app->s;
+    AppSensor* sn = &app->sensor;
+    if(s->screen != ScreenBrewing || !sensor_live(sn, furi_get_tick())) return;
+    if(sn->step != s->cur_step) {
+        sn->step = s->cur_step;
+        sn->below = false;
+    }
+    uint16_t ml = app->scale.step_ml[step_row(app, s->cur_step)];
+    if(ml == 0 || s->timer_state == TimerPaused) return;
+    int32_t poured = sensor_poured(sn) + (sn->flow > 0 ? sn->flow * SENSOR_LEAD_MS / 1000 : 0);
+    if(poured < (int32_t)(s->cumulative_water_ml + ml) * 10)
+        sn->below = true;
+    else if(sn->below)
+        complete_step(app);
+}
+
+// Metrics screen: scale input off -> UART -> trace; a source that
+// can't start is passed over
+static void sensor_cycle(CoffeeApp* app) {
+    uint8_t next = app->sensor.source;
+    sensor_stop(app);
+    do
+        next = (next + 1) % SensorSourceCount;
+    while(next != SensorOff && !sensor_start(app, next));
+    app->settings.scale_source = next;
+    settings_save(app);
+}
+
 // ============================================================
-// Input: editor screens
+// Brew start
 // ============================================================
-static void handle_edit_menu(CoffeeApp* app, InputEvent* ev) {
-    uint8_t total = app->custom_count + 1;
+static void brew_start(CoffeeApp* app) {
+    AppState* s = &app->s;
+    if(get_scount(app) == 0) return;
+    s->screen = ScreenBrewing;
+    s->cur_step = 0;
+    s->step_started = s->clock_tick = furi_get_tick();
+    s->step_paused_ms = 0;
+    stats_begin(app, stats_key(s->using_custom, s->cur_method, s->cur_recipe, get_rname(app)));
+    s->step_elapsed_ms = 0;
+    s->total_elapsed_ms = 0;
+    s->step_complete = false;
+    s->cumulative_water_ml = 0;
+    s->show_upcoming = false;
+    if(s->batch == 0) s->batch = 1;
+    apply_scale(app);
+    sensor_tare(app);
+    s->timer_state = (get_sdur(app, 0) > 0) ? TimerRunning : TimerStopped;
+    if(!s->using_custom) {
+        app->settings.last_method = s->cur_method;
+        app->settings.last_recipe = s->cur_recipe;
+        app->settings.last_ratio_adjust = s->ratio_adjust;
+        settings_save(app);
+    }
+}
+
+// Brew again: opens on the last built-in recipe at its last dose. It
+// only needs the settings and the flash tables, so it runs before the
+// GUI and the custom recipe scan.
+static void launch_last(CoffeeApp* app) {
+    AppState* s = &app->s;
+    const Settings* set = &app->settings;
+    if(set->launch == LaunchMenu) return;
+    s->method_sel = s->cur_method = set->last_method;
+    s->recipe_sel = s->cur_recipe = set->last_recipe;
+    s->using_custom = false;
+    s->ratio_adjust = set->last_ratio_adjust;
+    s->batch = 1;
+    apply_scale(app);
+    s->screen = ScreenRecipeInfo;
+    if(set->launch == LaunchBrew) brew_start(app);
+}
+
+// The worker's LoadSettings, and what they start. app_alloc waits for
+// it, so nothing has been drawn or changed yet.
+static void settings_arrived(CoffeeApp* app, Settings* set) {
+    if(set) app->settings = *set;
+    free(set);
+    app->settings_loaded = true;
+    launch_last(app);
+    if(app->settings.telemetry) telemetry_start(app);
+    if(app->settings.scale_source != SensorOff) sensor_start(app, app->settings.scale_source);
+}
+
+// ============================================================
+// Editor plugin host
+// ============================================================
+static void editor_recipe_delete(CoffeeApp* app, uint8_t slot) {
+    custom_recipe_delete(app, slot);
+    service_forget_custom(&app->service, slot);
+}
+
+static const char* editor_step_type_name(StepType t) {
+    return step_type_name(t);
+}
+
+static const EditorHost editor_host = {
+    .recipe_new = custom_recipe_new,
+    .recipe_save = custom_recipe_save,
+    .recipe_delete = editor_recipe_delete,
+    .step_auto_detail = step_auto_detail,
+    .block_len = custom_block_len,
+    .step_type_name = editor_step_type_name,
+    .grind_names = grind_names,
+    .confirm_box = draw_confirm_box,
+};
+
+// ============================================================
+// Input: service mode
+// ============================================================
+// Hold Down on the info screen: queue the recipe at its dose and batch.
+// A refusal stays on the info screen until the next key.
+static void service_queue_add(CoffeeApp* app) {
+    AppService* sv = &app->service;
+    uint8_t n = get_scount(app);
+    if(sv->active) sv->refused = "Service running";
+    else if(sv->count >= SERVICE_MAX_BREWS) sv->refused = "Service queue full";
+    else if(n == 0) sv->refused = "No steps to queue";
+    else if(n > SERVICE_MAX_STEPS) sv->refused = "Too many steps to queue";
+    if(sv->refused) return;
+    service_load(app, sv->count++);
+    app->s.screen = ScreenRecipeMenu;
+}
+
+static void handle_service_queue(CoffeeApp* app, InputEvent* ev) {
+    AppService* sv = &app->service;
     if(ev->key == InputKeyUp) {
-        app->editor.sel = (app->editor.sel == 0) ? total - 1 : app->editor.sel - 1;
+        sv->sel = (sv->sel == 0) ? sv->count - 1 : sv->sel - 1;
     } else if(ev->key == InputKeyDown) {
-        app->editor.sel = (app->editor.sel >= total - 1) ? 0 : app->editor.sel + 1;
+        sv->sel = (sv->sel >= sv->count - 1) ? 0 : sv->sel + 1;
     } else if(ev->key == InputKeyOk) {
-        if(app->editor.sel >= app->custom_count) {
-            // New recipe
-            if(app->custom_count < MAX_CUSTOM_RECIPES) {
-                custom_recipe_init_new(&app->custom[app->custom_count]);
-                app->editor.recipe_idx = app->custom_count;
-                app->custom_count++;
-                app->editor.field = EditFieldName;
-                app->editor.editing = false;
-                app->s.screen = ScreenEditRecipe;
-            }
-        } else {
-            app->editor.recipe_idx = app->editor.sel;
-            app->editor.field = EditFieldName;
-            app->editor.editing = false;
-            app->s.screen = ScreenEditRecipe;
+        service_refresh(app);
+        service_start(sv, furi_get_tick());
+        app->s.screen = ScreenService;
+    } else if(ev->key == InputKeyRight) {
+        service_remove(sv, sv->sel);
+        service_plan(sv);
+        if(sv->count == 0) {
+            app->s.method_sel = method_count;
+            app->s.screen = ScreenMethodMenu;
         }
     } else if(ev->key == InputKeyBack) {
         app->s.screen = ScreenMethodMenu;
     }
 }
 
-static void handle_edit_recipe(CoffeeApp* app, InputEvent* ev) {
-    EditorState* ed = &app->editor;
-    CustomRecipe* cr = &app->custom[ed->recipe_idx];
+// ============================================================
+// Main input handler
+// ============================================================
+// Recording and replay both start from a fresh method menu
+static void session_reset(CoffeeApp* app) {
+    memset(&app->s, 0, sizeof(AppState));
+    memset(&app->editor, 0, sizeof(EditorState));
+    app->s.screen = ScreenMethodMenu;
+    app->s.running = true;
+}
 
-    if(ed->editing) {
-        // Editing a value
-        if(ev->key == InputKeyOk || ev->key == InputKeyBack) {
-            ed->editing = false;
+static void handle_debug(CoffeeApp* app, InputEvent* ev) {
+    AppMetrics* m = &app->metrics;
+    uint8_t total = metrics_line_count(app);
+    if(ev->type == InputTypeLong) {
+        // Hold Up: brew state telemetry over USB on/off
+        if(ev->key == InputKeyUp) {
+            app->settings.telemetry = !app->telemetry.active && telemetry_start(app);
+            if(!app->settings.telemetry) telemetry_stop(app);
+            settings_save(app);
             return;
         }
-        int dir = (ev->key == InputKeyRight) ? 1 : (ev->key == InputKeyLeft) ? -1 : 0;
-        if(dir == 0) return;
-
-        switch(ed->field) {
-        case EditFieldName: {
-            // Cycle character at cursor
-            size_t len = strlen(cr->name);
-            if(len == 0) { cr->name[0] = 'A'; cr->name[1] = 0; break; }
-            uint8_t pos = ed->name_cursor;
-            if(pos >= (uint8_t)len) pos = (uint8_t)(len - 1);
-            char ch = cr->name[pos];
-            ch += (char)dir;
-            if(ch < ' ') ch = 'z';
-            if(ch > 'z') ch = ' ';
-            cr->name[pos] = ch;
-            break;
-        }
-        case EditFieldGrind: {
-            // Cycle through presets
-            uint8_t gi = 0;
-            for(uint8_t i = 0; i < GRIND_COUNT; i++) {
-                if(strcmp(cr->grind, grind_names[i]) == 0) { gi = i; break; }
-            }
-            gi = (uint8_t)((int)gi + dir);
-            if(gi >= GRIND_COUNT) gi = (dir > 0) ? 0 : GRIND_COUNT - 1;
-            snprintf(cr->grind, sizeof(cr->grind), "%s", grind_names[gi]);
-            break;
-        }
-        case EditFieldCoffee: {
-            int16_t v = (int16_t)cr->coffee_grams + dir;
-            if(v < 1) v = 1;
-            if(v > 200) v = 200;
-            cr->coffee_grams = (uint8_t)v;
-            break;
-        }
-        case EditFieldWater: {
-            int16_t v = (int16_t)cr->water_ml + dir * 10;
-            if(v < 10) v = 10;
-            if(v > 2000) v = 2000;
-            cr->water_ml = (uint16_t)v;
-            break;
-        }
-        case EditFieldTemp: {
-            int16_t v = (int16_t)cr->water_temp_c + dir;
-            if(v < 0) v = 0;
-            if(v > 100) v = 100;
-            cr->water_temp_c = (uint16_t)v;
-            break;
-        }
-        default: break;
+        // Hold Down: cycle the scale input
+        if(ev->key == InputKeyDown) {
+            sensor_cycle(app);
+            return;
         }
+        // Hold OK / Right: replay input.trace at recorded / fast speed
+        if(app->trace.mode != TraceIdle) return;
+        if(ev->key != InputKeyOk && ev->key != InputKeyRight) return;
+        app->trace.speed = (ev->key == InputKeyRight) ? TRACE_FAST_SPEED : 1;
+        app->trace.mode = TraceLoading;
+        StorageRequest req = {.op = StorageOpLoadTrace};
+        storage_post(app, &req);
         return;
     }
-
-    // Not editing - navigate fields
     if(ev->key == InputKeyUp) {
-        ed->field = (ed->field == 0) ? EditFieldCount - 1 : ed->field - 1;
+        if(m->debug_line > 0) m->debug_line--;
     } else if(ev->key == InputKeyDown) {
-        ed->field = (ed->field >= EditFieldCount - 1) ? 0 : ed->field + 1;
+        if(m->debug_line + 4 < total) m->debug_line++;
     } else if(ev->key == InputKeyOk) {
-        if(ed->field == EditFieldSave) {
-            // Auto-generate instructions
-            for(uint8_t i = 0; i < cr->step_count; i++) {
-                snprintf(cr->steps[i].instruction, NAME_LEN, "%s", step_type_name(cr->steps[i].type));
-                step_auto_detail(&cr->steps[i]);
-            }
-            custom_recipe_save(app, ed->recipe_idx);
-            app->s.screen = ScreenEditMenu;
-        } else if(ed->field == EditFieldDelete) {
-            app->s.screen = ScreenConfirmDelete;
-        } else {
-            ed->editing = true;
-            if(ed->field == EditFieldName) {
-                size_t nlen = strlen(cr->name);
-                ed->name_cursor = (nlen > 0) ? (uint8_t)(nlen - 1) : 0;
-            }
-        }
+        metrics_dump(app);
     } else if(ev->key == InputKeyRight) {
-        // Go to steps editor
-        ed->sel = 0;
-        app->s.screen = ScreenEditSteps;
+        metrics_reset(app);
+    } else if(ev->key == InputKeyLeft) {
+        // Record until the metrics screen is opened again
+        if(app->trace.mode != TraceIdle) return;
+        session_reset(app);
+        trace_record_start(app);
     } else if(ev->key == InputKeyBack) {
-        app->s.screen = ScreenEditMenu;
+        app->s.screen = ScreenMethodMenu;
     }
 }
 
-static void handle_edit_steps(CoffeeApp* app, InputEvent* ev) {
-    EditorState* ed = &app->editor;
-    CustomRecipe* cr = &app->custom[ed->recipe_idx];
-    uint8_t total = cr->step_count + (cr->step_count < MAX_STEPS ? 1 : 0);
-
-    if(ev->key == InputKeyUp) {
-        ed->sel = (ed->sel == 0) ? total - 1 : ed->sel - 1;
-    } else if(ev->key == InputKeyDown) {
-        ed->sel = (ed->sel >= total - 1) ? 0 : ed->sel + 1;
-    } else if(ev->key == InputKeyOk) {
-        if(ed->sel >= cr->step_count) {
-            // Add new step
-            if(cr->step_count < MAX_STEPS) {
-                CustomStep* st = &cr->steps[cr->step_count];
-                memset(st, 0, sizeof(CustomStep));
-                st->type = StepWait;
-                st->duration_sec = 30;
-                snprintf(st->instruction, NAME_LEN, "Wait");
-                snprintf(st->detail, DETAIL_LEN, "30s");
-                ed->step_idx = cr->step_count;
-                cr->step_count++;
-                ed->step_field = StepFieldType;
-                app->s.screen = ScreenEditStep;
-            }
-        } else {
-            ed->step_idx = ed->sel;
-            ed->step_field = StepFieldType;
-            app->s.screen = ScreenEditStep;
-        }
-    } else if(ev->key == InputKeyRight) {
-        // Delete step
-        if(ed->sel < cr->step_count && cr->step_count > 0) {
-            for(uint8_t i = ed->sel; i < cr->step_count - 1; i++)
-                memcpy(&cr->steps[i], &cr->steps[i + 1], sizeof(CustomStep));
-            cr->step_count--;
-            if(ed->sel >= cr->step_count && ed->sel > 0) ed->sel--;
-        }
-    } else if(ev->key == InputKeyBack) {
-        app->s.screen = ScreenEditRecipe;
+static void handle_input(CoffeeApp* app, InputEvent* ev) {
+    AppState* s = &app->s;
+    brew_clock(app);
+    // Hidden: hold Left on the method menu to open the metrics screen
+    if(s->screen == ScreenMethodMenu && ev->type == InputTypeLong && ev->key == InputKeyLeft) {
+        trace_record_stop(app);
+        app->metrics.debug_line = 0;
+        s->screen = ScreenDebug;
+        return;
     }
-}
-
-static void handle_edit_step(CoffeeApp* app, InputEvent* ev) {
-    EditorState* ed = &app->editor;
-    CustomStep* st = &app->custom[ed->recipe_idx].steps[ed->step_idx];
-
-    if(ev->key == InputKeyUp) {
-        ed->step_field = (ed->step_field == 0) ? StepFieldCount - 1 : ed->step_field - 1;
-    } else if(ev->key == InputKeyDown) {
-        ed->step_field = (ed->step_field >= StepFieldCount - 1) ? 0 : ed->step_field + 1;
-    } else if(ev->key == InputKeyLeft || ev->key == InputKeyRight) {
-        int dir = (ev->key == InputKeyRight) ? 1 : -1;
-        switch(ed->step_field) {
-        case StepFieldType: {
-            int t = (int)st->type + dir;
-            if(t < 0) t = (int)StepSwirl;
-            if(t > (int)StepSwirl) t = 0;
-            st->type = (StepType)t;
-            snprintf(st->instruction, NAME_LEN, "%s", step_type_name(st->type));
-            break;
-        }
-        case StepFieldDuration: {
-            int16_t v = (int16_t)st->duration_sec + dir * 5;
-            if(v < 0) v = 0;
-            if(v > 600) v = 600;
-            st->duration_sec = (uint16_t)v;
-            break;
-        }
-        case StepFieldWater: {
-            int16_t v = (int16_t)st->water_ml_div10 + dir;
-            if(v < 0) v = 0;
-            if(v > 200) v = 200;
-            st->water_ml_div10 = (uint8_t)v;
-            break;
+    if(ev->type == InputTypeLong && s->screen == ScreenDebug) {
+        handle_debug(app, ev);
+        return;
+    }
+    // The editor plugin takes every event while its screens are open
+    if(screen_is_editor(s->screen)) {
+        if(app->editor_api) app->editor_api->input(app, ev);
+        if(!screen_is_editor(s->screen)) editor_unload(app);
+        return;
+    }
+    if(s->screen == ScreenRecipeInfo && ev->type == InputTypePress) app->service.refused = NULL;
+    // Info: tap Down cycles the batch, hold Down queues the brew for service
+    if(s->screen == ScreenRecipeInfo && ev->key == InputKeyDown) {
+        if(ev->type == InputTypeShort) {
+            // Batch x1..x3; wrapping back to x1 also resets the dose
+            s->batch = (s->batch >= MAX_BATCH) ? 1 : s->batch + 1;
+            if(s->batch == 1) s->ratio_adjust = 0;
+            apply_scale(app);
+        } else if(ev->type == InputTypeLong) {
+            service_queue_add(app);
         }
-        case StepFieldWeight: {
-            int16_t v = (int16_t)st->weight_grams + dir;
-            if(v < 0) v = 0;
-            if(v > 200) v = 200;
-            st->weight_grams = (uint8_t)v;
-            break;
+        return;
+    }
+    // Info: tap OK starts the brew, hold OK cycles what launch opens on
+    if(s->screen == ScreenRecipeInfo && ev->key == InputKeyOk) {
+        if(ev->type == InputTypeShort) {
+            brew_start(app);
+        } else if(ev->type == InputTypeLong) {
+            Settings* set = &app->settings;
+            set->launch = (set->launch + 1) % LaunchCount;
+            settings_save(app);
         }
-        default: break;
+        return;
+    }
+    // Info: tap Up cycles the alert options, hold Up toggles power save
+    if(s->screen == ScreenRecipeInfo && ev->key == InputKeyUp) {
+        Settings* set = &app->settings;
+        if(ev->type == InputTypeShort) {
+            if(!set->auto_advance) set->auto_advance = true;
+            else if(set->sound_on) set->sound_on = false;
+            else if(set->led_on) set->led_on = false;
+            else { set->auto_advance = false; set->sound_on = true; set->led_on = true; }
+            settings_save(app);
+        } else if(ev->type == InputTypeLong) {
+            set->power_save_types = set->power_save_types ? 0 : POWER_SAVE_DEFAULT;
+            settings_save(app);
         }
-        step_auto_detail(st);
-    } else if(ev->key == InputKeyOk || ev->key == InputKeyBack) {
-        step_auto_detail(st);
-        app->s.screen = ScreenEditSteps;
+        return;
     }
-}
-
-// ============================================================
-// Main input handler
-// ============================================================
-static void handle_input(CoffeeApp* app, InputEvent* ev) {
     if(ev->type != InputTypePress && ev->type != InputTypeRepeat) return;
-    AppState* s = &app->s;
 
     switch(s->screen) {
     case ScreenConfirmAbort:
-        if(ev->key == InputKeyOk) { s->screen = ScreenRecipeMenu; s->timer_state = TimerStopped; }
-        else if(ev->key == InputKeyBack) s->screen = ScreenBrewing;
-        break;
-
-    case ScreenConfirmDelete:
+        // Waits keep running behind the dialog; stopping keeps the queue
+        if(app->service.active) {
+            if(ev->key == InputKeyOk) {
+                app->service.active = false;
+                s->screen = ScreenServiceQueue;
+            } else if(ev->key == InputKeyBack) {
+                s->screen = ScreenService;
+            }
+            break;
+        }
         if(ev->key == InputKeyOk) {
-            custom_recipe_delete(app, app->editor.recipe_idx);
-            app->editor.sel = 0;
-            s->screen = ScreenEditMenu;
-        } else if(ev->key == InputKeyBack) {
-            s->screen = ScreenEditRecipe;
+            s->screen = ScreenRecipeMenu;
+            s->timer_state = TimerStopped;
+            stats_flush(app);
         }
+        else if(ev->key == InputKeyBack) s->screen = ScreenBrewing;
         break;
 
     case ScreenMethodMenu: {
-        uint8_t total = method_count + 1;
-        if(ev->key == InputKeyUp) {
-            s->method_sel = (s->method_sel == 0) ? total - 1 : s->method_sel - 1;
-        } else if(ev->key == InputKeyDown) {
-            s->method_sel = (s->method_sel >= total - 1) ? 0 : s->method_sel + 1;
+        ListSource src = method_list(app);
+        bool cust_busy = (s->method_sel == method_count && !app->custom_loaded);
+        if(cust_busy && (ev->key == InputKeyOk || ev->key == InputKeyRight)) break;
+        if(list_nav(&src, ev, &s->method_sel)) {
+            break;
+        } else if(ev->key == InputKeyOk && s->method_sel > method_count) {
+            app->service.sel = 0;
+            service_refresh(app);
+            s->screen = ScreenServiceQueue;
         } else if(ev->key == InputKeyOk) {
+            // Files pushed over USB since the last look show up in place
+            if(s->method_sel == method_count) custom_recipes_sync(app);
             s->recipe_sel = 0;
             s->screen = ScreenRecipeMenu;
-        } else if(ev->key == InputKeyRight && s->method_sel >= method_count) {
+        } else if(ev->key == InputKeyRight && s->method_sel == method_count) {
             // Edit custom recipes
+            if(!editor_load(app, &editor_host)) break;
             app->editor.sel = 0;
             s->screen = ScreenEditMenu;
         } else if(ev->key == InputKeyBack) {
@@ -821,20 +1200,22 @@ static void handle_input(CoffeeApp* app, InputEvent* ev) {
 
     case ScreenRecipeMenu: {
         bool is_cust = (s->method_sel >= method_count);
-        uint8_t count = is_cust ? app->custom_count : methods[s->method_sel].recipe_count;
-        if(count == 0) {
+        ListSource src = recipe_list(app);
+        if(src.count == 0) {
             if(ev->key == InputKeyBack) s->screen = ScreenMethodMenu;
             break;
         }
-        if(ev->key == InputKeyUp) {
-            s->recipe_sel = (s->recipe_sel == 0) ? count - 1 : s->recipe_sel - 1;
-        } else if(ev->key == InputKeyDown) {
-            s->recipe_sel = (s->recipe_sel >= count - 1) ? 0 : s->recipe_sel + 1;
+        if(list_nav(&src, ev, &s->recipe_sel)) {
+            break;
+        } else if(ev->key == InputKeyLeft) {
+            list_jump(app, &src, LIST_KEY_RECIPES(s->method_sel), &s->recipe_sel);
         } else if(ev->key == InputKeyOk) {
             s->cur_method = s->method_sel;
-            s->cur_recipe = s->recipe_sel;
+            s->cur_recipe = is_cust ? app->custom_order[s->recipe_sel] : s->recipe_sel;
             s->using_custom = is_cust;
             s->ratio_adjust = 0;
+            s->batch = 1;
+            apply_scale(app);
             s->screen = ScreenRecipeInfo;
         } else if(ev->key == InputKeyRight && !is_cust) {
             settings_toggle_favourite(&app->settings, s->method_sel, s->recipe_sel);
@@ -846,32 +1227,12 @@ static void handle_input(CoffeeApp* app, InputEvent* ev) {
     }
 
     case ScreenRecipeInfo:
-        if(ev->key == InputKeyOk) {
-            s->screen = ScreenBrewing;
-            s->cur_step = 0;
-            s->step_elapsed_ms = 0;
-            s->total_elapsed_ms = 0;
-            s->step_complete = false;
-            s->cumulative_water_ml = 0;
-            s->show_upcoming = false;
-            s->timer_state = (get_sdur(app, 0) > 0) ? TimerRunning : TimerStopped;
-            if(!s->using_custom) {
-                app->settings.last_method = s->cur_method;
-                app->settings.last_recipe = s->cur_recipe;
-                settings_save(app);
-            }
-        } else if(ev->key == InputKeyLeft) {
+        if(ev->key == InputKeyLeft) {
             if(s->ratio_adjust > -5) s->ratio_adjust--;
+            apply_scale(app);
         } else if(ev->key == InputKeyRight) {
             if(s->ratio_adjust < 5) s->ratio_adjust++;
-        } else if(ev->key == InputKeyUp) {
-            if(!app->settings.auto_advance) app->settings.auto_advance = true;
-            else if(app->settings.sound_on) app->settings.sound_on = false;
-            else if(app->settings.led_on) app->settings.led_on = false;
-            else { app->settings.auto_advance = false; app->settings.sound_on = true; app->settings.led_on = true; }
-            settings_save(app);
-        } else if(ev->key == InputKeyDown) {
-            s->ratio_adjust = 0;
+            apply_scale(app);
         } else if(ev->key == InputKeyBack) {
             s->screen = ScreenRecipeMenu;
         }
@@ -880,13 +1241,16 @@ static void handle_input(CoffeeApp* app, InputEvent* ev) {
     case ScreenBrewing: {
         uint16_t dur = get_sdur(app, s->cur_step);
         if(ev->key == InputKeyOk) {
-            if(dur == 0 || s->step_complete) advance(app);
+            if(s->step_complete && get_sadvance(app, s->cur_step) == AdvanceArm) chain_step(app);
+            else if(dur == 0 || s->step_complete) complete_step(app);
             else if(s->timer_state == TimerRunning) s->timer_state = TimerPaused;
             else if(s->timer_state == TimerPaused) s->timer_state = TimerRunning;
         } else if(ev->key == InputKeyRight) { advance(app); }
         else if(ev->key == InputKeyLeft) {
             uint8_t sc = get_scount(app);
             s->cur_step = (s->cur_step > 0) ? s->cur_step - 1 : sc - 1;
+            s->step_started = furi_get_tick();
+            s->step_paused_ms = 0;
             s->step_elapsed_ms = 0;
             s->step_complete = false;
             s->timer_state = (get_sdur(app, s->cur_step) > 0) ? TimerRunning : TimerStopped;
@@ -900,32 +1264,99 @@ static void handle_input(CoffeeApp* app, InputEvent* ev) {
     }
 
     case ScreenComplete:
+        // A finished service has served its queue
+        if(app->service.active && (ev->key == InputKeyOk || ev->key == InputKeyBack)) {
+            app->service.active = false;
+            app->service.count = 0;
+            if(s->method_sel > method_count) s->method_sel = method_count;
+        }
         if(ev->key == InputKeyOk) s->screen = ScreenMethodMenu;
         else if(ev->key == InputKeyBack) s->running = false;
         break;
 
-    // Editor screens
-    case ScreenEditMenu:   handle_edit_menu(app, ev); break;
-    case ScreenEditRecipe: handle_edit_recipe(app, ev); break;
-    case ScreenEditSteps:  handle_edit_steps(app, ev); break;
-    case ScreenEditStep:   handle_edit_step(app, ev); break;
+    case ScreenDebug:      handle_debug(app, ev); break;
+
+    case ScreenServiceQueue: handle_service_queue(app, ev); break;
+    case ScreenService:
+        if(ev->key == InputKeyOk) service_step_done(&app->service, furi_get_tick());
+        else if(ev->key == InputKeyBack) s->screen = ScreenConfirmAbort;
+        break;
+    default: break;
+    }
+}
+
+// ============================================================
+// Storage completions
+// ============================================================
+static void handle_storage_done(CoffeeApp* app, StorageResult* r) {
+    metrics_record(&app->metrics.storage, r->duration_ms);
+    if(r->op == StorageOpLoadStats) {
+        stats_loaded(app, r->stats);
+        return;
+    }
+    if(r->op == StorageOpLoadScaleTrace) {
+        sensor_trace_loaded(app, r->ok);
+        return;
+    }
+    if(r->op == StorageOpSyncCustom) {
+        custom_sync_apply(app, r->sync);
+        return;
+    }
+    if(r->op == StorageOpLoadSettings) {
+        settings_arrived(app, r->settings);
+        return;
+    }
+    if(r->op == StorageOpLoadCustom) {
+        app->custom_count = r->count;
+        app->custom_loaded = true;
+        list_index_invalidate(app);
+        app->metrics.custom_ready_ms = furi_get_tick() - app->metrics.launch_tick;
+        FURI_LOG_I(COFFEE_TIMER_TAG, "Custom recipes ready after %lums", app->metrics.custom_ready_ms);
+        custom_recipes_sync(app);       // .brew files changed on the card since
+
+    } else if(r->op == StorageOpLoadTrace && app->trace.mode == TraceLoading) {
+        if(r->ok) {
+            bool auto_adv = false;
+            trace_check_header(app->trace.buf, TRACE_HEADER_SIZE, &auto_adv);
+            session_reset(app);
+            app->trace.user_settings = app->settings;
+            app->settings.auto_advance = auto_adv;
+            trace_replay_start(app);
+        } else {
+            app->trace.mode = TraceIdle;
+            FURI_LOG_E(COFFEE_TIMER_TAG, "No input trace to replay");
+        }
+    } else if(!r->ok) {
+        FURI_LOG_E(COFFEE_TIMER_TAG, "Storage op %d failed", r->op);
     }
 }
 
 // ============================================================
 // Alloc / Free / Main
 // ============================================================
+
 static CoffeeApp* app_alloc(void) {
     CoffeeApp* app = malloc(sizeof(CoffeeApp));
     memset(app, 0, sizeof(CoffeeApp));
+    app->metrics.launch_tick = furi_get_tick();
     app->s.screen = ScreenMethodMenu;
     app->s.running = true;
 
-    settings_load(app);
-    custom_recipes_load(app);
-
     app->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
-    app->queue = furi_message_queue_alloc(8, sizeof(InputEvent));
+    app->queue = furi_message_queue_alloc(EVENT_QUEUE_LEN, sizeof(AppEvent));
+    settings_defaults(&app->settings);
+    app->notif = furi_record_open(RECORD_NOTIFICATION);
+    notify_start(app);
+    // The store is opened and read on the worker. The GUI waits for the
+    // settings, so the first frame is already the one launch_last picks.
+    storage_worker_start(app);
+    StorageRequest req = {.op = StorageOpLoadSettings};
+    if(!storage_post(app, &req)) settings_arrived(app, NULL);
+    AppEvent ev;
+    while(!app->settings_loaded &&
+          furi_message_queue_get(app->queue, &ev, FuriWaitForever) == FuriStatusOk)
+        if(ev.type == AppEventStorage) handle_storage_done(app, &ev.storage);
+
     app->view_port = view_port_alloc();
     view_port_draw_callback_set(app->view_port, draw_cb, app);
     view_port_input_callback_set(app->view_port, input_cb, app);
@@ -933,34 +1364,97 @@ static CoffeeApp* app_alloc(void) {
     gui_add_view_port(app->gui, app->view_port, GuiLayerFullscreen);
     app->timer = furi_timer_alloc(tick_cb, FuriTimerTypePeriodic, app);
     furi_timer_start(app->timer, furi_ms_to_ticks(100));
-    app->notif = furi_record_open(RECORD_NOTIFICATION);
+    app->deadline = furi_timer_alloc(deadline_cb, FuriTimerTypeOnce, app);
+    deadline_update(app);           // launch_last may have started a brew
+
+    // Custom recipes come off the SD card after the first frame; the
+    // method menu only needs the flash tables in recipes.c.
+    req.op = StorageOpLoadCustom;
+    storage_post(app, &req);
     return app;
 }
 
 static void app_free(CoffeeApp* app) {
     furi_timer_stop(app->timer);
     furi_timer_free(app->timer);
+    furi_timer_stop(app->deadline);
+    furi_timer_free(app->deadline);
     gui_remove_view_port(app->gui, app->view_port);
     furi_record_close(RECORD_GUI);
     view_port_free(app->view_port);
+    editor_unload(app);
+    app->storage_closing = true;
+    trace_shutdown(app);
+    stats_flush(app);
+    telemetry_stop(app);
+    sensor_stop(app);
+    settings_flush(app);
+    StorageRequest req = {.op = StorageOpExportCustom};
+    storage_post(app, &req);
+    storage_worker_stop(app);
+    free(app->trace.buf);       // a trace still loading at exit
+    free(app->sensor.trace);
+    AppEvent ev;
+    while(furi_message_queue_get(app->queue, &ev, 0) == FuriStatusOk)
+        if(ev.type == AppEventStorage) {
+            free(ev.storage.settings);
+            free(ev.storage.stats);
+            free(ev.storage.sync);
+        }
     furi_message_queue_free(app->queue);
     furi_mutex_free(app->mutex);
+    power_release(app);
+    notify_stop(app);
     furi_record_close(RECORD_NOTIFICATION);
     free(app);
 }
 
+// One pass of the main loop: handle at most one queued event, then run
+// the time-driven transitions. Host tools call this to drive the app.
+static void app_process(CoffeeApp* app, uint32_t timeout) {
+    AppEvent ev;
+    FuriStatus st = furi_message_queue_get(app->queue, &ev, timeout);
+    bool redraw = true;
+    metrics_sample(app);
+    if(furi_mutex_acquire(app->mutex, 25) == FuriStatusOk) {
+        if(st == FuriStatusOk && (ev.type == AppEventInput || ev.type == AppEventReplay))
+            power_wake(app);
+        if(st == FuriStatusOk && ev.type == AppEventInput && app->trace.mode == TraceReplaying) {
+            // A real key press takes the app back from a replay
+            trace_replay_stop(app);
+        } else if(st == FuriStatusOk && ev.type == AppEventReplay && app->trace.mode != TraceReplaying) {
+            // Left in the queue by a replay that was cancelled
+        } else if(st == FuriStatusOk && (ev.type == AppEventInput || ev.type == AppEventReplay)) {
+            metrics_record(&app->metrics.input_latency, furi_get_tick() - ev.tick);
+            if(ev.type == AppEventInput) trace_record(app, &ev.input, ev.tick);
+            handle_input(app, &ev.input);
+        } else if(st == FuriStatusOk && ev.type == AppEventStorage) {
+            handle_storage_done(app, &ev.storage);
+        } else if(st == FuriStatusOk && ev.type == AppEventReplayDone) {
+            trace_replay_stop(app);
+        } else if(st == FuriStatusOk && ev.type == AppEventDeadline) {
+            app->deadline_at = 0;       // fired; set again if it came early
+        }
+        bool moved = step_deadline(app);
+        deadline_update(app);
+        AppState* s = &app->s;
+        sensor_poll(app, s->screen == ScreenBrewing || s->screen == ScreenConfirmAbort);
+        sensor_step_update(app);
+        service_step_update(app);
+        power_step_update(app);
+        telemetry_step_update(app);
+        settings_flush(app);
+        redraw = st == FuriStatusOk || moved || power_frame_due(app);
+        furi_mutex_release(app->mutex);
+    }
+    if(redraw) view_port_update(app->view_port);
+}
+
 int32_t coffee_timer_main(void* p) {
     UNUSED(p);
     CoffeeApp* app = app_alloc();
-    InputEvent ev;
     while(app->s.running) {
-        FuriStatus st = furi_message_queue_get(app->queue, &ev, 100);
-        if(furi_mutex_acquire(app->mutex, 25) == FuriStatusOk) {
-            if(st == FuriStatusOk) handle_input(app, &ev);
-            check_auto_advance(app);
-            furi_mutex_release(app->mutex);
-        }
-        view_port_update(app->view_port);
+        app_process(app, 100);
     }
     app_free(app);
     return 0;
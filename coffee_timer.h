@@ -6,11 +6,25 @@
 #include <notification/notification.h>
 #include <notification/notification_messages.h>
 #include <storage/storage.h>
+#include <furi_hal_usb.h>
+#include <furi_hal_serial.h>
 
 #define COFFEE_TIMER_TAG "CoffeeTimer"
-#define SAVE_PATH APP_DATA_PATH("settings.bin")
+#define SAVE_PATH APP_DATA_PATH("settings.bin")    // before the store; read once
+#define STORE_PATH APP_DATA_PATH("store.log")
+#define STORE_TMP_PATH APP_DATA_PATH("store.tmp")
 #define CUSTOM_DIR APP_DATA_PATH("recipes")
-#define MAX_STEPS 10
+#define METRICS_PATH APP_DATA_PATH("metrics.txt")
+#define TRACE_PATH APP_DATA_PATH("input.trace")
+#define STATS_PATH APP_DATA_PATH("stats.bin")          // before the store; read once
+#define SENSOR_TRACE_PATH APP_DATA_PATH("scale.trace")
+#define EVENT_QUEUE_LEN 8
+#define STORAGE_QUEUE_LEN 8
+#define STORAGE_POST_MS 20  // longest a request waits for queue room
+#define MAX_STEPS 10         // program rows per recipe
+#define MAX_BREW_STEPS 99    // steps once repeat blocks are expanded
+#define MIN_REPEAT 2
+#define MAX_REPEAT 20
 #define MAX_CUSTOM_RECIPES 4
 #define NAME_LEN 20
 #define DETAIL_LEN 28
@@ -27,33 +41,67 @@ typedef enum {
     StepPrep,
     StepPour,
     StepSwirl,
+    StepRepeat,             // program row: run the next rows several times
     StepTypeCount,
 } StepType;
 
+// A recipe is a small step program. A StepRepeat row reuses the step
+// fields: duration_sec is the pass count and weight_grams the number of
+// rows after it that form the block. Blocks don't nest; a repeat row
+// inside a block ends it. The brew engine walks the program on demand,
+// so a repeated step costs one row however many times it runs.
+typedef struct {
+    uint8_t row;            // program row the step comes from
+    uint8_t pass;           // 0-based pass through its block
+    uint8_t passes;         // 1 outside a block
+} StepRef;
+
+// What a timed step does at its deadline when the next step is timed
+// too. Only with auto-advance on; otherwise every step waits for OK.
+typedef enum {
+    AdvanceDefault,         // step row: as its type says
+    AdvanceChain,           // the next step starts at the deadline
+    AdvanceArm,             // the next step's clock starts at the deadline,
+                            // the screen moves to it on OK
+    AdvanceConfirm,         // the next step starts on OK
+    AdvanceCount,
+} StepAdvance;
+
+// File token / badge and display name, as offsets into recipe_strings,
+// and the type's StepAdvance
+typedef struct {
+    uint16_t token;
+    uint16_t name;
+    uint8_t advance;
+} StepTypeInfo;
+
 // ============================================================
 // Built-in recipe structs (const, in flash)
+// Generated into recipes.c from recipes.def; text fields are
+// offsets into the shared recipe_strings pool.
 // ============================================================
 typedef struct {
-    const char* instruction;
-    const char* detail;
+    uint16_t instruction;
+    uint16_t detail;
     uint16_t duration_sec;
     uint8_t weight_grams;
     uint8_t water_ml_div10;
-    StepType type;
+    uint8_t type;               // StepType
+    uint8_t advance;            // StepAdvance
 } BrewStep;
 
 typedef struct {
-    const char* name;
-    const char* grind;
+    uint16_t name;
+    uint16_t grind;
     const BrewStep* steps;
     uint16_t water_ml;
     uint16_t water_temp_c;
     uint8_t coffee_grams;
-    uint8_t step_count;
+    uint8_t step_count;         // program rows
 } Recipe;
 
 typedef struct {
-    const char* name;
+    uint16_t name;
     const Recipe* recipes;
     uint8_t recipe_count;
 } BrewMethod;
@@ -68,8 +116,15 @@ typedef struct {
     uint8_t weight_grams;
     uint8_t water_ml_div10;
     StepType type;
+    uint8_t advance;            // StepAdvance
 } CustomStep;
 
+// A file as the directory last showed it, to tell when it changes
+typedef struct {
+    uint32_t size;
+    uint32_t time;              // modified; 0 where the card keeps none
+} FileStamp;
+
 typedef struct {
     char name[NAME_LEN];
     char grind[16];
@@ -77,11 +132,66 @@ typedef struct {
     uint16_t water_ml;
     uint16_t water_temp_c;
     uint8_t coffee_grams;
-    uint8_t step_count;
+    uint8_t step_count;         // program rows
     char filename[32];
-    bool loaded;
+    FileStamp stamp;            // of the file when imported or exported
+    bool loaded;                // slot in use
 } CustomRecipe;
 
+// A stored recipe's .brew file. Saves go to the store only; the file
+// is written when the app exits.
+typedef struct {
+    char filename[32];
+    FileStamp stamp;            // size 0: not on the card yet
+    bool exported;              // the file has the stored version
+} CustomFileRecord;
+
+// Change scan: the app's saved recipes go to the worker, and only the
+// files that differ from them come back parsed
+#define CUSTOM_SYNC_NEW 0xFF    // slot of a file the app doesn't have
+#define CUSTOM_SYNC_MAX (MAX_CUSTOM_RECIPES * 2)
+
+typedef struct {
+    char filename[32];
+    FileStamp stamp;
+    uint8_t slot;
+} CustomFileRef;
+
+typedef struct {
+    uint8_t slot;               // CUSTOM_SYNC_NEW for an added file
+    bool removed;               // file gone; else recipe holds its contents
+    CustomRecipe recipe;        // filename set in either case
+} CustomChange;
+
+typedef struct {
+    uint8_t count;
+    CustomChange change[];
+} CustomSync;
+
+// The directory scan runs out of one arena: a read buffer per file,
+// reused, plus the name and path buffers
+#define BREW_FILE_MAX 1024
+#define CUSTOM_ARENA_SIZE (BREW_FILE_MAX + 256)
+
+typedef struct {
+    uint8_t* base;
+    size_t size;
+    size_t used;
+} Arena;
+
+// ============================================================
+// Scrolling lists
+// ============================================================
+#define LIST_ROWS 4             // rows on screen
+#define LIST_MAX 64             // rows a letter index covers
+
+// Rows sorted by name, for first-letter jumps
+typedef struct {
+    uint16_t key;               // list it was built for; 0 = stale
+    uint8_t count;
+    uint8_t sorted[LIST_MAX];
+} ListIndex;
+
 // ============================================================
 // Grind presets
 // ============================================================
@@ -103,6 +213,10 @@ typedef enum {
     ScreenEditSteps,
     ScreenEditStep,
     ScreenConfirmDelete,
+    ScreenDebug,
+    ScreenServiceQueue,
+    ScreenService,
+    ScreenCount,
 } Screen;
 
 typedef enum {
@@ -111,6 +225,17 @@ typedef enum {
     TimerPaused,
 } TimerState;
 
+// Ordered by priority: when events pile up the highest one is played.
+// NotifyBacklight only wakes the dispatcher to apply AppPower's state.
+typedef enum {
+    NotifyBacklight,
+    NotifyPaused,
+    NotifyStepChange,
+    NotifyStepDone,
+    NotifyBrewDone,
+    NotifyStop,
+} NotifyEvent;
+
 // ============================================================
 // Editor state
 // ============================================================
@@ -134,18 +259,46 @@ typedef enum {
 } StepField;
 
 typedef struct {
-    uint8_t recipe_idx;
+    uint8_t recipe_idx;     // custom[] slot
     uint8_t step_idx;
     uint8_t sel;            // menu selection in edit screens
     EditField field;
     StepField step_field;
     uint8_t name_cursor;
     bool editing;           // actively changing a value
+    bool name_ok_down;      // OK went down in the name editor
+    InputKey held_key;      // key behind the current repeat run
+    uint8_t repeats;        // InputTypeRepeat events since its press
 } EditorState;
 
+// The editor screens live in a plugin loaded while they are open
+typedef struct EditorPlugin EditorPlugin;
+
+// ============================================================
+// Dose scaling: amounts for the selected recipe at the chosen dose
+// and batch, computed once so draw and advance just index them
+// ============================================================
+#define MAX_BATCH 3
+
+typedef struct {
+    uint32_t factor_q16;
+    uint16_t coffee_g;
+    uint16_t water_ml;
+    uint16_t step_grams[MAX_STEPS];     // per program row
+    uint16_t step_ml[MAX_STEPS];
+} BrewScale;
+
 // ============================================================
 // Settings
 // ============================================================
+// What the app opens on: the menu, or the last built-in recipe
+typedef enum {
+    LaunchMenu,
+    LaunchInfo,
+    LaunchBrew,
+    LaunchCount,
+} LaunchMode;
+
 typedef struct {
     uint8_t last_method;
     uint8_t last_recipe;
@@ -154,8 +307,397 @@ typedef struct {
     bool led_on;
     uint8_t favourites[8];
     uint8_t fav_count;
+    uint16_t power_save_types;  // StepType bits whose long steps may dim
+    bool telemetry;             // stream brew state over USB serial
+    int8_t last_ratio_adjust;   // dose adjust of the last brew
+    uint8_t launch;             // LaunchMode
+    uint8_t scale_source;       // SensorSource
 } Settings;
 
+// ============================================================
+// Display power: during long steps of the types in
+// Settings.power_save_types the backlight may time out and the
+// screen redraws every POWER_FRAME_MS, until a key is pressed or
+// the deadline is POWER_WAKE_SEC away
+// ============================================================
+#define POWER_SAVE_DEFAULT (1 << StepWait)
+#define POWER_MIN_STEP_SEC 45
+#define POWER_WAKE_SEC     10
+#define POWER_IDLE_MS      8000
+#define POWER_FRAME_MS     3000
+
+typedef struct {
+    bool low;               // dimmable, slow redraws
+    bool backlight_held;    // backlight to be held lit; notify.c applies it
+    uint32_t last_input;
+    uint32_t last_frame;
+} AppPower;
+
+// ============================================================
+// Metrics
+// ============================================================
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+} MetricTiming;
+
+typedef struct {
+    uint32_t ticks;
+    uint32_t tick_misses;
+    uint32_t last_tick;
+    MetricTiming tick_interval;     // ms between timer callbacks
+    uint32_t frame_misses;
+    MetricTiming frame;             // us per draw_cb, all screens
+    MetricTiming draw[ScreenCount]; // us per draw_cb, by screen
+    MetricTiming input_latency;     // ms from input_cb to handle_input
+    MetricTiming storage;           // ms per SD operation
+    uint32_t queue_max;
+    uint32_t storage_drops;         // requests lost to a full storage queue
+    uint32_t stack_min;             // bytes, main thread high-water
+    uint32_t launch_tick;
+    uint32_t first_frame_ms;        // launch -> first draw_cb finished
+    uint32_t custom_ready_ms;       // launch -> custom recipes published
+    uint32_t editor_load_ms;        // last editor plugin load
+    uint32_t editor_heap;           // heap it took, bytes
+    uint8_t debug_line;             // scroll position on ScreenDebug
+} AppMetrics;
+
+// ============================================================
+// Input trace: recorded inputs, replayed through the main queue
+// ============================================================
+#define TRACE_MAX_EVENTS 1024
+#define TRACE_HEADER_SIZE 8
+#define TRACE_REC_SIZE 3
+#define TRACE_FAST_SPEED 8
+
+typedef enum {
+    TraceIdle,
+    TraceRecording,
+    TraceLoading,
+    TraceReplaying,
+} TraceMode;
+
+typedef struct {
+    TraceMode mode;
+    uint8_t* buf;                   // header + records
+    uint16_t count;                 // records in buf
+    uint32_t last_tick;             // recording: tick of the last record
+    uint8_t speed;                  // replay: delay divisor
+    Settings user_settings;         // replay: restored afterwards
+    FuriThread* thread;
+    volatile bool stop;
+} AppTrace;
+
+// ============================================================
+// Step timing: per recipe and program row, a running mean and
+// variance (Welford) of how long finished steps really took. The
+// store keeps STATS_SLOTS RecipeStats records, one per key.
+// ============================================================
+#define STATS_SLOTS    24
+#define STATS_MAX_N    32       // past this, old samples fade out
+#define STATS_MAX_MS   1800000  // longer means the brew was left alone
+#define STATS_ROUGH_SEC 15      // ETA spread that earns a "~"
+
+typedef struct {
+    float mean_sec;
+    float m2;               // sum of squared deviations
+    uint16_t n;
+} StepStat;
+
+typedef struct {
+    uint16_t key;           // 0 = empty slot
+    StepStat row[MAX_STEPS];
+} RecipeStats;
+
+// Brew log: a record per finished brew, the last STATS_LOG_SIZE kept
+// in the app data store
+#define STATS_LOG_SIZE 16
+
+typedef struct {
+    uint32_t seq;           // brews logged so far, this one included
+    uint32_t time;          // RTC, seconds since 1970
+    uint16_t key;           // recipe, as stats_key() has it
+    uint16_t total_sec;
+    uint16_t coffee_g;
+    uint16_t water_ml;
+    int8_t ratio_adjust;
+    uint8_t batch;
+    bool auto_advance;
+} BrewLogEntry;
+
+typedef struct {
+    RecipeStats cur;        // the recipe being brewed
+    bool loading;           // history requested, not merged yet
+    bool dirty;             // samples not written yet
+    bool flush_after_load;
+} AppStats;
+
+// ============================================================
+// Service mode: queued brews run as one guided session. Timed
+// Wait steps run on their own; every other step needs the
+// barista, so the planner fits one brew's hands-on steps into
+// another's waits and picks the start order that ends soonest.
+// ============================================================
+#define SERVICE_MAX_BREWS  4
+#define SERVICE_MAX_STEPS  24   // brew steps kept per queued recipe
+#define SERVICE_MANUAL_SEC 15   // planning guess for an untimed step
+#define SERVICE_LATE_SEC   5    // a wait may run over this much for a new start
+
+typedef struct {
+    bool custom;
+    uint8_t method;
+    uint8_t recipe;         // custom[] slot for a custom recipe
+    int8_t ratio_adjust;
+    uint8_t batch;
+    char name[NAME_LEN];
+    uint8_t step_count;
+    uint16_t dur[SERVICE_MAX_STEPS];
+    uint8_t type[SERVICE_MAX_STEPS];    // StepType
+    uint8_t step;           // next step for the barista
+    bool started;
+    bool alerted;           // end of its wait already announced
+    uint32_t ready;         // tick its wait ends
+} ServiceBrew;
+
+typedef struct {
+    ServiceBrew brew[SERVICE_MAX_BREWS];
+    uint8_t count;
+    uint8_t sel;                        // queue screen selection
+    uint8_t order[SERVICE_MAX_BREWS];   // start order the planner picked
+    uint32_t plan_sec;                  // planned session length
+    uint32_t serial_sec;                // the same brews one by one
+    bool active;
+    int8_t act;                         // brew the barista is on, -1 = none
+    int8_t last;                        // brew they were on before
+    uint32_t act_started;
+    uint32_t started;
+    uint32_t ended;
+    const char* refused;                // why the last hold Down queued nothing
+} AppService;
+
+// ============================================================
+// Telemetry: brew state records over USB CDC, sent when the state
+// changes. Frame: TELEMETRY_SYNC, payload length, payload, CRC-8
+// (poly 0x07) over length and payload. Payload: version, sequence,
+// then the TelemetryState fields in order, u16 little-endian.
+// ============================================================
+#define TELEMETRY_CDC_IF      1     // 0 stays the CLI
+#define TELEMETRY_SYNC        0xA5
+#define TELEMETRY_VERSION     1
+#define TELEMETRY_PAYLOAD_LEN 15
+#define TELEMETRY_FRAME_LEN   (TELEMETRY_PAYLOAD_LEN + 3)
+#define TELEMETRY_STALL_MS    500   // an unacked transfer counts as a stall
+
+#define TELEMETRY_F_BREWING  (1 << 0)
+#define TELEMETRY_F_PAUSED   (1 << 1)
+#define TELEMETRY_F_STEP_DUE (1 << 2)   // timed step ran out
+#define TELEMETRY_F_COMPLETE (1 << 3)
+#define TELEMETRY_F_CUSTOM   (1 << 4)
+
+typedef struct {
+    uint8_t flags;
+    uint8_t method;
+    uint8_t recipe;
+    uint8_t step;           // brew step, 0-based
+    uint8_t step_count;
+    uint16_t step_sec;      // 0 = manual step
+    uint16_t remaining_sec; // at send time; the receiver counts down
+    uint16_t total_sec;
+    uint16_t water_ml;      // poured before this step
+} TelemetryState;
+
+typedef struct {
+    bool active;
+    FuriHalUsbInterface* prev_usb;
+    volatile bool tx_busy;  // cleared by the CDC transfer-done callback
+    uint32_t tx_tick;
+    bool tx_stalled;        // this transfer is already counted in stalls
+    uint8_t seq;
+    bool pending;           // a change waits for the endpoint
+    TelemetryState last;
+    bool have_last;
+    uint32_t frames;
+    uint32_t stalls;        // transfers left unread past TELEMETRY_STALL_MS
+} AppTelemetry;
+
+// ============================================================
+// Scale input: weight lines from a UART scale, or replayed from
+// scale.trace, pass through one ring to the main loop. Trace
+// lines are "<ms since tare> <grams>"; brews weighed on the UART
+// are recorded in that form.
+// ============================================================
+#define SENSOR_BAUD       9600
+#define SENSOR_RING_SIZE  256       // power of two; ~250 ms of 9600 baud
+#define SENSOR_LINE_MAX   32
+#define SENSOR_FLOW_MS    1000      // flow window
+#define SENSOR_STALE_MS   2000      // no reading for this long: scale gone
+#define SENSOR_LEAD_MS    400       // filter delay, made up for at a target
+#define SENSOR_TRACE_MAX  16384     // about 2 min of pouring at 10 Hz
+
+typedef enum {
+    SensorOff,
+    SensorUart,
+    SensorTrace,
+    SensorSourceCount,
+} SensorSource;
+
+// One producer (UART interrupt or trace player), one consumer (main
+// loop); each side only writes its own index
+typedef struct {
+    uint8_t buf[SENSOR_RING_SIZE];
+    uint32_t head;
+    uint32_t tail;
+    uint32_t dropped;               // bytes that found the ring full
+} SensorRing;
+
+typedef struct {
+    SensorSource source;
+    SensorRing ring;
+    FuriHalSerialHandle* serial;
+    char line[SENSOR_LINE_MAX];
+    uint8_t line_len;
+    bool overlong;                  // drop the rest of this line
+    int32_t raw[3];                 // last readings, 0.1 g, for the median
+    uint8_t raw_count;              // 0 until a reading since the tare
+    uint8_t raw_next;
+    int32_t weight;                 // filtered, 0.1 g
+    int32_t tare;
+    bool tare_pending;              // the next reading is the tare
+    int32_t flow_ref;               // weight at flow_tick
+    uint32_t flow_tick;
+    int32_t flow;                   // 0.1 g/s
+    uint32_t last_tick;             // of the last reading
+    uint32_t readings;
+    uint32_t bad_lines;
+    uint8_t step;                   // brew step the target below is for
+    bool below;                     // weight was under it during the step
+    uint32_t tare_tick;             // trace times count from here
+    char* trace;                    // Trace: file, NUL-terminated
+    size_t trace_len;
+    size_t trace_pos;
+    bool trace_loading;             // the storage worker owns trace
+    bool playing;
+    char* rec;                      // Uart: this brew's trace so far
+    uint16_t rec_len;
+    int32_t rec_last;               // last reading recorded
+    uint32_t rec_tick;
+} AppSensor;
+
+// ============================================================
+// App data store: one append-only log of keyed records. A write
+// appends a record and the last one for a key wins; an empty one
+// removes the key. One scan at startup rebuilds the index, and the
+// log is rewritten with only the live records once most of it is
+// dead. The storage worker owns it.
+// ============================================================
+#define STORE_MAGIC 0xC7
+#define STORE_KEYS_MAX 64
+#define STORE_VALUE_MAX BREW_FILE_MAX
+#define STORE_COMPACT_MIN 8192  // log bytes before compaction is considered
+#define STORE_READ_CHUNK 256
+
+enum {
+    StoreKeySettings = 0x0001,
+    StoreKeyRecipe = 0x0100,        // + slot: .brew text
+    StoreKeyRecipeFile = 0x0200,    // + slot: CustomFileRecord
+    StoreKeyBrewLog = 0x0300,       // + seq % STATS_LOG_SIZE: BrewLogEntry
+    StoreKeyStats = 0x0400,         // + slot (< STATS_SLOTS): RecipeStats
+};
+
+typedef struct {
+    uint8_t magic;
+    uint8_t crc;                    // over key, len and value
+    uint16_t key;
+    uint16_t len;                   // 0: key removed
+} StoreHeader;
+
+typedef struct {
+    uint16_t key;
+    uint16_t len;
+    uint32_t at;                    // value's offset in the log
+} StoreEntry;
+
+typedef struct {
+    StoreEntry entry[STORE_KEYS_MAX];   // live keys, unordered
+    uint8_t count;
+    uint32_t size;                  // log bytes up to the last good record
+    uint32_t live;                  // of them, the live records'
+    bool open;                      // scanned; writes refused until then
+    uint32_t brew_seq;              // brew log: last seq, once brew_seq_read
+    bool brew_seq_read;
+    uint16_t stats_key[STATS_SLOTS];    // stats: each slot's recipe, once stats_read
+    uint32_t stats_n[STATS_SLOTS];      // and its samples, for eviction
+    bool stats_read;
+} AppStore;
+
+// ============================================================
+// Storage worker requests and completions
+// ============================================================
+typedef enum {
+    StorageOpLoadSettings,
+    StorageOpLoadCustom,
+    StorageOpSaveSettings,
+    StorageOpSaveRecipe,
+    StorageOpRemoveRecipe,
+    StorageOpDumpMetrics,
+    StorageOpSaveTrace,
+    StorageOpLoadTrace,
+    StorageOpLoadStats,
+    StorageOpSaveStats,
+    StorageOpSaveScaleTrace,
+    StorageOpLoadScaleTrace,
+    StorageOpSyncCustom,
+    StorageOpExportCustom,
+    StorageOpLogBrew,
+    StorageOpStop,
+} StorageOp;
+
+typedef struct {
+    StorageOp op;
+    Settings settings;              // SaveSettings: snapshot
+    CustomRecipe* recipe;           // SaveRecipe: heap snapshot, freed by the worker
+    uint8_t slot;                   // Save/RemoveRecipe
+    bool exported;                  // SaveRecipe: the snapshot is its file's contents
+    BrewLogEntry brew;              // LogBrew
+    uint8_t* data;                  // Save*Trace/SaveStats, SyncCustom (CustomFileRef[]),
+                                    // DumpMetrics: heap buffer, freed by the worker
+    uint16_t len;
+    uint16_t key;                   // LoadStats
+} StorageRequest;
+
+typedef struct {
+    StorageOp op;
+    bool ok;
+    uint8_t count;                  // LoadCustom: recipes parsed into custom[]
+    uint32_t duration_ms;
+    Settings* settings;             // LoadSettings: heap copy, freed by main
+    RecipeStats* stats;             // LoadStats: heap record or NULL, freed by main
+    CustomSync* sync;               // SyncCustom: changes or NULL, freed by main
+} StorageResult;
+
+// ============================================================
+// Main queue events
+// ============================================================
+typedef enum {
+    AppEventInput,
+    AppEventStorage,
+    AppEventReplay,                 // recorded input, fed back by the replay thread
+    AppEventReplayDone,
+    AppEventDeadline,               // the running step's time is up
+} AppEventType;
+
+// Events carry their post time so queue latency can be measured
+typedef struct {
+    AppEventType type;
+    uint32_t tick;
+    union {
+        InputEvent input;
+        StorageResult storage;
+    };
+} AppEvent;
+
 // ============================================================
 // App state
 // ============================================================
@@ -166,15 +708,19 @@ typedef struct {
     uint8_t method_sel;
     uint8_t recipe_sel;
     uint8_t cur_method;
-    uint8_t cur_recipe;
+    uint8_t cur_recipe;     // custom[] slot when using_custom
     uint8_t cur_step;
     int8_t ratio_adjust;
+    uint8_t batch;          // 1..MAX_BATCH brews' worth
     Screen screen;
     TimerState timer_state;
     bool step_complete;
     bool running;
     bool show_upcoming;
     bool using_custom;
+    uint32_t step_started;  // tick the current step began
+    uint32_t step_paused_ms;    // of the time since, spent paused
+    uint32_t clock_tick;    // tick brew time was last counted up to
 } AppState;
 
 // ============================================================
@@ -182,16 +728,41 @@ typedef struct {
 // ============================================================
 typedef struct {
     AppState s;
+    BrewScale scale;
     Settings settings;
     EditorState editor;
-    CustomRecipe custom[MAX_CUSTOM_RECIPES];
+    CustomRecipe custom[MAX_CUSTOM_RECIPES];    // slots, addressed by handle
+    uint8_t custom_order[MAX_CUSTOM_RECIPES];   // list position -> slot
     uint8_t custom_count;
+    bool custom_loaded;             // set when the worker's load completes
+    bool custom_syncing;            // a change scan is out
     FuriMutex* mutex;
     FuriMessageQueue* queue;
     ViewPort* view_port;
     Gui* gui;
     FuriTimer* timer;
+    FuriTimer* deadline;            // one-shot, on the running step's end
+    uint32_t deadline_at;           // tick it is set for, 0 = stopped
     NotificationApp* notif;
+    FuriThread* notify_thread;
+    FuriMessageQueue* notify_queue;
+    Storage* storage;
+    FuriThread* storage_thread;
+    FuriMessageQueue* storage_queue;
+    AppStore store;                 // storage worker's
+    bool settings_loaded;           // the worker's LoadSettings came back
+    bool settings_dirty;            // a save waits for storage queue room
+    bool storage_closing;           // app_free: requests wait their turn
+    AppMetrics metrics;
+    AppTrace trace;
+    AppPower power;
+    AppTelemetry telemetry;
+    AppSensor sensor;
+    AppStats stats;
+    AppService service;
+    ListIndex list_index;
+    const EditorPlugin* editor_api; // set while the editor plugin is loaded
+    void* editor_plugin;            // PluginManager that holds it
 } CoffeeApp;
 
 // ============================================================
@@ -199,33 +770,242 @@ typedef struct {
 // ============================================================
 extern const BrewMethod methods[];
 extern const uint8_t method_count;
+extern const char recipe_strings[];
+extern const StepTypeInfo step_types[StepTypeCount];
 
 // ============================================================
 // Inline helpers
 // ============================================================
+static inline const char* rstr(uint16_t id) {
+    return &recipe_strings[id];
+}
+static inline const char* step_type_token(StepType t) {
+    return t < StepTypeCount ? rstr(step_types[t].token) : "?";
+}
+static inline const char* step_type_name(StepType t) {
+    return t < StepTypeCount ? rstr(step_types[t].name) : "?";
+}
 static inline uint16_t step_water_ml(const BrewStep* st) {
     return (uint16_t)st->water_ml_div10 * 10;
 }
 static inline uint16_t custom_step_water_ml(const CustomStep* st) {
     return (uint16_t)st->water_ml_div10 * 10;
 }
+// Custom recipe at list position pos
+static inline CustomRecipe* custom_at(CoffeeApp* app, uint8_t pos) {
+    return &app->custom[app->custom_order[pos]];
+}
+static inline bool screen_is_editor(Screen s) {
+    return s >= ScreenEditMenu && s <= ScreenConfirmDelete;
+}
 
 // ============================================================
 // Settings (settings.c)
 // ============================================================
-void settings_load(CoffeeApp* app);
+void settings_defaults(Settings* set);
+Settings* settings_load(Storage* storage, AppStore* store);
 void settings_save(CoffeeApp* app);
+void settings_flush(CoffeeApp* app);
+bool settings_write(Storage* storage, AppStore* store, const Settings* set);
 bool settings_is_favourite(Settings* set, uint8_t method, uint8_t recipe);
 void settings_toggle_favourite(Settings* set, uint8_t method, uint8_t recipe);
-uint8_t adjusted_coffee(uint8_t base, int8_t adj);
-uint16_t adjusted_water(uint16_t base_ml, uint8_t base_coffee, int8_t adj);
+uint32_t dose_scale_q16(uint8_t base_coffee, int8_t adj, uint8_t batch);
+uint16_t dose_scale(uint16_t base, uint32_t factor_q16);
+void dose_scale_text(const char* src, uint32_t factor_q16, char* dst, size_t n);
+
+// ============================================================
+// Display power (power.c)
+// ============================================================
+void power_update(CoffeeApp* app, StepType type, uint16_t dur_sec);
+void power_wake(CoffeeApp* app);
+bool power_frame_due(CoffeeApp* app);
+void power_release(CoffeeApp* app);
+
+// ============================================================
+// Step timing statistics (stats.c)
+// ============================================================
+uint16_t stats_key(bool custom, uint8_t method, uint8_t recipe, const char* name);
+void stats_begin(CoffeeApp* app, uint16_t key);
+void stats_add(RecipeStats* rs, uint8_t row, uint32_t ms);
+void stats_loaded(CoffeeApp* app, RecipeStats* loaded);
+void stats_flush(CoffeeApp* app);
+float stats_variance(const StepStat* st);
+RecipeStats* stats_load(Storage* storage, AppStore* store, uint16_t key);
+bool stats_write(Storage* storage, AppStore* store, const RecipeStats* rs);
+void stats_log_brew(CoffeeApp* app);
+bool stats_log_write(Storage* storage, AppStore* store, BrewLogEntry* e);
+
+// ============================================================
+// Service mode (service.c)
+// ============================================================
+void service_plan(AppService* sv);
+void service_start(AppService* sv, uint32_t now);
+int8_t service_next(const AppService* sv, uint32_t now, uint32_t* wait_ms);
+uint32_t service_eta(const AppService* sv, uint32_t now);
+void service_step_done(AppService* sv, uint32_t now);
+bool service_wait_over(AppService* sv, uint32_t now);
+bool service_finished(const AppService* sv, uint32_t now);
+uint8_t service_drinks(const AppService* sv);
+void service_remove(AppService* sv, uint8_t idx);
+void service_forget_custom(AppService* sv, uint8_t slot);
+
+// ============================================================
+// Telemetry (telemetry.c)
+// ============================================================
+bool telemetry_start(CoffeeApp* app);
+void telemetry_stop(CoffeeApp* app);
+void telemetry_update(CoffeeApp* app, const TelemetryState* st);
+size_t telemetry_encode(const TelemetryState* st, uint8_t seq, uint8_t* frame);
+bool telemetry_parse(const uint8_t* frame, size_t len, TelemetryState* st, uint8_t* seq);
+
+// ============================================================
+// Scale input (sensor.c)
+// ============================================================
+bool sensor_start(CoffeeApp* app, SensorSource source);
+void sensor_stop(CoffeeApp* app);
+void sensor_poll(CoffeeApp* app, bool brewing);
+void sensor_tare(CoffeeApp* app);
+bool sensor_live(const AppSensor* s, uint32_t now);
+int32_t sensor_poured(const AppSensor* s);
+bool sensor_parse(const char* line, int32_t* dg);
+const char* sensor_source_name(SensorSource source);
+void sensor_trace_loaded(CoffeeApp* app, bool ok);
+bool sensor_trace_load(CoffeeApp* app);
+bool sensor_trace_write(Storage* storage, const uint8_t* data, uint16_t len);
 
 // ============================================================
 // Custom recipes (custom.c)
 // ============================================================
-void custom_recipes_load(CoffeeApp* app);
-bool custom_recipe_save(CoffeeApp* app, uint8_t idx);
-bool custom_recipe_delete(CoffeeApp* app, uint8_t idx);
+// Parser findings, for tools that check .brew files; line 0 is the
+// file as a whole
+typedef enum {
+    BrewDiagWarning,
+    BrewDiagError,
+} BrewDiagLevel;
+
+typedef struct {
+    void (*fn)(void* ctx, uint16_t line, BrewDiagLevel level, const char* msg);
+    void* ctx;
+} BrewDiag;
+
+uint8_t custom_recipes_load(CoffeeApp* app);
+bool custom_recipe_parse(char* buf, CustomRecipe* cr, const BrewDiag* diag);
+int8_t custom_recipe_new(CoffeeApp* app);
+bool custom_recipe_save(CoffeeApp* app, uint8_t slot);
+bool custom_recipe_delete(CoffeeApp* app, uint8_t slot);
+bool custom_recipe_store(
+    Storage* storage, AppStore* store, uint8_t slot, const CustomRecipe* cr, bool exported);
+bool custom_recipe_remove(Storage* storage, AppStore* store, uint8_t slot);
+bool custom_recipes_export(Storage* storage, AppStore* store);
 void custom_recipe_init_new(CustomRecipe* cr);
-const char* step_type_name(StepType t);
 void step_auto_detail(CustomStep* st);
+uint8_t custom_block_len(const CustomRecipe* cr, uint8_t row);
+void custom_recipes_sync(CoffeeApp* app);
+CustomSync* custom_recipes_scan(
+    Storage* storage, AppStore* store, const CustomFileRef* known, uint8_t count);
+void custom_sync_apply(CoffeeApp* app, CustomSync* sync);
+
+// ============================================================
+// Recipe editor plugin (editor.c, editor_loader.c)
+// ============================================================
+#define EDITOR_PLUGIN_APP_ID "coffee_timer_editor"
+#define EDITOR_PLUGIN_API_VERSION 3
+#define EDITOR_PLUGIN_PATH APP_ASSETS_PATH("plugins/coffee_timer_editor.fal")
+
+// What the editor needs from the app. A plugin resolves only firmware
+// symbols, so app code and data reach it through this table.
+typedef struct {
+    int8_t (*recipe_new)(CoffeeApp* app);
+    bool (*recipe_save)(CoffeeApp* app, uint8_t slot);
+    void (*recipe_delete)(CoffeeApp* app, uint8_t slot);
+    void (*step_auto_detail)(CustomStep* st);
+    uint8_t (*block_len)(const CustomRecipe* cr, uint8_t row);
+    const char* (*step_type_name)(StepType t);
+    const char* const* grind_names;
+    void (*confirm_box)(Canvas* c, const char* msg);
+} EditorHost;
+
+struct EditorPlugin {
+    void (*bind)(const EditorHost* host);
+    void (*draw)(Canvas* c, CoffeeApp* app);
+    void (*input)(CoffeeApp* app, InputEvent* ev);  // every event type
+};
+
+bool editor_load(CoffeeApp* app, const EditorHost* host);
+void editor_unload(CoffeeApp* app);
+
+// ============================================================
+// Arena allocator (arena.c)
+// ============================================================
+bool arena_init(Arena* a, size_t size);
+void* arena_alloc(Arena* a, size_t n);
+void arena_rewind(Arena* a, size_t mark);
+void arena_release(Arena* a);
+
+// ============================================================
+// Scrolling lists (list.c)
+// ============================================================
+// A list is a row count and callbacks that format one row on demand
+typedef void (*ListRowFn)(CoffeeApp* app, uint8_t idx, char* buf, size_t n);
+typedef const char* (*ListNameFn)(CoffeeApp* app, uint8_t idx);
+
+typedef struct {
+    uint8_t count;
+    ListRowFn row;
+    ListNameFn name;            // sort key; NULL: no letter jumps
+} ListSource;
+
+void list_draw(Canvas* c, CoffeeApp* app, const ListSource* src, uint8_t sel, uint8_t x);
+bool list_nav(const ListSource* src, const InputEvent* ev, uint8_t* sel);
+bool list_jump(CoffeeApp* app, const ListSource* src, uint16_t key, uint8_t* sel);
+void list_index_invalidate(CoffeeApp* app);
+
+// ============================================================
+// Notifications (notify.c)
+// ============================================================
+void notify_start(CoffeeApp* app);
+void notify_stop(CoffeeApp* app);
+void notify_post(CoffeeApp* app, NotifyEvent ev);
+
+// ============================================================
+// Metrics (metrics.c)
+// ============================================================
+uint32_t metrics_cycles(void);
+uint32_t metrics_us_since(uint32_t start);
+void metrics_record(MetricTiming* t, uint32_t v);
+void metrics_sample(CoffeeApp* app);
+void metrics_reset(CoffeeApp* app);
+uint8_t metrics_line_count(CoffeeApp* app);
+void metrics_format_line(CoffeeApp* app, uint8_t idx, char* buf, size_t n);
+void metrics_dump(CoffeeApp* app);
+bool metrics_write(Storage* storage, const uint8_t* data, uint16_t len);
+const char* metrics_screen_name(Screen screen);
+
+// ============================================================
+// Input trace (trace.c)
+// ============================================================
+bool trace_decode(const uint8_t* rec, uint32_t* dt, InputEvent* ev);
+bool trace_check_header(const uint8_t* buf, size_t len, bool* auto_advance);
+void trace_record_start(CoffeeApp* app);
+void trace_record_stop(CoffeeApp* app);
+void trace_record(CoffeeApp* app, const InputEvent* ev, uint32_t tick);
+bool trace_write(Storage* storage, const uint8_t* data, uint16_t len);
+bool trace_load(CoffeeApp* app);
+void trace_replay_start(CoffeeApp* app);
+void trace_replay_stop(CoffeeApp* app);
+void trace_shutdown(CoffeeApp* app);
+
+// ============================================================
+// App data store (store.c)
+// ============================================================
+bool store_open(Storage* storage, AppStore* st);
+uint16_t store_get(Storage* storage, AppStore* st, uint16_t key, void* buf, uint16_t cap);
+bool store_put(Storage* storage, AppStore* st, uint16_t key, const void* value, uint16_t len);
+bool store_compact(Storage* storage, AppStore* st);
+
+// ============================================================
+// Storage worker (storage_worker.c)
+// ============================================================
+void storage_worker_start(CoffeeApp* app);
+void storage_worker_stop(CoffeeApp* app);
+bool storage_post(CoffeeApp* app, const StorageRequest* req);
@@ -1,4 +1,5 @@
 #include "coffee_timer.h"
+#include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -18,23 +19,11 @@ const char* grind_names[GRIND_COUNT] = {
     "Extra Fine", "Fine", "Medium-Fine", "Medium", "Med-Coarse", "Coarse"
 };
 
-const char* step_type_name(StepType t) {
-    switch(t) {
-    case StepAdd:   return "Add";
-    case StepStir:  return "Stir";
-    case StepWait:  return "Wait";
-    case StepPress: return "Press";
-    case StepFlip:  return "Flip";
-    case StepPrep:  return "Prep";
-    case StepPour:  return "Pour";
-    case StepSwirl: return "Swirl";
-    default:        return "?";
-    }
-}
-
 void step_auto_detail(CustomStep* st) {
     uint16_t wml = custom_step_water_ml(st);
-    if(st->weight_grams > 0 && wml > 0)
+    if(st->type == StepRepeat)
+        snprintf(st->detail, DETAIL_LEN, "%d steps x%d", st->weight_grams, st->duration_sec);
+    else if(st->weight_grams > 0 && wml > 0)
         snprintf(st->detail, DETAIL_LEN, "%dg, %dml", st->weight_grams, wml);
     else if(st->weight_grams > 0)
         snprintf(st->detail, DETAIL_LEN, "%dg", st->weight_grams);
@@ -58,52 +47,100 @@ void custom_recipe_init_new(CustomRecipe* cr) {
     cr->filename[0] = 0;
 }
 
+// Rows a repeat row actually covers: stops at the end or at another repeat
+uint8_t custom_block_len(const CustomRecipe* cr, uint8_t row) {
+    uint8_t n = 0;
+    while(n < cr->steps[row].weight_grams && row + 1 + n < cr->step_count &&
+          cr->steps[row + 1 + n].type != StepRepeat)
+        n++;
+    return n;
+}
+
 // ============================================================
-// Parse step type from string
+// Parse step type from string; StepTypeCount if unknown
 // ============================================================
 static StepType parse_step_type(const char* s) {
-    if(ci_cmp(s, "ADD") == 0) return StepAdd;
-    if(ci_cmp(s, "STIR") == 0) return StepStir;
-    if(ci_cmp(s, "WAIT") == 0) return StepWait;
-    if(ci_cmp(s, "PRESS") == 0) return StepPress;
-    if(ci_cmp(s, "FLIP") == 0) return StepFlip;
-    if(ci_cmp(s, "PREP") == 0) return StepPrep;
-    if(ci_cmp(s, "POUR") == 0) return StepPour;
-    if(ci_cmp(s, "SWIRL") == 0) return StepSwirl;
-    return StepPrep;
+    for(uint8_t t = 0; t < StepTypeCount; t++)
+        if(ci_cmp(s, step_type_token((StepType)t)) == 0) return (StepType)t;
+    return StepTypeCount;
+}
+
+// Optional 7th step field; none follows the step type
+static const char* const advance_tokens[AdvanceCount] = {"", "chain", "arm", "confirm"};
+
+static StepAdvance parse_advance(const char* s) {
+    for(uint8_t a = AdvanceChain; a < AdvanceCount; a++)
+        if(ci_cmp(s, advance_tokens[a]) == 0) return (StepAdvance)a;
+    return AdvanceCount;
 }
 
 // ============================================================
-// Parse a single .brew file into a CustomRecipe
+// Diagnostics: with a BrewDiag the parser reports each line it
+// reads differently from how it was probably meant. The app
+// passes none; tools/brew_lint does.
 // ============================================================
-static bool parse_brew_file(Storage* storage, const char* path, CustomRecipe* cr) {
-    memset(cr, 0, sizeof(CustomRecipe));
+static void report(const BrewDiag* d, uint16_t line, BrewDiagLevel level, const char* fmt, ...) {
+    if(!d) return;
+    char msg[96];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(msg, sizeof(msg), fmt, ap);
+    va_end(ap);
+    d->fn(d->ctx, line, level, msg);
+}
 
-    File* file = storage_file_alloc(storage);
-    if(!storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
-        storage_file_close(file);
-        storage_file_free(file);
-        return false;
-    }
+// Numbers are read with atoi, as they always were; an empty field is 0
+static int read_num(const char* s, long max, const BrewDiag* d, uint16_t line, const char* what) {
+    int v = atoi(s);
+    if(!d || *s == 0) return v;
+    char* end;
+    long x = strtol(s, &end, 10);
+    if(end == s || *end)
+        report(d, line, BrewDiagWarning, "%s \"%s\" is not a number, read as %d", what, s, v);
+    else if(x < 0 || x > max)
+        report(d, line, BrewDiagWarning, "%s %ld is outside 0..%ld", what, x, max);
+    return v;
+}
 
-    // Heap-allocate read buffer to avoid stack overflow
-    const uint16_t buf_size = 1024;
-    char* buf = malloc(buf_size);
-    if(!buf) {
-        storage_file_close(file);
-        storage_file_free(file);
-        return false;
+static void read_str(
+    char* dst, size_t n, const char* s, const BrewDiag* d, uint16_t line, const char* what) {
+    strncpy(dst, s, n - 1);
+    dst[n - 1] = 0;
+    if(strlen(s) >= n)
+        report(d, line, BrewDiagWarning, "%s is cut to %u characters: \"%s\"",
+            what, (unsigned)(n - 1), dst);
+}
+
+// Water the steps pour, with repeat blocks run their number of times
+static uint32_t steps_water_ml(const CustomRecipe* cr) {
+    uint32_t total = 0;
+    for(uint8_t r = 0; r < cr->step_count; r++) {
+        if(cr->steps[r].type != StepRepeat) {
+            total += custom_step_water_ml(&cr->steps[r]);
+            continue;
+        }
+        uint8_t len = custom_block_len(cr, r);
+        for(uint8_t k = r + 1; k <= r + len; k++)
+            total += (uint32_t)cr->steps[r].duration_sec * custom_step_water_ml(&cr->steps[k]);
+        r += len;
     }
+    return total;
+}
 
-    uint16_t read = storage_file_read(file, buf, (uint16_t)(buf_size - 1));
-    buf[read] = 0;
-    storage_file_close(file);
-    storage_file_free(file);
+// ============================================================
+// Parse .brew text (NUL-terminated, split in place) into a
+// CustomRecipe; true if it has a name and steps
+// ============================================================
+bool custom_recipe_parse(char* buf, CustomRecipe* cr, const BrewDiag* diag) {
+    memset(cr, 0, sizeof(CustomRecipe));
 
     bool in_steps = false;
+    int8_t open_block = -1;     // row of the REPEAT waiting for its END
+    uint16_t line_no = 0, water_line = 0, dropped = 0;
     char* line = buf;
 
     while(line && *line) {
+        line_no++;
         // Find end of line
         char* nl = strchr(line, '\n');
         if(nl) *nl = 0;
@@ -129,22 +166,34 @@ static bool parse_brew_file(Storage* storage, const char* path, CustomRecipe* cr
             if(eq) {
                 *eq = 0;
                 char* val = eq + 1;
-                if(ci_cmp(line, "name") == 0) {
-                    strncpy(cr->name, val, NAME_LEN - 1);
-                    cr->name[NAME_LEN - 1] = 0;
-                } else if(ci_cmp(line, "grind") == 0) {
-                    strncpy(cr->grind, val, sizeof(cr->grind) - 1);
-                    cr->grind[sizeof(cr->grind) - 1] = 0;
-                } else if(ci_cmp(line, "coffee") == 0)
-                    cr->coffee_grams = (uint8_t)atoi(val);
-                else if(ci_cmp(line, "water") == 0)
-                    cr->water_ml = (uint16_t)atoi(val);
-                else if(ci_cmp(line, "temp") == 0)
-                    cr->water_temp_c = (uint16_t)atoi(val);
+                if(ci_cmp(line, "name") == 0)
+                    read_str(cr->name, NAME_LEN, val, diag, line_no, "name");
+                else if(ci_cmp(line, "grind") == 0)
+                    read_str(cr->grind, sizeof(cr->grind), val, diag, line_no, "grind");
+                else if(ci_cmp(line, "coffee") == 0)
+                    cr->coffee_grams = (uint8_t)read_num(val, UINT8_MAX, diag, line_no, "coffee");
+                else if(ci_cmp(line, "water") == 0) {
+                    cr->water_ml = (uint16_t)read_num(val, UINT16_MAX, diag, line_no, "water");
+                    water_line = line_no;
+                } else if(ci_cmp(line, "temp") == 0)
+                    cr->water_temp_c = (uint16_t)read_num(val, UINT16_MAX, diag, line_no, "temp");
+                else
+                    report(diag, line_no, BrewDiagWarning, "unknown header key \"%s\" ignored", line);
+            } else {
+                report(diag, line_no, BrewDiagWarning, "header line without '=' ignored");
             }
+        } else if(ci_cmp(line, "END") == 0) {
+            if(open_block >= 0)
+                cr->steps[open_block].weight_grams = (uint8_t)(cr->step_count - open_block - 1);
+            else
+                report(diag, line_no, BrewDiagWarning, "END without an open REPEAT");
+            open_block = -1;
         } else {
-            // Parse step: TYPE|instruction|detail|duration|weight|water_ml
+            // Parse step: TYPE|instruction|detail|duration|weight|water_ml[|advance]
+            // or REPEAT|times, closed by END after the block's rows
             if(cr->step_count >= MAX_STEPS) {
+                if(dropped++ == 0)
+                    report(diag, line_no, BrewDiagError, "steps past the %dth are dropped", MAX_STEPS);
                 line = nl ? nl + 1 : NULL;
                 continue;
             }
@@ -154,178 +203,603 @@ static bool parse_brew_file(Storage* storage, const char* path, CustomRecipe* cr
             char* pipe;
             int field = 0;
 
-            while(tok && field < 6) {
+            while(tok && field < 7) {
                 pipe = strchr(tok, '|');
                 if(pipe) *pipe = 0;
 
                 switch(field) {
-                case 0: st->type = parse_step_type(tok); break;
+                case 0:
+                    st->type = parse_step_type(tok);
+                    if(st->type == StepTypeCount) {
+                        report(diag, line_no, BrewDiagError, "unknown step type \"%s\" becomes %s",
+                            tok, step_type_token(StepPrep));
+                        st->type = StepPrep;
+                    }
+                    break;
                 case 1:
-                    strncpy(st->instruction, tok, NAME_LEN - 1);
-                    st->instruction[NAME_LEN - 1] = 0;
+                    read_str(st->instruction, NAME_LEN, tok, diag, line_no, "instruction");
                     break;
                 case 2:
-                    strncpy(st->detail, tok, DETAIL_LEN - 1);
-                    st->detail[DETAIL_LEN - 1] = 0;
+                    read_str(st->detail, DETAIL_LEN, tok, diag, line_no, "detail");
+                    break;
+                case 3:
+                    st->duration_sec = (uint16_t)read_num(tok, UINT16_MAX, diag, line_no, "duration");
+                    break;
+                case 4:
+                    st->weight_grams = (uint8_t)read_num(tok, UINT8_MAX, diag, line_no, "weight");
                     break;
-                case 3: st->duration_sec = (uint16_t)atoi(tok); break;
-                case 4: st->weight_grams = (uint8_t)atoi(tok); break;
                 case 5: {
-                    int ml = atoi(tok);
+                    int ml = read_num(tok, UINT8_MAX * 10, diag, line_no, "water");
+                    if(ml % 10 != 0)
+                        report(diag, line_no, BrewDiagWarning,
+                            "water %d is kept in 10 ml units, read as %d", ml, ml / 10 * 10);
                     st->water_ml_div10 = (uint8_t)(ml / 10);
                     break;
                 }
+                case 6: {
+                    StepAdvance adv = parse_advance(tok);
+                    if(adv == AdvanceCount)
+                        report(diag, line_no, BrewDiagWarning,
+                            "unknown advance \"%s\", the step type's is used", tok);
+                    else
+                        st->advance = (uint8_t)adv;
+                    break;
+                }
                 }
 
                 tok = pipe ? pipe + 1 : NULL;
                 field++;
             }
-
+            if(tok && st->type != StepRepeat)
+                report(diag, line_no, BrewDiagWarning, "fields after the 7th are ignored");
+
+            if(st->type == StepRepeat) {
+                // Blocks don't nest: a new REPEAT closes the open one
+                if(open_block >= 0)
+                    cr->steps[open_block].weight_grams = (uint8_t)(cr->step_count - open_block - 1);
+                int times = atoi(st->instruction);
+                if(times < MIN_REPEAT || times > MAX_REPEAT)
+                    report(diag, line_no, BrewDiagWarning, "REPEAT %d is held to %d..%d",
+                        times, MIN_REPEAT, MAX_REPEAT);
+                if(times < MIN_REPEAT) times = MIN_REPEAT;
+                if(times > MAX_REPEAT) times = MAX_REPEAT;
+                st->duration_sec = (uint16_t)times;
+                st->weight_grams = 0;
+                st->water_ml_div10 = 0;
+                st->advance = AdvanceDefault;
+                snprintf(st->instruction, NAME_LEN, "%s", step_type_name(StepRepeat));
+                open_block = (int8_t)cr->step_count;
+            }
             cr->step_count++;
         }
 
         line = nl ? nl + 1 : NULL;
     }
 
+    // An unterminated block runs to the last row
+    if(open_block >= 0)
+        cr->steps[open_block].weight_grams = (uint8_t)(cr->step_count - open_block - 1);
+    for(uint8_t i = 0; i < cr->step_count; i++)
+        if(cr->steps[i].type == StepRepeat) step_auto_detail(&cr->steps[i]);
+
     cr->loaded = (cr->step_count > 0 && cr->name[0] != 0);
-    free(buf);
+    if(diag) {
+        if(dropped > 0)
+            report(diag, line_no, BrewDiagError, "%u step lines dropped in all", dropped);
+        if(cr->name[0] == 0) report(diag, 0, BrewDiagError, "no name: the app skips this file");
+        if(cr->step_count == 0) report(diag, 0, BrewDiagError, "no steps: the app skips this file");
+        uint32_t poured = steps_water_ml(cr);
+        if(water_line > 0 && poured > 0 && poured != cr->water_ml)
+            report(diag, water_line, BrewDiagWarning, "water=%u but the steps pour %lu ml",
+                cr->water_ml, (unsigned long)poured);
+    }
     return cr->loaded;
 }
 
-// ============================================================
-// Load all .brew files from custom dir
-// ============================================================
-void custom_recipes_load(CoffeeApp* app) {
-    app->custom_count = 0;
-
-    Storage* storage = furi_record_open(RECORD_STORAGE);
-    storage_simply_mkdir(storage, CUSTOM_DIR);
+// Read a .brew file into a buffer from the caller's arena and parse it
+static bool parse_brew_file(
+    Storage* storage, const char* path, CustomRecipe* cr, Arena* arena, const BrewDiag* diag) {
+    // Off the worker's stack, and no heap churn per file
+    char* buf = arena_alloc(arena, BREW_FILE_MAX);
+    if(!buf) return false;
 
-    File* dir = storage_file_alloc(storage);
-    if(!storage_dir_open(dir, CUSTOM_DIR)) {
-        storage_dir_close(dir);
-        storage_file_free(dir);
-        furi_record_close(RECORD_STORAGE);
-        return;
+    File* file = storage_file_alloc(storage);
+    if(!storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        storage_file_close(file);
+        storage_file_free(file);
+        return false;
     }
 
-    FileInfo info;
-    char name[64];
-
-    while(app->custom_count < MAX_CUSTOM_RECIPES &&
-          storage_dir_read(dir, &info, name, (uint16_t)sizeof(name))) {
-        // Check for .brew extension
-        size_t nlen = strlen(name);
-        if(nlen < 6) continue;
-        if(ci_cmp(name + nlen - 5, ".brew") != 0) continue;
-
-        char path[128];
-        snprintf(path, sizeof(path), "%s/%s", CUSTOM_DIR, name);
-
-        CustomRecipe* cr = &app->custom[app->custom_count];
-        if(parse_brew_file(storage, path, cr)) {
-            strncpy(cr->filename, name, sizeof(cr->filename) - 1);
-            cr->filename[sizeof(cr->filename) - 1] = 0;
-            app->custom_count++;
-        }
-    }
+    uint16_t read = storage_file_read(file, buf, (uint16_t)(BREW_FILE_MAX - 1));
+    buf[read] = 0;
+    storage_file_close(file);
+    storage_file_free(file);
+    return custom_recipe_parse(buf, cr, diag);
+}
 
-    storage_dir_close(dir);
-    storage_file_free(dir);
-    furi_record_close(RECORD_STORAGE);
+// The first error in a file, for the log
+typedef struct {
+    uint16_t line;
+    char msg[48];
+} FirstError;
+
+static void first_error(void* ctx, uint16_t line, BrewDiagLevel level, const char* msg) {
+    FirstError* e = ctx;
+    if(level != BrewDiagError || e->msg[0]) return;
+    e->line = line;
+    snprintf(e->msg, sizeof(e->msg), "%s", msg);
+}
+
+static void file_stamp(Storage* storage, const char* path, uint64_t size, FileStamp* stamp) {
+    stamp->size = (uint32_t)size;
+    if(storage_common_timestamp(storage, path, &stamp->time) != FSE_OK) stamp->time = 0;
+}
+
+static bool is_brew_name(const char* name) {
+    size_t nlen = strlen(name);
+    return nlen >= 6 && ci_cmp(name + nlen - 5, ".brew") == 0;
 }
 
 // ============================================================
-// Save a custom recipe to .brew file
+// Recipe text, as a .brew file has it
 // ============================================================
-bool custom_recipe_save(CoffeeApp* app, uint8_t idx) {
-    if(idx >= MAX_CUSTOM_RECIPES) return false;
-    CustomRecipe* cr = &app->custom[idx];
-
-    // Generate filename from name if not set
-    if(cr->filename[0] == 0) {
-        // Simple: use index
-        snprintf(cr->filename, sizeof(cr->filename), "custom_%d.brew", idx);
+static void text_add(char* buf, size_t n, size_t* len, const char* fmt, ...) {
+    if(*len >= n) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int k = vsnprintf(buf + *len, n - *len, fmt, ap);
+    va_end(ap);
+    if(k > 0) *len += (size_t)k;
+}
+
+// Its length, or 0 if it doesn't fit in n with the NUL
+static uint16_t custom_recipe_format(const CustomRecipe* cr, char* buf, size_t n) {
+    size_t len = 0;
+    text_add(buf, n, &len, "name=%s\n", cr->name);
+    text_add(buf, n, &len, "grind=%s\n", cr->grind);
+    text_add(buf, n, &len, "coffee=%d\n", cr->coffee_grams);
+    text_add(buf, n, &len, "water=%d\n", cr->water_ml);
+    text_add(buf, n, &len, "temp=%d\n", cr->water_temp_c);
+    text_add(buf, n, &len, "---\n");
+
+    // Steps; a repeat row opens a block that END closes
+    int16_t block_end = -1;
+    for(uint8_t i = 0; i < cr->step_count; i++) {
+        const CustomStep* st = &cr->steps[i];
+        if(st->type == StepRepeat) {
+            text_add(buf, n, &len, "%s|%d\n", step_type_token(StepRepeat), st->duration_sec);
+            uint8_t body = custom_block_len(cr, i);
+            block_end = body > 0 ? i + body : -1;
+            if(block_end < 0) text_add(buf, n, &len, "END\n");
+            continue;
+        }
+        const char* tname = step_type_token(st->type < StepTypeCount ? st->type : StepPrep);
+        const char* adv = st->advance < AdvanceCount ? advance_tokens[st->advance] : "";
+        text_add(buf, n, &len, "%s|%s|%s|%d|%d|%d%s%s\n", tname, st->instruction, st->detail,
+            st->duration_sec, st->weight_grams, custom_step_water_ml(st), *adv ? "|" : "", adv);
+        if(i == block_end) {
+            text_add(buf, n, &len, "END\n");
+            block_end = -1;
+        }
     }
+    return len < n ? (uint16_t)len : 0;
+}
 
-    Storage* storage = furi_record_open(RECORD_STORAGE);
+// ============================================================
+// Load the custom recipes from the store
+//
+// Runs on the storage worker. Slots and the order table are filled
+// while custom_count is still 0 and the UI keeps out of them until
+// the completion event publishes the returned count. The .brew
+// folder is read by the change scan the completion starts.
+// ============================================================
+uint8_t custom_recipes_load(CoffeeApp* app) {
+    uint8_t count = 0;
+    Storage* storage = app->storage;
     storage_simply_mkdir(storage, CUSTOM_DIR);
+    char* buf = malloc(BREW_FILE_MAX);
+    if(!buf) return 0;
+
+    for(uint8_t slot = 0; slot < MAX_CUSTOM_RECIPES; slot++) {
+        CustomRecipe* cr = &app->custom[slot];
+        uint16_t len =
+            store_get(storage, &app->store, StoreKeyRecipe + slot, buf, BREW_FILE_MAX - 1);
+        buf[len] = 0;
+        if(len == 0 || !custom_recipe_parse(buf, cr, NULL)) continue;
+        CustomFileRecord rec;
+        memset(&rec, 0, sizeof(rec));
+        store_get(storage, &app->store, StoreKeyRecipeFile + slot, &rec, sizeof(rec));
+        memcpy(cr->filename, rec.filename, sizeof(cr->filename));
+        cr->filename[sizeof(cr->filename) - 1] = 0;
+        cr->stamp = rec.stamp;
+        app->custom_order[count++] = slot;
+    }
+    free(buf);
+    return count;
+}
+
+// ============================================================
+// Store side (storage worker): a recipe is its .brew text plus a
+// CustomFileRecord, under its slot's keys
+// ============================================================
+static void brew_path(char* path, size_t n, const char* filename) {
+    snprintf(path, n, "%s/%s", CUSTOM_DIR, filename);
+}
 
+// rec's file as the card has it; false if it isn't there
+static bool card_stamp(Storage* storage, const CustomFileRecord* rec, FileStamp* now) {
     char path[128];
-    snprintf(path, sizeof(path), "%s/%s", CUSTOM_DIR, cr->filename);
+    brew_path(path, sizeof(path), rec->filename);
+    FileInfo info;
+    if(storage_common_stat(storage, path, &info) != FSE_OK) return false;
+    file_stamp(storage, path, info.size, now);
+    return true;
+}
 
-    File* file = storage_file_alloc(storage);
-    bool ok = false;
-
-    if(storage_file_open(file, path, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
-        char line[128];
-        uint16_t len;
-
-        // Header
-        len = (uint16_t)snprintf(line, sizeof(line), "name=%s\n", cr->name);
-        storage_file_write(file, line, (uint16_t)len);
-        len = (uint16_t)snprintf(line, sizeof(line), "grind=%s\n", cr->grind);
-        storage_file_write(file, line, (uint16_t)len);
-        len = (uint16_t)snprintf(line, sizeof(line), "coffee=%d\n", cr->coffee_grams);
-        storage_file_write(file, line, (uint16_t)len);
-        len = (uint16_t)snprintf(line, sizeof(line), "water=%d\n", cr->water_ml);
-        storage_file_write(file, line, (uint16_t)len);
-        len = (uint16_t)snprintf(line, sizeof(line), "temp=%d\n", cr->water_temp_c);
-        storage_file_write(file, line, (uint16_t)len);
-
-        // Separator
-        storage_file_write(file, "---\n", 4);
-
-        // Steps
-        for(uint8_t i = 0; i < cr->step_count; i++) {
-            CustomStep* st = &cr->steps[i];
-            const char* tname;
-            switch(st->type) {
-            case StepAdd:   tname = "ADD"; break;
-            case StepStir:  tname = "STIR"; break;
-            case StepWait:  tname = "WAIT"; break;
-            case StepPress: tname = "PRESS"; break;
-            case StepFlip:  tname = "FLIP"; break;
-            case StepPrep:  tname = "PREP"; break;
-            case StepPour:  tname = "POUR"; break;
-            case StepSwirl: tname = "SWIRL"; break;
-            default:        tname = "PREP"; break;
-            }
-            uint16_t wml = custom_step_water_ml(st);
-            len = (uint16_t)snprintf(line, sizeof(line), "%s|%s|%s|%d|%d|%d\n",
-                tname, st->instruction, st->detail,
-                st->duration_sec, st->weight_grams, wml);
-            storage_file_write(file, line, (uint16_t)len);
-        }
+// Whether rec's file is on the card other than as the app last saw it:
+// edited there, or never written by the app at all
+static bool file_changed(Storage* storage, const CustomFileRecord* rec) {
+    FileStamp now;
+    return card_stamp(storage, rec, &now) &&
+           (now.size != rec->stamp.size || now.time != rec->stamp.time);
+}
 
-        ok = true;
+// First custom_N.brew that is neither on the card nor another stored
+// recipe's file
+static bool free_brew_name(Storage* storage, AppStore* store, uint8_t slot, CustomFileRecord* rec) {
+    char fn[sizeof(rec->filename)], path[128];
+    FileInfo info;
+    for(uint8_t n = 0; n < 100; n++) {
+        snprintf(fn, sizeof(fn), "custom_%d.brew", n);
+        brew_path(path, sizeof(path), fn);
+        bool taken = storage_common_stat(storage, path, &info) == FSE_OK;
+        for(uint8_t s = 0; s < MAX_CUSTOM_RECIPES && !taken; s++) {
+            CustomFileRecord other;
+            taken = s != slot &&
+                    store_get(storage, store, StoreKeyRecipeFile + s, &other, sizeof(other)) == sizeof(other) &&
+                    strncmp(other.filename, fn, sizeof(fn)) == 0;
+        }
+        if(taken) continue;
+        memcpy(rec->filename, fn, sizeof(fn));
+        memset(&rec->stamp, 0, sizeof(rec->stamp));
+        return true;
     }
+    return false;
+}
 
+// Stamp gets the file as written, so the next change scan passes it by
+static bool write_brew_file(
+    Storage* storage, const char* filename, const char* text, uint16_t len, FileStamp* stamp) {
+    storage_simply_mkdir(storage, CUSTOM_DIR);
+    char path[128];
+    brew_path(path, sizeof(path), filename);
+    File* file = storage_file_alloc(storage);
+    bool ok = storage_file_open(file, path, FSAM_WRITE, FSOM_CREATE_ALWAYS) &&
+              storage_file_write(file, text, len) == len;
     storage_file_close(file);
     storage_file_free(file);
-    furi_record_close(RECORD_STORAGE);
+    FileInfo info;
+    if(ok && storage_common_stat(storage, path, &info) == FSE_OK)
+        file_stamp(storage, path, info.size, stamp);
+    return ok;
+}
+
+// Writes slot's stored text to its .brew file and notes that in the
+// store. A file changed on the card since the app last saw it isn't
+// overwritten: the recipe moves to a free name, and the next scan brings
+// the card's version in as a recipe of its own.
+static bool export_recipe(
+    Storage* storage, AppStore* store, uint8_t slot, CustomFileRecord* rec, const char* text,
+    uint16_t len) {
+    if(file_changed(storage, rec)) {
+        char was[sizeof(rec->filename)];
+        memcpy(was, rec->filename, sizeof(was));
+        if(!free_brew_name(storage, store, slot, rec)) return false;
+        FURI_LOG_W(COFFEE_TIMER_TAG, "%s changed on the card; saved as %s", was, rec->filename);
+    }
+    rec->exported = write_brew_file(storage, rec->filename, text, len, &rec->stamp);
+    return rec->exported && store_put(storage, store, StoreKeyRecipeFile + slot, rec, sizeof(*rec));
+}
+
+// At exit: recipes saved since their .brew file was written get it
+// rewritten with the stored text
+bool custom_recipes_export(Storage* storage, AppStore* store) {
+    char* buf = malloc(BREW_FILE_MAX);
+    if(!buf) return false;
+    bool ok = true;
+    for(uint8_t slot = 0; slot < MAX_CUSTOM_RECIPES; slot++) {
+        CustomFileRecord rec;
+        if(store_get(storage, store, StoreKeyRecipeFile + slot, &rec, sizeof(rec)) != sizeof(rec) ||
+           rec.exported)
+            continue;
+        rec.filename[sizeof(rec.filename) - 1] = 0;
+        uint16_t len = store_get(storage, store, StoreKeyRecipe + slot, buf, BREW_FILE_MAX);
+        if(len == 0 || !export_recipe(storage, store, slot, &rec, buf, len)) ok = false;
+    }
+    free(buf);
     return ok;
 }
 
+bool custom_recipe_store(
+    Storage* storage, AppStore* store, uint8_t slot, const CustomRecipe* cr, bool exported) {
+    char* buf = malloc(BREW_FILE_MAX);
+    if(!buf) return false;
+    CustomFileRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    memcpy(rec.filename, cr->filename, sizeof(rec.filename));
+    rec.filename[sizeof(rec.filename) - 1] = 0;
+    rec.stamp = cr->stamp;
+    rec.exported = exported;
+    uint16_t len = custom_recipe_format(cr, buf, BREW_FILE_MAX);
+    bool ok = len > 0 && store_put(storage, store, StoreKeyRecipe + slot, buf, len) &&
+              store_put(storage, store, StoreKeyRecipeFile + slot, &rec, sizeof(rec));
+    free(buf);
+    return ok;
+}
+
+// Drops slot from the store and its .brew file from the card. A file
+// changed on the card since is left, and comes back on the next scan.
+bool custom_recipe_remove(Storage* storage, AppStore* store, uint8_t slot) {
+    CustomFileRecord rec;
+    bool ok = true;
+    if(store_get(storage, store, StoreKeyRecipeFile + slot, &rec, sizeof(rec)) == sizeof(rec) &&
+       rec.stamp.size > 0) {
+        rec.filename[sizeof(rec.filename) - 1] = 0;
+        FileStamp now;
+        if(card_stamp(storage, &rec, &now) && now.size == rec.stamp.size && now.time == rec.stamp.time) {
+            char path[128];
+            brew_path(path, sizeof(path), rec.filename);
+            ok = storage_simply_remove(storage, path);
+        }
+    }
+    return store_put(storage, store, StoreKeyRecipe + slot, NULL, 0) &&
+           store_put(storage, store, StoreKeyRecipeFile + slot, NULL, 0) && ok;
+}
+
 // ============================================================
-// Delete a custom recipe
+// New recipe: a free slot, appended to the list; -1 when full
 // ============================================================
-bool custom_recipe_delete(CoffeeApp* app, uint8_t idx) {
-    if(idx >= app->custom_count) return false;
-    CustomRecipe* cr = &app->custom[idx];
+int8_t custom_recipe_new(CoffeeApp* app) {
+    if(app->custom_count >= MAX_CUSTOM_RECIPES) return -1;
+    uint8_t slot = 0;
+    while(app->custom[slot].loaded) slot++;
+    custom_recipe_init_new(&app->custom[slot]);
+    app->custom_order[app->custom_count++] = slot;
+    list_index_invalidate(app);
+    return (int8_t)slot;
+}
 
-    if(cr->filename[0] != 0) {
-        Storage* storage = furi_record_open(RECORD_STORAGE);
-        char path[128];
-        snprintf(path, sizeof(path), "%s/%s", CUSTOM_DIR, cr->filename);
-        storage_simply_remove(storage, path);
-        furi_record_close(RECORD_STORAGE);
-    }
+static bool filename_in_use(CoffeeApp* app, const char* filename) {
+    for(uint8_t i = 0; i < app->custom_count; i++)
+        if(strcmp(custom_at(app, i)->filename, filename) == 0) return true;
+    return false;
+}
 
-    // Shift remaining
-    for(uint8_t i = idx; i < app->custom_count - 1; i++) {
-        memcpy(&app->custom[i], &app->custom[i + 1], sizeof(CustomRecipe));
+// ============================================================
+// Save a custom recipe: snapshot it for the storage worker, which
+// puts it in the store. exported says the snapshot is what its
+// .brew file holds, as for one read from the card.
+// ============================================================
+static bool custom_recipe_post(CoffeeApp* app, uint8_t slot, bool exported) {
+    StorageRequest req = {.op = StorageOpSaveRecipe, .slot = slot, .exported = exported};
+    req.recipe = malloc(sizeof(CustomRecipe));
+    if(!req.recipe) return false;
+    memcpy(req.recipe, &app->custom[slot], sizeof(CustomRecipe));
+    storage_post(app, &req);
+    return true;
+}
+
+bool custom_recipe_save(CoffeeApp* app, uint8_t slot) {
+    if(slot >= MAX_CUSTOM_RECIPES) return false;
+    CustomRecipe* cr = &app->custom[slot];
+
+    // New recipes get the first custom_N.brew no other recipe uses;
+    // slots are reused, so the slot number alone could clash
+    for(uint8_t n = 0; cr->filename[0] == 0; n++) {
+        char fn[sizeof(cr->filename)];
+        snprintf(fn, sizeof(fn), "custom_%d.brew", n);
+        if(!filename_in_use(app, fn)) memcpy(cr->filename, fn, sizeof(fn));
     }
+    return custom_recipe_post(app, slot, false);
+}
+
+// ============================================================
+// Delete a custom recipe: drop it from RAM now, file goes later.
+// Only the order table moves; the other slots stay put.
+// ============================================================
+static bool custom_unlist(CoffeeApp* app, uint8_t slot) {
+    uint8_t pos = 0;
+    while(pos < app->custom_count && app->custom_order[pos] != slot) pos++;
+    if(pos >= app->custom_count) return false;
+    app->custom[slot].loaded = false;
+    memmove(&app->custom_order[pos], &app->custom_order[pos + 1], app->custom_count - pos - 1);
     app->custom_count--;
+    list_index_invalidate(app);
     return true;
 }
+
+bool custom_recipe_delete(CoffeeApp* app, uint8_t slot) {
+    if(slot >= MAX_CUSTOM_RECIPES || !app->custom[slot].loaded) return false;
+    CustomRecipe* cr = &app->custom[slot];
+
+    // Saved ones leave the store, and the card if they got that far
+    if(cr->filename[0] != 0) {
+        StorageRequest req = {.op = StorageOpRemoveRecipe, .slot = slot};
+        storage_post(app, &req);
+    }
+    return custom_unlist(app, slot);
+}
+
+// ============================================================
+// Hot reload: entering the custom list asks the worker to compare
+// the directory with the files the app has, by size and time, and
+// to parse only the files that differ
+// ============================================================
+void custom_recipes_sync(CoffeeApp* app) {
+    if(!app->custom_loaded || app->custom_syncing) return;
+    CustomFileRef* known = malloc(MAX_CUSTOM_RECIPES * sizeof(CustomFileRef));
+    if(!known) return;
+    uint8_t n = 0;
+    for(uint8_t i = 0; i < app->custom_count; i++) {
+        const CustomRecipe* cr = custom_at(app, i);
+        if(cr->stamp.size == 0) continue;       // not on the card yet
+        memcpy(known[n].filename, cr->filename, sizeof(known[n].filename));
+        known[n].stamp = cr->stamp;
+        known[n].slot = app->custom_order[i];
+        n++;
+    }
+    StorageRequest req = {
+        .op = StorageOpSyncCustom, .data = (uint8_t*)known, .len = n * sizeof(CustomFileRef)};
+    app->custom_syncing = true;
+    storage_post(app, &req);
+}
+
+static CustomChange* sync_add(CustomSync** sync, uint8_t slot) {
+    if(!*sync) {
+        *sync = malloc(sizeof(CustomSync) + CUSTOM_SYNC_MAX * sizeof(CustomChange));
+        if(!*sync) return NULL;
+        (*sync)->count = 0;
+    }
+    if((*sync)->count >= CUSTOM_SYNC_MAX) return NULL;
+    CustomChange* ch = &(*sync)->change[(*sync)->count++];
+    ch->slot = slot;
+    ch->removed = false;
+    return ch;
+}
+
+// Whether slot has an editor save its .brew file doesn't have yet
+static bool unexported(Storage* storage, AppStore* store, uint8_t slot) {
+    CustomFileRecord rec;
+    return store_get(storage, store, StoreKeyRecipeFile + slot, &rec, sizeof(rec)) == sizeof(rec) &&
+           !rec.exported;
+}
+
+// Storage worker. A changed file that no longer parses is logged and
+// left out; only a missing file removes its recipe. So is one whose
+// recipe was saved in the app since: both versions are kept, as the
+// export at exit moves the app's to a new file. NULL when nothing
+// changed.
+CustomSync* custom_recipes_scan(
+    Storage* storage, AppStore* store, const CustomFileRef* known, uint8_t count) {
+    CustomSync* sync = NULL;
+    bool seen[MAX_CUSTOM_RECIPES] = {false};
+
+    Arena arena;
+    if(!arena_init(&arena, CUSTOM_ARENA_SIZE)) return NULL;
+    char* name = arena_alloc(&arena, 64);
+    char* path = arena_alloc(&arena, 128);
+    size_t mark = arena.used;
+
+    File* dir = storage_file_alloc(storage);
+    if(!storage_dir_open(dir, CUSTOM_DIR)) {
+        storage_dir_close(dir);
+        storage_file_free(dir);
+        arena_release(&arena);
+        return NULL;
+    }
+
+    FileInfo info;
+    while(storage_dir_read(dir, &info, name, 64)) {
+        if(!is_brew_name(name)) continue;
+        snprintf(path, 128, "%s/%s", CUSTOM_DIR, name);
+        FileStamp stamp;
+        file_stamp(storage, path, info.size, &stamp);
+
+        uint8_t k = 0;
+        while(k < count && strcmp(known[k].filename, name) != 0) k++;
+        if(k < count) {
+            seen[k] = true;
+            if(known[k].stamp.size == stamp.size && known[k].stamp.time == stamp.time) continue;
+            if(unexported(storage, store, known[k].slot)) {
+                FURI_LOG_W(COFFEE_TIMER_TAG, "%s changed on the card; keeping the app's edit too", name);
+                continue;
+            }
+        }
+        CustomChange* ch = sync_add(&sync, k < count ? known[k].slot : CUSTOM_SYNC_NEW);
+        if(!ch) break;
+        FirstError err = {0};
+        BrewDiag diag = {.fn = first_error, .ctx = &err};
+        bool ok = parse_brew_file(storage, path, &ch->recipe, &arena, &diag);
+        arena_rewind(&arena, mark);
+        if(!ok) {
+            // New: nothing to add. Known: the loaded version stays, and
+            // its old stamp brings the file up again next scan.
+            if(k < count)
+                FURI_LOG_W(COFFEE_TIMER_TAG, "%s:%u: %s; keeping the loaded recipe", name, err.line,
+                    err.msg);
+            sync->count--;
+            continue;
+        }
+        snprintf(ch->recipe.filename, sizeof(ch->recipe.filename), "%s", name);
+        ch->recipe.stamp = stamp;
+    }
+    storage_dir_close(dir);
+    storage_file_free(dir);
+    arena_release(&arena);
+
+    for(uint8_t k = 0; k < count; k++) {
+        if(seen[k]) continue;
+        CustomChange* ch = sync_add(&sync, known[k].slot);
+        if(!ch) break;
+        ch->removed = true;
+        memcpy(ch->recipe.filename, known[k].filename, sizeof(ch->recipe.filename));
+    }
+    if(sync && sync->count == 0) {
+        free(sync);
+        sync = NULL;
+    }
+    return sync;
+}
+
+// Recipes the app is using stay as they are: the one being brewed or
+// shown, the service session's, and all of them while the editor is
+// open. Their stamps stay old, so the next scan offers the change again.
+static bool custom_in_use(CoffeeApp* app, uint8_t slot) {
+    const AppState* s = &app->s;
+    if(screen_is_editor(s->screen)) return true;
+    bool shown = s->screen == ScreenRecipeInfo || s->screen == ScreenBrewing ||
+                 s->screen == ScreenConfirmAbort || s->screen == ScreenComplete;
+    if(shown && s->using_custom && s->cur_recipe == slot) return true;
+    if(app->service.active)
+        for(uint8_t i = 0; i < app->service.count; i++)
+            if(app->service.brew[i].custom && app->service.brew[i].recipe == slot) return true;
+    return false;
+}
+
+// Main thread; takes ownership of sync (may be NULL). What it takes
+// in goes to the store as well.
+void custom_sync_apply(CoffeeApp* app, CustomSync* sync) {
+    app->custom_syncing = false;
+    if(!sync) return;
+    for(uint8_t i = 0; i < sync->count; i++) {
+        CustomChange* ch = &sync->change[i];
+        if(ch->slot == CUSTOM_SYNC_NEW) {
+            if(filename_in_use(app, ch->recipe.filename)) continue;
+            int8_t slot = custom_recipe_new(app);
+            if(slot < 0) break;
+            app->custom[slot] = ch->recipe;
+            custom_recipe_post(app, (uint8_t)slot, true);
+            continue;
+        }
+        // The slot may have been deleted, or reused, since the scan began
+        CustomRecipe* cr = &app->custom[ch->slot];
+        if(!cr->loaded || strcmp(cr->filename, ch->recipe.filename) != 0) continue;
+        if(custom_in_use(app, ch->slot)) continue;
+        if(ch->removed) {
+            // The file is gone
+            StorageRequest req = {.op = StorageOpRemoveRecipe, .slot = ch->slot};
+            storage_post(app, &req);
+            custom_unlist(app, ch->slot);
+            service_forget_custom(&app->service, ch->slot);
+        } else {
+            *cr = ch->recipe;
+            list_index_invalidate(app);
+            custom_recipe_post(app, ch->slot, true);
+        }
+    }
+    AppState* s = &app->s;
+    if(s->method_sel == method_count && s->recipe_sel >= app->custom_count)
+        s->recipe_sel = app->custom_count > 0 ? app->custom_count - 1 : 0;
+    FURI_LOG_I(COFFEE_TIMER_TAG, "Custom recipes: %u changes on the card", sync->count);
+    free(sync);
+}
@@ -0,0 +1,535 @@
+#include "coffee_timer.h"
+#include <flipper_application/flipper_application.h>
+#include <string.h>
+
+// ============================================================
+// Recipe editor: built as a plugin (see application.fam) and loaded
+// only while its screens are open
+// ============================================================
+static const EditorHost* host;
+
+#define LIST_KEY_EDIT_MENU 0x200    // letter index key
+
+// ============================================================
+// List sources
+// ============================================================
+static const char* edit_menu_name(CoffeeApp* app, uint8_t idx) {
+    return idx < app->custom_count ? custom_at(app, idx)->name : "+ New Recipe";
+}
+
+static void edit_menu_row(CoffeeApp* app, uint8_t idx, char* lb, size_t n) {
+    snprintf(lb, n, "%s", edit_menu_name(app, idx));
+}
+
+static ListSource edit_menu_list(CoffeeApp* app) {
+    return (ListSource){app->custom_count + 1, edit_menu_row, edit_menu_name};
+}
+
+static void edit_steps_row(CoffeeApp* app, uint8_t idx, char* b, size_t n) {
+    const CustomRecipe* cr = &app->custom[app->editor.recipe_idx];
+    if(idx < cr->step_count && cr->steps[idx].type == StepRepeat)
+        snprintf(b, n, "%d.Repeat next %d x%d", idx + 1,
+            host->block_len(cr, idx), cr->steps[idx].duration_sec);
+    else if(idx < cr->step_count)
+        snprintf(b, n, "%d.%s %ds", idx + 1, host->step_type_name(cr->steps[idx].type), cr->steps[idx].duration_sec);
+    else
+        snprintf(b, n, "+ Add Step");
+}
+
+static ListSource edit_steps_list(CoffeeApp* app) {
+    const CustomRecipe* cr = &app->custom[app->editor.recipe_idx];
+    return (ListSource){cr->step_count + (cr->step_count < MAX_STEPS ? 1 : 0), edit_steps_row, NULL};
+}
+
+// ============================================================
+// Draw
+// ============================================================
+static void draw_edit_menu(Canvas* c, CoffeeApp* app) {
+    canvas_set_font(c, FontPrimary);
+    canvas_draw_str_aligned(c, 64, 2, AlignCenter, AlignTop, "Custom Recipes");
+    canvas_draw_line(c, 0, 13, 127, 13);
+    canvas_set_font(c, FontSecondary);
+
+    ListSource src = edit_menu_list(app);
+    list_draw(c, app, &src, app->editor.sel, 4);
+    canvas_draw_line(c, 0, 56, 127, 56);
+    canvas_draw_str_aligned(c, 64, 63, AlignCenter, AlignBottom, "[OK]Edit [<]Back");
+}
+
+static void draw_edit_recipe(Canvas* c, CoffeeApp* app) {
+    EditorState* ed = &app->editor;
+    CustomRecipe* cr = &app->custom[ed->recipe_idx];
+    char b[36];
+
+    canvas_set_font(c, FontPrimary);
+    canvas_draw_str_aligned(c, 64, 2, AlignCenter, AlignTop, "Edit Recipe");
+    canvas_draw_line(c, 0, 13, 127, 13);
+    canvas_set_font(c, FontSecondary);
+
+    const char* labels[] = {"Name:", "Grind:", "Coffee:", "Water:", "Temp:", ">> SAVE", ">> DELETE"};
+
+    uint8_t vs = 0;
+    if((uint8_t)ed->field > 3) vs = (uint8_t)ed->field - 3;
+
+    for(uint8_t i = 0; i < 4 && (vs + i) < EditFieldCount; i++) {
+        uint8_t fi = vs + i;
+        uint8_t y = 17 + (i * 10);
+        if(fi == (uint8_t)ed->field) {
+            canvas_set_color(c, ColorBlack);
+            canvas_draw_box(c, 0, y - 1, 128, 11);
+            canvas_set_color(c, ColorWhite);
+        } else { canvas_set_color(c, ColorBlack); }
+
+        switch(fi) {
+        case EditFieldName:
+            snprintf(b, sizeof(b), "%s %s", labels[fi], cr->name);
+            if(ed->editing && fi == (uint8_t)ed->field) {
+                // Underline the character under the cursor
+                char pre[NAME_LEN + 8];
+                snprintf(pre, sizeof(pre), "%s %.*s", labels[fi], ed->name_cursor, cr->name);
+                uint8_t cx = 4 + canvas_string_width(c, pre);
+                char ch[2] = {cr->name[ed->name_cursor], 0};
+                uint8_t cw = canvas_string_width(c, ch);
+                if(cw < 3) cw = 3;
+                canvas_draw_line(c, cx, y + 9, cx + cw - 1, y + 9);
+            }
+            break;
+        case EditFieldGrind: snprintf(b, sizeof(b), "%s %s", labels[fi], cr->grind); break;
+        case EditFieldCoffee: snprintf(b, sizeof(b), "%s %dg", labels[fi], cr->coffee_grams); break;
+        case EditFieldWater: snprintf(b, sizeof(b), "%s %dml", labels[fi], cr->water_ml); break;
+        case EditFieldTemp: snprintf(b, sizeof(b), "%s %dC", labels[fi], cr->water_temp_c); break;
+        default: snprintf(b, sizeof(b), "%s", labels[fi]); break;
+        }
+        canvas_draw_str(c, 4, y + 7, b);
+    }
+    canvas_set_color(c, ColorBlack);
+    canvas_draw_line(c, 0, 56, 127, 56);
+    const char* hint = "[OK]Edit [>]Steps [<]Back";
+    if(ed->editing)
+        hint = (ed->field == EditFieldName) ? "[</>]Chr [^v]Set [OK]Nxt" : "[</>]Adj hold=fast [OK]";
+    canvas_draw_str_aligned(c, 64, 63, AlignCenter, AlignBottom, hint);
+}
+
+static void draw_edit_steps(Canvas* c, CoffeeApp* app) {
+    EditorState* ed = &app->editor;
+    CustomRecipe* cr = &app->custom[ed->recipe_idx];
+    char b[36];
+
+    canvas_set_font(c, FontPrimary);
+    snprintf(b, sizeof(b), "Steps (%d/%d)", cr->step_count, MAX_STEPS);
+    canvas_draw_str_aligned(c, 64, 2, AlignCenter, AlignTop, b);
+    canvas_draw_line(c, 0, 13, 127, 13);
+    canvas_set_font(c, FontSecondary);
+
+    ListSource src = edit_steps_list(app);
+    list_draw(c, app, &src, ed->sel, 4);
+    canvas_draw_line(c, 0, 56, 127, 56);
+    canvas_draw_str_aligned(c, 64, 63, AlignCenter, AlignBottom, "[OK]Edit [>]Del [<]Back");
+}
+
+static void draw_edit_step(Canvas* c, CoffeeApp* app) {
+    EditorState* ed = &app->editor;
+    CustomStep* st = &app->custom[ed->recipe_idx].steps[ed->step_idx];
+    char b[36];
+
+    canvas_set_font(c, FontPrimary);
+    snprintf(b, sizeof(b), "Step %d", ed->step_idx + 1);
+    canvas_draw_str_aligned(c, 64, 2, AlignCenter, AlignTop, b);
+    canvas_draw_line(c, 0, 13, 127, 13);
+    canvas_set_font(c, FontSecondary);
+
+    for(uint8_t i = 0; i < StepFieldCount; i++) {
+        uint8_t y = 17 + (i * 10);
+        if(i == (uint8_t)ed->step_field) {
+            canvas_set_color(c, ColorBlack);
+            canvas_draw_box(c, 0, y - 1, 128, 11);
+            canvas_set_color(c, ColorWhite);
+        } else { canvas_set_color(c, ColorBlack); }
+        bool rep = st->type == StepRepeat;
+        switch(i) {
+        case StepFieldType: snprintf(b, sizeof(b), "Type: %s", host->step_type_name(st->type)); break;
+        case StepFieldDuration:
+            if(rep) { snprintf(b, sizeof(b), "Times: x%d", st->duration_sec); break; } snprintf(b, sizeof(b), "Time: %ds", st->duration_sec); break;
+        case StepFieldWater:
+            if(rep) snprintf(b, sizeof(b), "Water: -");
+            else snprintf(b, sizeof(b), "Water: %dml", custom_step_water_ml(st));
+            break;
+        case StepFieldWeight:
+            if(rep) snprintf(b, sizeof(b), "Block: next %d steps", st->weight_grams);
+            else snprintf(b, sizeof(b), "Weight: %dg", st->weight_grams);
+            break;
+        }
+        canvas_draw_str(c, 4, y + 7, b);
+    }
+    canvas_set_color(c, ColorBlack);
+    canvas_draw_line(c, 0, 56, 127, 56);
+    canvas_draw_str_aligned(c, 64, 63, AlignCenter, AlignBottom, "[</>]Adj hold=fast [OK]");
+}
+
+// ============================================================
+// Input acceleration: a held key steps further the longer it
+// repeats, so long values don't cost one press per unit
+// ============================================================
+static void accel_track(EditorState* ed, InputEvent* ev) {
+    if(ev->type == InputTypePress) {
+        ed->held_key = ev->key;
+        ed->repeats = 0;
+    } else if(ev->type == InputTypeRepeat && ev->key == ed->held_key && ed->repeats < 255) {
+        ed->repeats++;
+    }
+}
+
+static int accel_mult(const EditorState* ed) {
+    if(ed->repeats < 4) return 1;
+    if(ed->repeats < 12) return 5;
+    return 10;
+}
+
+static int clamp_step(int v, int delta, int lo, int hi) {
+    v += delta;
+    if(v < lo) v = lo;
+    if(v > hi) v = hi;
+    return v;
+}
+
+// Name characters run ' '..'z'; Up/Down jump between these classes
+static const char name_class_start[] = {' ', 'A', 'a', '0', '-'};
+#define NAME_CLASS_COUNT (sizeof(name_class_start) / sizeof(name_class_start[0]))
+
+static uint8_t name_class(char ch) {
+    if(ch == ' ') return 0;
+    if(ch >= 'A' && ch <= 'Z') return 1;
+    if(ch >= 'a' && ch <= 'z') return 2;
+    if(ch >= '0' && ch <= '9') return 3;
+    return 4;
+}
+
+static char name_char_step(char ch, int delta) {
+    const int span = 'z' - ' ' + 1;
+    int v = ((ch - ' ') + delta) % span;
+    if(v < 0) v += span;
+    return (char)(' ' + v);
+}
+
+static void name_edit(EditorState* ed, CustomRecipe* cr, InputEvent* ev) {
+    size_t len = strlen(cr->name);
+    if(len == 0) { cr->name[0] = 'A'; cr->name[1] = 0; len = 1; }
+    if(ed->name_cursor >= (uint8_t)len) ed->name_cursor = (uint8_t)(len - 1);
+    char* ch = &cr->name[ed->name_cursor];
+
+    // OK acts on release: Short steps on, Long goes back to the first
+    // character. The press that opened the editor isn't one of ours.
+    if(ev->key == InputKeyOk) {
+        if(ev->type == InputTypePress) ed->name_ok_down = true;
+        if(ev->type != InputTypeShort && ev->type != InputTypeLong) return;
+        if(!ed->name_ok_down) return;
+        ed->name_ok_down = false;
+        if(ev->type == InputTypeLong) {
+            ed->name_cursor = 0;
+            return;
+        }
+    } else if(ev->type != InputTypePress && ev->type != InputTypeRepeat) {
+        return;
+    }
+
+    switch(ev->key) {
+    case InputKeyLeft:
+    case InputKeyRight: {
+        int dir = (ev->key == InputKeyRight) ? 1 : -1;
+        *ch = name_char_step(*ch, dir * accel_mult(ed));
+        break;
+    }
+    case InputKeyUp:
+    case InputKeyDown: {
+        uint8_t cls = name_class(*ch);
+        cls = (ev->key == InputKeyUp) ? (uint8_t)((cls + 1) % NAME_CLASS_COUNT) :
+                                        (uint8_t)((cls + NAME_CLASS_COUNT - 1) % NAME_CLASS_COUNT);
+        *ch = name_class_start[cls];
+        break;
+    }
+    case InputKeyOk:
+        // Next character; past the end a new one is appended in the
+        // same case so words can be typed without class jumps
+        if(ed->name_cursor + 1 < (uint8_t)len) {
+            ed->name_cursor++;
+        } else if(len < NAME_LEN - 1) {
+            uint8_t cls = name_class(*ch);
+            cr->name[len] = (cls == 1 || cls == 2) ? 'a' : *ch;
+            cr->name[len + 1] = 0;
+            ed->name_cursor++;
+        }
+        break;
+    case InputKeyBack:
+        // Done: trailing spaces are how characters get deleted
+        while(len > 1 && cr->name[len - 1] == ' ') cr->name[--len] = 0;
+        ed->editing = false;
+        break;
+    default: break;
+    }
+}
+
+// ============================================================
+// Input
+// ============================================================
+static void handle_edit_menu(CoffeeApp* app, InputEvent* ev) {
+    ListSource src = edit_menu_list(app);
+    if(list_nav(&src, ev, &app->editor.sel)) return;
+    if(ev->key == InputKeyLeft) {
+        list_jump(app, &src, LIST_KEY_EDIT_MENU, &app->editor.sel);
+    } else if(ev->key == InputKeyOk) {
+        if(app->editor.sel >= app->custom_count) {
+            // New recipe
+            int8_t slot = host->recipe_new(app);
+            if(slot >= 0) {
+                app->editor.recipe_idx = (uint8_t)slot;
+                app->editor.field = EditFieldName;
+                app->editor.editing = false;
+                app->s.screen = ScreenEditRecipe;
+            }
+        } else {
+            app->editor.recipe_idx = app->custom_order[app->editor.sel];
+            app->editor.field = EditFieldName;
+            app->editor.editing = false;
+            app->s.screen = ScreenEditRecipe;
+        }
+    } else if(ev->key == InputKeyBack) {
+        app->s.screen = ScreenMethodMenu;
+    }
+}
+
+static void handle_edit_recipe(CoffeeApp* app, InputEvent* ev) {
+    EditorState* ed = &app->editor;
+    CustomRecipe* cr = &app->custom[ed->recipe_idx];
+
+    if(ed->editing && ed->field == EditFieldName) {
+        name_edit(ed, cr, ev);
+        list_index_invalidate(app);     // the name may sort elsewhere now
+        return;
+    }
+    if(ev->type == InputTypeLong) return;
+
+    if(ed->editing) {
+        // Editing a value
+        if(ev->key == InputKeyOk || ev->key == InputKeyBack) {
+            ed->editing = false;
+            return;
+        }
+        int dir = (ev->key == InputKeyRight) ? 1 : (ev->key == InputKeyLeft) ? -1 : 0;
+        if(dir == 0) return;
+        int step = dir * accel_mult(ed);
+
+        switch(ed->field) {
+        case EditFieldGrind: {
+            // Cycle through presets
+            uint8_t gi = 0;
+            for(uint8_t i = 0; i < GRIND_COUNT; i++) {
+                if(strcmp(cr->grind, host->grind_names[i]) == 0) { gi = i; break; }
+            }
+            gi = (uint8_t)((int)gi + dir);
+            if(gi >= GRIND_COUNT) gi = (dir > 0) ? 0 : GRIND_COUNT - 1;
+            snprintf(cr->grind, sizeof(cr->grind), "%s", host->grind_names[gi]);
+            break;
+        }
+        case EditFieldCoffee:
+            cr->coffee_grams = (uint8_t)clamp_step(cr->coffee_grams, step, 1, 200);
+            break;
+        case EditFieldWater:
+            cr->water_ml = (uint16_t)clamp_step(cr->water_ml, step * 10, 10, 2000);
+            break;
+        case EditFieldTemp:
+            cr->water_temp_c = (uint16_t)clamp_step(cr->water_temp_c, step, 0, 100);
+            break;
+        default: break;
+        }
+        return;
+    }
+
+    // Not editing - navigate fields
+    if(ev->key == InputKeyUp) {
+        ed->field = (ed->field == 0) ? EditFieldCount - 1 : ed->field - 1;
+    } else if(ev->key == InputKeyDown) {
+        ed->field = (ed->field >= EditFieldCount - 1) ? 0 : ed->field + 1;
+    } else if(ev->key == InputKeyOk) {
+        if(ed->field == EditFieldSave) {
+            // Auto-generate instructions
+            for(uint8_t i = 0; i < cr->step_count; i++) {
+                snprintf(cr->steps[i].instruction, NAME_LEN, "%s", host->step_type_name(cr->steps[i].type));
+                host->step_auto_detail(&cr->steps[i]);
+            }
+            host->recipe_save(app, ed->recipe_idx);
+            app->s.screen = ScreenEditMenu;
+        } else if(ed->field == EditFieldDelete) {
+            app->s.screen = ScreenConfirmDelete;
+        } else {
+            ed->editing = true;
+            if(ed->field == EditFieldName) {
+                size_t nlen = strlen(cr->name);
+                ed->name_cursor = (nlen > 0) ? (uint8_t)(nlen - 1) : 0;
+                ed->name_ok_down = false;
+            }
+        }
+    } else if(ev->key == InputKeyRight) {
+        // Go to steps editor
+        ed->sel = 0;
+        app->s.screen = ScreenEditSteps;
+    } else if(ev->key == InputKeyBack) {
+        app->s.screen = ScreenEditMenu;
+    }
+}
+
+static void handle_edit_steps(CoffeeApp* app, InputEvent* ev) {
+    EditorState* ed = &app->editor;
+    CustomRecipe* cr = &app->custom[ed->recipe_idx];
+    ListSource src = edit_steps_list(app);
+
+    if(list_nav(&src, ev, &ed->sel)) return;
+    if(ev->key == InputKeyOk) {
+        if(ed->sel >= cr->step_count) {
+            // Add new step
+            if(cr->step_count < MAX_STEPS) {
+                CustomStep* st = &cr->steps[cr->step_count];
+                memset(st, 0, sizeof(CustomStep));
+                st->type = StepWait;
+                st->duration_sec = 30;
+                snprintf(st->instruction, NAME_LEN, "Wait");
+                snprintf(st->detail, DETAIL_LEN, "30s");
+                ed->step_idx = cr->step_count;
+                cr->step_count++;
+                ed->step_field = StepFieldType;
+                app->s.screen = ScreenEditStep;
+            }
+        } else {
+            ed->step_idx = ed->sel;
+            ed->step_field = StepFieldType;
+            app->s.screen = ScreenEditStep;
+        }
+    } else if(ev->key == InputKeyRight) {
+        // Delete step
+        if(ed->sel < cr->step_count && cr->step_count > 0) {
+            // A block that covered the row loses it instead of growing
+            for(uint8_t i = 0; i < ed->sel; i++) {
+                CustomStep* rp = &cr->steps[i];
+                if(rp->type == StepRepeat && i + rp->weight_grams >= ed->sel && rp->weight_grams > 0)
+                    rp->weight_grams--;
+            }
+            for(uint8_t i = ed->sel; i < cr->step_count - 1; i++)
+                memcpy(&cr->steps[i], &cr->steps[i + 1], sizeof(CustomStep));
+            cr->step_count--;
+            if(ed->sel >= cr->step_count && ed->sel > 0) ed->sel--;
+        }
+    } else if(ev->key == InputKeyBack) {
+        app->s.screen = ScreenEditRecipe;
+    }
+}
+
+static void handle_edit_step(CoffeeApp* app, InputEvent* ev) {
+    EditorState* ed = &app->editor;
+    CustomStep* st = &app->custom[ed->recipe_idx].steps[ed->step_idx];
+
+    if(ev->key == InputKeyUp) {
+        ed->step_field = (ed->step_field == 0) ? StepFieldCount - 1 : ed->step_field - 1;
+    } else if(ev->key == InputKeyDown) {
+        ed->step_field = (ed->step_field >= StepFieldCount - 1) ? 0 : ed->step_field + 1;
+    } else if(ev->key == InputKeyLeft || ev->key == InputKeyRight) {
+        int dir = (ev->key == InputKeyRight) ? 1 : -1;
+        int step = dir * accel_mult(ed);
+        switch(ed->step_field) {
+        case StepFieldType: {
+            int t = (int)st->type + dir;
+            if(t < 0) t = (int)StepTypeCount - 1;
+            if(t >= (int)StepTypeCount) t = 0;
+            st->type = (StepType)t;
+            snprintf(st->instruction, NAME_LEN, "%s", host->step_type_name(st->type));
+            if(st->type == StepRepeat) {
+                // Default block: the next two rows, twice
+                st->duration_sec = 2;
+                st->weight_grams = 2;
+                st->water_ml_div10 = 0;
+            }
+            break;
+        }
+        case StepFieldDuration:
+            if(st->type == StepRepeat)
+                st->duration_sec = (uint16_t)clamp_step(st->duration_sec, step, MIN_REPEAT, MAX_REPEAT);
+            else
+                st->duration_sec = (uint16_t)clamp_step(st->duration_sec, step * 5, 0, 600);
+            break;
+        case StepFieldWater:
+            if(st->type != StepRepeat)
+                st->water_ml_div10 = (uint8_t)clamp_step(st->water_ml_div10, step, 0, 200);
+            break;
+        case StepFieldWeight:
+            if(st->type == StepRepeat)
+                st->weight_grams = (uint8_t)clamp_step(st->weight_grams, step, 1, MAX_STEPS - 1);
+            else
+                st->weight_grams = (uint8_t)clamp_step(st->weight_grams, step, 0, 200);
+            break;
+        default: break;
+        }
+        host->step_auto_detail(st);
+    } else if(ev->key == InputKeyOk || ev->key == InputKeyBack) {
+        host->step_auto_detail(st);
+        app->s.screen = ScreenEditSteps;
+    }
+}
+
+static void handle_confirm_delete(CoffeeApp* app, InputEvent* ev) {
+    if(ev->key == InputKeyOk) {
+        host->recipe_delete(app, app->editor.recipe_idx);
+        app->editor.sel = 0;
+        app->s.screen = ScreenEditMenu;
+    } else if(ev->key == InputKeyBack) {
+        app->s.screen = ScreenEditRecipe;
+    }
+}
+
+// ============================================================
+// Plugin interface
+// ============================================================
+static void editor_bind(const EditorHost* h) {
+    host = h;
+}
+
+static void editor_draw(Canvas* c, CoffeeApp* app) {
+    switch(app->s.screen) {
+    case ScreenEditMenu:      draw_edit_menu(c, app); break;
+    case ScreenEditRecipe:    draw_edit_recipe(c, app); break;
+    case ScreenEditSteps:     draw_edit_steps(c, app); break;
+    case ScreenEditStep:      draw_edit_step(c, app); break;
+    case ScreenConfirmDelete: draw_edit_recipe(c, app); host->confirm_box(c, "Delete recipe?"); break;
+    default: break;
+    }
+}
+
+static void editor_input(CoffeeApp* app, InputEvent* ev) {
+    accel_track(&app->editor, ev);
+    // The name editor sorts out event types itself
+    EditorState* ed = &app->editor;
+    bool naming = app->s.screen == ScreenEditRecipe && ed->editing && ed->field == EditFieldName;
+    if(!naming && ev->type != InputTypePress && ev->type != InputTypeRepeat) return;
+
+    switch(app->s.screen) {
+    case ScreenEditMenu:      handle_edit_menu(app, ev); break;
+    case ScreenEditRecipe:    handle_edit_recipe(app, ev); break;
+    case ScreenEditSteps:     handle_edit_steps(app, ev); break;
+    case ScreenEditStep:      handle_edit_step(app, ev); break;
+    case ScreenConfirmDelete: handle_confirm_delete(app, ev); break;
+    default: break;
+    }
+}
+
+static const EditorPlugin editor_plugin = {
+    .bind = editor_bind,
+    .draw = editor_draw,
+    .input = editor_input,
+};
+
+static const FlipperAppPluginDescriptor editor_descriptor = {
+    .appid = EDITOR_PLUGIN_APP_ID,
+    .ep_api_version = EDITOR_PLUGIN_API_VERSION,
+    .entry_point = &editor_plugin,
+};
+
+const FlipperAppPluginDescriptor* editor_plugin_ep(void) {
+    return &editor_descriptor;
+}
@@ -0,0 +1,40 @@
+#include "coffee_timer.h"
+#include <flipper_application/flipper_application.h>
+#include <flipper_application/plugins/plugin_manager.h>
+#include <loader/firmware_api/firmware_api.h>
+
+// ============================================================
+// Editor plugin: loaded when the editor opens, dropped when it
+// closes, so brewing never carries its code
+// ============================================================
+bool editor_load(CoffeeApp* app, const EditorHost* host) {
+    if(app->editor_api) return true;
+    uint32_t start = furi_get_tick();
+    size_t heap = memmgr_get_free_heap();
+
+    PluginManager* pm =
+        plugin_manager_alloc(EDITOR_PLUGIN_APP_ID, EDITOR_PLUGIN_API_VERSION, firmware_api_interface);
+    PluginManagerError err = plugin_manager_load_single(pm, EDITOR_PLUGIN_PATH);
+    if(err != PluginManagerErrorNone) {
+        FURI_LOG_E(COFFEE_TIMER_TAG, "Editor plugin failed to load (%d)", err);
+        plugin_manager_free(pm);
+        return false;
+    }
+    app->editor_plugin = pm;
+    app->editor_api = plugin_manager_get_ep(pm, 0);
+    app->editor_api->bind(host);
+
+    size_t left = memmgr_get_free_heap();
+    app->metrics.editor_load_ms = furi_get_tick() - start;
+    app->metrics.editor_heap = heap > left ? (uint32_t)(heap - left) : 0;
+    FURI_LOG_I(COFFEE_TIMER_TAG, "Editor loaded in %lums, %luB",
+        app->metrics.editor_load_ms, app->metrics.editor_heap);
+    return true;
+}
+
+void editor_unload(CoffeeApp* app) {
+    if(!app->editor_plugin) return;
+    plugin_manager_free(app->editor_plugin);
+    app->editor_plugin = NULL;
+    app->editor_api = NULL;
+}
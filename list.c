@@ -0,0 +1,100 @@
+#include "coffee_timer.h"
+
+// ============================================================
+// Scrolling lists: the window follows the selection, and only
+// the rows in it are fetched from the source
+// ============================================================
+static uint8_t list_top(uint8_t count, uint8_t sel) {
+    uint8_t top = sel > LIST_ROWS / 2 ? sel - LIST_ROWS / 2 : 0;
+    if(top + LIST_ROWS > count) top = count > LIST_ROWS ? count - LIST_ROWS : 0;
+    return top;
+}
+
+void list_draw(Canvas* c, CoffeeApp* app, const ListSource* src, uint8_t sel, uint8_t x) {
+    char lb[36];
+    uint8_t top = list_top(src->count, sel);
+    for(uint8_t i = 0; i < LIST_ROWS && top + i < src->count; i++) {
+        uint8_t idx = top + i;
+        uint8_t y = 17 + (i * 10);
+        if(idx == sel) {
+            canvas_set_color(c, ColorBlack);
+            canvas_draw_box(c, 0, y - 1, 128, 11);
+            canvas_set_color(c, ColorWhite);
+        } else {
+            canvas_set_color(c, ColorBlack);
+        }
+        src->row(app, idx, lb, sizeof(lb));
+        canvas_draw_str(c, x, y + 7, lb);
+    }
+    canvas_set_color(c, ColorBlack);
+}
+
+// Up/Down step one row and wrap; held, they page and stop at the ends
+bool list_nav(const ListSource* src, const InputEvent* ev, uint8_t* sel) {
+    if(ev->key != InputKeyUp && ev->key != InputKeyDown) return false;
+    if(src->count == 0) return true;
+    uint8_t last = src->count - 1;
+    bool up = ev->key == InputKeyUp;
+    if(ev->type == InputTypeRepeat) {
+        if(up) *sel = *sel > LIST_ROWS ? *sel - LIST_ROWS : 0;
+        else *sel = *sel + LIST_ROWS < last ? *sel + LIST_ROWS : last;
+    } else if(up) {
+        *sel = *sel == 0 ? last : *sel - 1;
+    } else {
+        *sel = *sel >= last ? 0 : *sel + 1;
+    }
+    return true;
+}
+
+// ============================================================
+// First-letter jumps over a sorted-name index, built once per
+// list and kept until the list changes
+// ============================================================
+static char fold(char ch) {
+    return (ch >= 'a' && ch <= 'z') ? (char)(ch - 32) : ch;
+}
+
+static int name_cmp(const char* a, const char* b) {
+    while(*a && fold(*a) == fold(*b)) {
+        a++;
+        b++;
+    }
+    return (unsigned char)fold(*a) - (unsigned char)fold(*b);
+}
+
+// Insertion sort: short lists, built off the draw path
+static void list_index_build(ListIndex* li, CoffeeApp* app, const ListSource* src, uint16_t key) {
+    li->count = src->count < LIST_MAX ? src->count : LIST_MAX;
+    for(uint8_t i = 0; i < li->count; i++) {
+        const char* name = src->name(app, i);
+        uint8_t k = i;
+        while(k > 0 && name_cmp(src->name(app, li->sorted[k - 1]), name) > 0) {
+            li->sorted[k] = li->sorted[k - 1];
+            k--;
+        }
+        li->sorted[k] = i;
+    }
+    li->key = key;
+}
+
+// Selects the first row, by name, whose initial comes after the
+// selected row's; past the last letter it wraps to the first
+bool list_jump(CoffeeApp* app, const ListSource* src, uint16_t key, uint8_t* sel) {
+    ListIndex* li = &app->list_index;
+    if(!src->name || src->count == 0) return false;
+    if(li->key != key) list_index_build(li, app, src, key);
+
+    char cur = fold(src->name(app, *sel)[0]);
+    for(uint8_t r = 0; r < li->count; r++) {
+        if(fold(src->name(app, li->sorted[r])[0]) > cur) {
+            *sel = li->sorted[r];
+            return true;
+        }
+    }
+    *sel = li->sorted[0];
+    return true;
+}
+
+void list_index_invalidate(CoffeeApp* app) {
+    app->list_index.key = 0;
+}
@@ -0,0 +1,195 @@
+#include "coffee_timer.h"
+#include <furi_hal.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define METRICS_FIXED_LINES 13
+
+static const char* screen_names[ScreenCount] = {
+    "Methods", "Recipes", "Info", "Brewing", "Complete", "Abort?",
+    "EditMenu", "EditRcp", "EditSteps", "EditStep", "Delete?", "Debug",
+    "SvcQueue", "Service",
+};
+
+const char* metrics_screen_name(Screen screen) {
+    return screen < ScreenCount ? screen_names[screen] : "?";
+}
+
+// ============================================================
+// Recording
+// ============================================================
+// Raw cycle stamps: the 32-bit counter wraps about every 67 s at 64 MHz,
+// so only a difference of two, taken as uint32_t, is worth converting
+uint32_t metrics_cycles(void) {
+    return DWT->CYCCNT;
+}
+
+uint32_t metrics_us_since(uint32_t start) {
+    return (DWT->CYCCNT - start) / furi_hal_cortex_instructions_per_microsecond();
+}
+
+void metrics_record(MetricTiming* t, uint32_t v) {
+    if(t->count == 0 || v < t->min) t->min = v;
+    if(v > t->max) t->max = v;
+    t->sum += v;
+    t->count++;
+}
+
+// Called from the main loop, so the stack figure is the app thread's
+void metrics_sample(CoffeeApp* app) {
+    AppMetrics* m = &app->metrics;
+    uint32_t depth = furi_message_queue_get_count(app->queue);
+    if(depth > m->queue_max) m->queue_max = depth;
+    uint32_t stack = furi_thread_get_stack_space(furi_thread_get_current_id());
+    if(m->stack_min == 0 || stack < m->stack_min) m->stack_min = stack;
+}
+
+// Launch and load figures are one-shot, so they survive a reset
+void metrics_reset(CoffeeApp* app) {
+    AppMetrics* m = &app->metrics;
+    uint8_t line = m->debug_line;
+    uint32_t launch = m->launch_tick;
+    uint32_t first = m->first_frame_ms;
+    uint32_t custom = m->custom_ready_ms;
+    uint32_t editor_ms = m->editor_load_ms;
+    uint32_t editor_heap = m->editor_heap;
+    memset(m, 0, sizeof(AppMetrics));
+    m->debug_line = line;
+    m->launch_tick = launch;
+    m->first_frame_ms = first;
+    m->custom_ready_ms = custom;
+    m->editor_load_ms = editor_ms;
+    m->editor_heap = editor_heap;
+}
+
+// ============================================================
+// Report lines, shared by the debug screen and the SD dump
+// ============================================================
+static void fmt_timing(char* buf, size_t n, const char* label, const MetricTiming* t, const char* unit) {
+    if(t->count == 0) {
+        snprintf(buf, n, "%s: -", label);
+        return;
+    }
+    snprintf(buf, n, "%s %lu/%lu/%lu%s",
+        label,
+        (unsigned long)t->min,
+        (unsigned long)(t->sum / t->count),
+        (unsigned long)t->max,
+        unit);
+}
+
+static const MetricTiming* nth_drawn_screen(CoffeeApp* app, uint8_t nth, uint8_t* screen) {
+    for(uint8_t i = 0; i < ScreenCount; i++) {
+        if(app->metrics.draw[i].count == 0) continue;
+        if(nth-- == 0) {
+            *screen = i;
+            return &app->metrics.draw[i];
+        }
+    }
+    return NULL;
+}
+
+uint8_t metrics_line_count(CoffeeApp* app) {
+    uint8_t n = METRICS_FIXED_LINES;
+    for(uint8_t i = 0; i < ScreenCount; i++)
+        if(app->metrics.draw[i].count > 0) n++;
+    return n;
+}
+
+void metrics_format_line(CoffeeApp* app, uint8_t idx, char* buf, size_t n) {
+    AppMetrics* m = &app->metrics;
+    switch(idx) {
+    case 0:
+        snprintf(buf, n, "Tick %lu miss %lu",
+            (unsigned long)m->ticks, (unsigned long)m->tick_misses);
+        break;
+    case 1: fmt_timing(buf, n, "Tick dt", &m->tick_interval, "ms"); break;
+    case 2: fmt_timing(buf, n, "Frame", &m->frame, "us"); break;
+    case 3:
+        snprintf(buf, n, "Frames %lu miss %lu",
+            (unsigned long)m->frame.count, (unsigned long)m->frame_misses);
+        break;
+    case 4: fmt_timing(buf, n, "Input", &m->input_latency, "ms"); break;
+    case 5: fmt_timing(buf, n, "SD", &m->storage, "ms"); break;
+    case 6:
+        snprintf(buf, n, "Queue max %lu/%d SD drop %lu",
+            (unsigned long)m->queue_max, EVENT_QUEUE_LEN, (unsigned long)m->storage_drops);
+        break;
+    case 7:
+        snprintf(buf, n, "Stack free min %luB", (unsigned long)m->stack_min);
+        break;
+    case 8:
+        snprintf(buf, n, "Heap %u min %u",
+            (unsigned)memmgr_get_free_heap(), (unsigned)memmgr_get_minimum_free_heap());
+        break;
+    case 9:
+        snprintf(buf, n, "1stFrame %lu Cust %lums",
+            (unsigned long)m->first_frame_ms, (unsigned long)m->custom_ready_ms);
+        break;
+    case 10:
+        if(app->telemetry.active)
+            snprintf(buf, n, "USB tx %lu stall %lu",
+                (unsigned long)app->telemetry.frames, (unsigned long)app->telemetry.stalls);
+        else
+            snprintf(buf, n, "USB tx off");
+        break;
+    case 11:
+        if(m->editor_heap == 0)
+            snprintf(buf, n, "Editor load -");
+        else
+            snprintf(buf, n, "Editor load %lums %luB",
+                (unsigned long)m->editor_load_ms, (unsigned long)m->editor_heap);
+        break;
+    case 12: {
+        const AppSensor* s = &app->sensor;
+        if(s->source == SensorOff)
+            snprintf(buf, n, "Scale off");
+        else
+            snprintf(buf, n, "Scale %s %lu bad %lu drop %lu", sensor_source_name(s->source),
+                (unsigned long)s->readings, (unsigned long)s->bad_lines, (unsigned long)s->ring.dropped);
+        break;
+    }
+    default: {
+        uint8_t scr = 0;
+        const MetricTiming* t = nth_drawn_screen(app, idx - METRICS_FIXED_LINES, &scr);
+        if(t)
+            fmt_timing(buf, n, screen_names[scr], t, "us");
+        else
+            buf[0] = 0;
+        break;
+    }
+    }
+}
+
+// ============================================================
+// Dump to SD
+// ============================================================
+#define METRICS_LINE_MAX 48
+
+// Main thread, app mutex held: the report as text, one snapshot for
+// the storage worker to write and free
+void metrics_dump(CoffeeApp* app) {
+    uint8_t count = metrics_line_count(app);
+    char* text = malloc((size_t)count * METRICS_LINE_MAX);
+    if(!text) return;
+    uint16_t len = 0;
+    for(uint8_t i = 0; i < count; i++) {
+        metrics_format_line(app, i, text + len, METRICS_LINE_MAX - 1);
+        len += strlen(text + len);
+        text[len++] = '\n';
+    }
+    StorageRequest req = {.op = StorageOpDumpMetrics, .data = (uint8_t*)text, .len = len};
+    storage_post(app, &req);
+}
+
+// Storage worker
+bool metrics_write(Storage* storage, const uint8_t* data, uint16_t len) {
+    storage_simply_mkdir(storage, APP_DATA_PATH(""));
+    File* file = storage_file_alloc(storage);
+    bool ok = false;
+    if(storage_file_open(file, METRICS_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS))
+        ok = storage_file_write(file, data, len) == len;
+    storage_file_close(file);
+    storage_file_free(file);
+    return ok;
+}
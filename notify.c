@@ -0,0 +1,155 @@
+#include "coffee_timer.h"
+
+#define NOTIFY_QUEUE_LEN 4
+#define NOTIFY_SEQ_MAX 24
+
+#define NOTIFY_FLAG_SOUND (1 << 0)
+#define NOTIFY_FLAG_LED   (1 << 1)
+
+typedef struct {
+    uint8_t event;
+    uint8_t flags;
+} NotifyMsg;
+
+// ============================================================
+// Sequence builder
+// ============================================================
+typedef struct {
+    const NotificationMessage* msg[NOTIFY_SEQ_MAX];
+    uint8_t len;
+} NotifySeq;
+
+static void seq_add(NotifySeq* q, const NotificationMessage* m) {
+    if(q->len < NOTIFY_SEQ_MAX - 1) q->msg[q->len++] = m;
+}
+
+// Vibro, sound and LED all start together and share the delays, so one
+// event costs a single pass through the notification service.
+static void seq_build(NotifySeq* q, NotifyEvent ev, uint8_t flags) {
+    bool snd = flags & NOTIFY_FLAG_SOUND;
+    bool led = flags & NOTIFY_FLAG_LED;
+    q->len = 0;
+
+    switch(ev) {
+    case NotifyStepDone:
+        seq_add(q, &message_vibro_on);
+        if(snd) seq_add(q, &message_note_c7);
+        if(led) seq_add(q, &message_red_255);
+        seq_add(q, &message_delay_50);
+        if(snd) seq_add(q, &message_sound_off);
+        if(led) seq_add(q, &message_red_0);
+        seq_add(q, &message_delay_50);
+        seq_add(q, &message_vibro_off);
+        if(led) {
+            seq_add(q, &message_red_255);
+            seq_add(q, &message_delay_50);
+            seq_add(q, &message_red_0);
+        }
+        break;
+    case NotifyBrewDone:
+        seq_add(q, &message_vibro_on);
+        if(snd) seq_add(q, &message_note_c7);
+        if(led) seq_add(q, &message_red_255);
+        seq_add(q, &message_delay_50);
+        if(led) seq_add(q, &message_red_0);
+        seq_add(q, &message_delay_50);
+        seq_add(q, &message_vibro_off);
+        if(snd) seq_add(q, &message_sound_off);
+        if(led) seq_add(q, &message_red_255);
+        seq_add(q, &message_delay_50);
+        if(led) seq_add(q, &message_red_0);
+        seq_add(q, &message_delay_50);
+        seq_add(q, &message_vibro_on);
+        if(snd) seq_add(q, &message_note_e7);
+        seq_add(q, &message_delay_100);
+        seq_add(q, &message_vibro_off);
+        if(snd) seq_add(q, &message_sound_off);
+        break;
+    case NotifyStepChange:
+        seq_add(q, &message_vibro_on);
+        if(led) seq_add(q, &message_green_255);
+        seq_add(q, &message_delay_100);
+        seq_add(q, &message_vibro_off);
+        if(led) seq_add(q, &message_green_0);
+        break;
+    case NotifyPaused:
+        if(!led) break;
+        seq_add(q, &message_red_255);
+        seq_add(q, &message_green_255);
+        seq_add(q, &message_delay_100);
+        seq_add(q, &message_red_0);
+        seq_add(q, &message_green_0);
+        break;
+    default:
+        break;
+    }
+    q->msg[q->len] = NULL;
+}
+
+// ============================================================
+// Worker
+// ============================================================
+// The backlight is a state, not an alert: each pass sets it to what
+// power.c last asked for, so a coalesced NotifyBacklight loses nothing
+static void backlight_apply(CoffeeApp* app, bool* held) {
+    bool want = __atomic_load_n(&app->power.backlight_held, __ATOMIC_ACQUIRE);
+    if(want == *held) return;
+    *held = want;
+    notification_message(
+        app->notif, want ? &sequence_display_backlight_enforce_on : &sequence_display_backlight_enforce_auto);
+}
+
+static int32_t notify_worker(void* ctx) {
+    CoffeeApp* app = ctx;
+    NotifySeq seq;
+    NotifyMsg m, next;
+    bool held = false;
+
+    while(true) {
+        if(furi_message_queue_get(app->notify_queue, &m, FuriWaitForever) != FuriStatusOk)
+            continue;
+        if(m.event == NotifyStop) break;
+
+        // Coalesce whatever piled up while the last sequence played:
+        // the strongest event wins, repeats of it are dropped.
+        bool stop = false;
+        while(furi_message_queue_get(app->notify_queue, &next, 0) == FuriStatusOk) {
+            if(next.event == NotifyStop) { stop = true; break; }
+            if(next.event > m.event) m = next;
+        }
+        if(stop) break;
+
+        backlight_apply(app, &held);
+        seq_build(&seq, (NotifyEvent)m.event, m.flags);
+        if(seq.len > 0)
+            notification_message_block(app->notif, (const NotificationSequence*)&seq.msg);
+    }
+    backlight_apply(app, &held);
+    return 0;
+}
+
+// ============================================================
+// Public API
+// ============================================================
+void notify_start(CoffeeApp* app) {
+    app->notify_queue = furi_message_queue_alloc(NOTIFY_QUEUE_LEN, sizeof(NotifyMsg));
+    app->notify_thread = furi_thread_alloc_ex("CoffeeNotify", 1024, notify_worker, app);
+    furi_thread_start(app->notify_thread);
+}
+
+void notify_stop(CoffeeApp* app) {
+    NotifyMsg m = {.event = NotifyStop, .flags = 0};
+    furi_message_queue_put(app->notify_queue, &m, FuriWaitForever);
+    furi_thread_join(app->notify_thread);
+    furi_thread_free(app->notify_thread);
+    furi_message_queue_free(app->notify_queue);
+}
+
+// Never blocks: safe from the timer callback and with the app mutex held.
+// A full queue already holds an alert for the user, so the extra one is dropped.
+void notify_post(CoffeeApp* app, NotifyEvent ev) {
+    NotifyMsg m = {.event = (uint8_t)ev, .flags = 0};
+    if(app->settings.sound_on) m.flags |= NOTIFY_FLAG_SOUND;
+    if(app->settings.led_on) m.flags |= NOTIFY_FLAG_LED;
+    furi_message_queue_put(app->notify_queue, &m, 0);
+}
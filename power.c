@@ -0,0 +1,55 @@
+#include "coffee_timer.h"
+
+// ============================================================
+// Display power policy
+// ============================================================
+// Run from the main loop with the app mutex held. type/dur_sec describe
+// the current brew step (StepTypeCount off the brewing screen).
+void power_update(CoffeeApp* app, StepType type, uint16_t dur_sec) {
+    AppPower* p = &app->power;
+    AppState* s = &app->s;
+    uint32_t now = furi_get_tick();
+
+    bool low = false;
+    if(s->screen == ScreenBrewing && s->timer_state == TimerRunning && !s->step_complete &&
+       !s->show_upcoming && type < StepTypeCount &&
+       (app->settings.power_save_types & (1u << type)) && dur_sec >= POWER_MIN_STEP_SEC &&
+       now - p->last_input >= POWER_IDLE_MS) {
+        uint32_t dur_ms = (uint32_t)dur_sec * 1000;
+        low = s->step_elapsed_ms + POWER_WAKE_SEC * 1000 < dur_ms;
+    }
+    if(low != p->low) {
+        p->low = low;
+        p->last_frame = now;
+    }
+
+    // The backlight stays lit through a brew unless the step is low power;
+    // releasing the lock hands it back to the system timeout
+    bool hold = !low && (s->screen == ScreenBrewing || s->screen == ScreenConfirmAbort ||
+                         s->screen == ScreenService);
+    if(hold != p->backlight_held) {
+        __atomic_store_n(&p->backlight_held, hold, __ATOMIC_RELEASE);
+        notify_post(app, NotifyBacklight);
+    }
+}
+
+// Any key brings back full rate; the system relights the backlight itself
+void power_wake(CoffeeApp* app) {
+    app->power.last_input = furi_get_tick();
+    app->power.low = false;
+}
+
+// Whether to redraw now: always at full rate, every POWER_FRAME_MS when low
+bool power_frame_due(CoffeeApp* app) {
+    AppPower* p = &app->power;
+    if(!p->low) return true;
+    uint32_t now = furi_get_tick();
+    if(now - p->last_frame < POWER_FRAME_MS) return false;
+    p->last_frame = now;
+    return true;
+}
+
+// Before notify_stop: the dispatcher hands the backlight back on its way out
+void power_release(CoffeeApp* app) {
+    __atomic_store_n(&app->power.backlight_held, false, __ATOMIC_RELEASE);
+}
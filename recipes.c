@@ -1,233 +1,445 @@
+// Generated by tools/gen_recipes.py from recipes.def. Do not edit.
+// 329 strings in 3170 bytes (4564 as separate literals)
 #include "coffee_timer.h"
 
+// ================================================================
+// STRINGS
+// ================================================================
+const char recipe_strings[] =
+    /*    0 */ "Insert filter, rinse, on mug\0"
+    /*   29 */ "Plunger on bottom, no filter\0"
+    /*   58 */ "When hissing/blonding starts\0"
+    /*   87 */ "Watch color, wait for blonde\0"
+    /*  116 */ "Rinse filter with hot water\0"
+    /*  144 */ "Fold filter, rinse, discard\0"
+    /*  172 */ "Screw top tight (use towel)\0"
+    /*  200 */ "Should flow like warm honey\0"
+    /*  228 */ "Pour 30ml, wet all grounds\0"
+    /*  255 */ "Stir top crust, scoop foam\0"
+    /*  282 */ "Cold towel on base to stop\0"
+    /*  309 */ "Remove when hissing starts\0"
+    /*  336 */ "Add 1000ml room temp water\0"
+    /*  363 */ "Strain through fine filter\0"
+    /*  390 */ "Mix 1:1 with water or milk\0"
+    /*  417 */ "50g medium-fine to dripper\0"
+    /*  444 */ "Attach cap, flip onto mug\0"
+    /*  470 */ "Very gentle press to hiss\0"
+    /*  496 */ "Add 60ml, wet all grounds\0"
+    /*  522 */ "Gentle swirl, flatten bed\0"
+    /*  548 */ "Wait, then swirl with ice\0"
+    /*  574 */ "Fill press with hot water\0"
+    /*  600 */ "Run base under cold water\0"
+    /*  626 */ "Screw on (towel for heat)\0"
+    /*  652 */ "Add 750ml room temp water\0"
+    /*  678 */ "Stir to fully wet grounds\0"
+    /*  704 */ "Create seal, don't press\0"
+    /*  729 */ "Short steep for strength\0"
+    /*  754 */ "Gentle back-and-forth x3\0"
+    /*  779 */ "Pour to 150ml in circles\0"
+    /*  804 */ "Pour to 250ml in circles\0"
+    /*  829 */ "15g med-fine, dig a well\0"
+    /*  854 */ "Pour to 200ml in circles\0"
+    /*  879 */ "Pour to 400ml in circles\0"
+    /*  904 */ "Pre-boil water in kettle\0"
+    /*  929 */ "100g coarse grind to jar\0"
+    /*  954 */ "150g coarse grind to jar\0"
+    /*  979 */ "300g ice in server below\0"
+    /* 1004 */ "Swirl to melt ice, serve\0"
+    /* 1029 */ "Stir vigorously 5 times\0"
+    /* 1053 */ "Filter in cap, no rinse\0"
+    /* 1077 */ "Press directly onto ice\0"
+    /* 1101 */ "Rinse filter thoroughly\0"
+    /* 1125 */ "Pour 50ml into the well\0"
+    /* 1149 */ "Swirl V60 to mix slurry\0"
+    /* 1173 */ "25g medium-coarse grind\0"
+    /* 1197 */ "Let level drop slightly\0"
+    /* 1221 */ "Stir gently to saturate\0"
+    /* 1245 */ "Hot water to valve line\0"
+    /* 1269 */ "Fill basket, don't tamp\0"
+    /* 1293 */ "Slow steady press ~30s\0"
+    /* 1316 */ "Fill mug with 100g ice\0"
+    /* 1339 */ "Plunger at 1, inverted\0"
+    /* 1362 */ "Wait for full drawdown\0"
+    /* 1385 */ "Pour to 250ml steadily\0"
+    /* 1408 */ "Put 100g ice in server\0"
+    /* 1431 */ "Do NOT stir, just wait\0"
+    /* 1454 */ "Fill basket, level off\0"
+    /* 1477 */ "Pour directly over ice\0"
+    /* 1500 */ "Stir to fully saturate\0"
+    /* 1523 */ "15g medium-fine grind\0"
+    /* 1545 */ "Stir well to saturate\0"
+    /* 1567 */ "20g medium-fine grind\0"
+    /* 1589 */ "Pour without pressing\0"
+    /* 1611 */ "Add 70ml, wet grounds\0"
+    /* 1633 */ "Medium heat, lid open\0"
+    /* 1655 */ "Coffee starts flowing\0"
+    /* 1677 */ "Hot water below valve\0"
+    /* 1699 */ "Stir in pot then pour\0"
+    /* 1721 */ "Seal jar, into fridge\0"
+    /* 1743 */ "100ml room temp water\0"
+    /* 1765 */ "Pour to 100ml slowly\0"
+    /* 1786 */ "Stir gently 3 times\0"
+    /* 1806 */ "Wait for extraction\0"
+    /* 1826 */ "Full immersion brew\0"
+    /* 1846 */ "Empty preheat water\0"
+    /* 1866 */ "Lowest heat setting\0"
+    /* 1886 */ "Fill glass with ice\0"
+    /* 1906 */ "Let it drip through\0"
+    /* 1926 */ "Gentle swirl, wait\0"
+    /* 1945 */ "Wait, do not touch\0"
+    /* 1964 */ "Screw top on tight\0"
+    /* 1983 */ "12-24hrs in fridge\0"
+    /* 2002 */ "16-24hrs in fridge\0"
+    /* 2021 */ "Wait for full drip\0"
+    /* 2040 */ "Add 200ml boiling\0"
+    /* 2058 */ "Let grounds degas\0"
+    /* 2076 */ "Slow steady press\0"
+    /* 2094 */ "Add 500ml boiling\0"
+    /* 2112 */ "Add 200ml at 85C\0"
+    /* 2129 */ "17g medium grind\0"
+    /* 2146 */ "Add 220ml at 90C\0"
+    /* 2163 */ "30g coarse grind\0"
+    /* 2180 */ "Attach cap, flip\0"
+    /* 2197 */ "15g medium grind\0"
+    /* 2214 */ "Wait ~3:30 total\0"
+    /* 2231 */ "Pour 50ml gently\0"
+    /* 2248 */ "Pour 40ml at 95C\0"
+    /* 2265 */ "Add 500ml at 93C\0"
+    /* 2282 */ "30g medium grind\0"
+    /* 2299 */ "Let fines settle\0"
+    /* 2316 */ "36g coarse grind\0"
+    /* 2333 */ "Add 430ml at 96C\0"
+    /* 2350 */ "100ml more water\0"
+    /* 2367 */ "Full extraction\0"
+    /* 2383 */ "11g fine grind\0"
+    /* 2398 */ "20g fine grind\0"
+    /* 2413 */ "Let CO2 escape\0"
+    /* 2428 */ "Add 200ml more\0"
+    /* 2443 */ "Slow 45s press\0"
+    /* 2458 */ "Pour to 150ml\0"
+    /* 2472 */ "Japanese Iced\0"
+    /* 2486 */ "Let it steep\0"
+    /* 2499 */ "120ml at 95C\0"
+    /* 2512 */ "V60 Hoffmann\0"
+    /* 2525 */ "Let it degas\0"
+    /* 2538 */ "French Press\0"
+    /* 2551 */ "Medium-Fine\0"
+    /* 2563 */ "Insert plgr\0"
+    /* 2575 */ "Iced Coffee\0"
+    /* 2587 */ "Competition\0"
+    /* 2599 */ "V60 Classic\0"
+    /* 2611 */ "Second pour\0"
+    /* 2623 */ "Break crust\0"
+    /* 2635 */ "Pour gently\0"
+    /* 2647 */ "Remove+cool\0"
+    /* 2659 */ "Pour on ice\0"
+    /* 2671 */ "Concentrate\0"
+    /* 2683 */ "Add coffee\0"
+    /* 2694 */ "Pour water\0"
+    /* 2705 */ "Swirl+wait\0"
+    /* 2716 */ "Bloom wait\0"
+    /* 2727 */ "First pour\0"
+    /* 2738 */ "Med-Coarse\0"
+    /* 2749 */ "Final pour\0"
+    /* 2760 */ "Boil water\0"
+    /* 2771 */ "Watch flow\0"
+    /* 2782 */ "Stir+serve\0"
+    /* 2793 */ "AeroPress\0"
+    /* 2803 */ "Pour rest\0"
+    /* 2813 */ "Pour Over\0"
+    /* 2823 */ "Main pour\0"
+    /* 2833 */ "Wait more\0"
+    /* 2843 */ "Fill base\0"
+    /* 2853 */ "Cool base\0"
+    /* 2863 */ "Iced Moka\0"
+    /* 2873 */ "Cold Brew\0"
+    /* 2883 */ "Add water\0"
+    /* 2893 */ "Standard\0"
+    /* 2902 */ "Inverted\0"
+    /* 2911 */ "Prep ice\0"
+    /* 2920 */ "Drawdown\0"
+    /* 2929 */ "Iced V60\0"
+    /* 2938 */ "Moka Pot\0"
+    /* 2947 */ "Assemble\0"
+    /* 2956 */ "Low heat\0"
+    /* 2965 */ "Lid open\0"
+    /* 2974 */ "Preheat\0"
+    /* 2982 */ "Discard\0"
+    /* 2990 */ "REPEAT\0"
+    /* 2997 */ "Repeat\0"
+    /* 3004 */ "Medium\0"
+    /* 3011 */ "Invert\0"
+    /* 3018 */ "Chemex\0"
+    /* 3025 */ "Strong\0"
+    /* 3032 */ "Remove\0"
+    /* 3039 */ "Filter\0"
+    /* 3046 */ "Dilute\0"
+    /* 3053 */ "PRESS\0"
+    /* 3059 */ "SWIRL\0"
+    /* 3065 */ "Swirl\0"
+    /* 3071 */ "Setup\0"
+    /* 3077 */ "Steep\0"
+    /* 3083 */ "Bloom\0"
+    /* 3089 */ "Pause\0"
+    /* 3095 */ "Watch\0"
+    /* 3101 */ "Cover\0"
+    /* 3107 */ "STIR\0"
+    /* 3112 */ "Stir\0"
+    /* 3117 */ "WAIT\0"
+    /* 3122 */ "Wait\0"
+    /* 3127 */ "FLIP\0"
+    /* 3132 */ "Flip\0"
+    /* 3137 */ "PREP\0"
+    /* 3142 */ "Prep\0"
+    /* 3147 */ "POUR\0"
+    /* 3152 */ "Pour\0"
+    /* 3157 */ "Heat\0"
+    /* 3162 */ "ADD\0"
+    /* 3166 */ "Add\0"
+    ;
+
+// ================================================================
+// STEP TYPES
+// ================================================================
+const StepTypeInfo step_types[StepTypeCount] = {
+    [StepAdd] = {3162, 3166, AdvanceChain},
+    [StepStir] = {3107, 3112, AdvanceChain},
+    [StepWait] = {3117, 3122, AdvanceArm},
+    [StepPress] = {3053, 2545, AdvanceConfirm},
+    [StepFlip] = {3127, 3132, AdvanceConfirm},
+    [StepPrep] = {3137, 3142, AdvanceConfirm},
+    [StepPour] = {3147, 3152, AdvanceChain},
+    [StepSwirl] = {3059, 3065, AdvanceChain},
+    [StepRepeat] = {2990, 2997, AdvanceConfirm},
+};
+
 // ================================================================
 // AEROPRESS
 // ================================================================
-static const BrewStep ap_standard_steps[] = {
-    {"Setup",       "Insert filter, rinse, on mug", 0,  0,  0, StepPrep},
-    {"Add coffee",  "15g medium-fine grind",        0, 15,  0, StepAdd},
-    {"Pour water",  "Add 200ml at 85C",            10,  0, 20, StepPour},
-    {"Stir",        "Stir gently 3 times",          5,  0,  0, StepStir},
-    {"Steep",       "Wait for extraction",         60,  0,  0, StepWait},
-    {"Press",       "Slow steady press ~30s",      30,  0,  0, StepPress},
-};
-static const BrewStep ap_inverted_steps[] = {
-    {"Invert",      "Plunger on bottom, no filter", 0,  0,  0, StepPrep},
-    {"Add coffee",  "17g medium grind",             0, 17,  0, StepAdd},
-    {"Pour water",  "Add 220ml at 90C",            10,  0, 22, StepPour},
-    {"Stir",        "Stir vigorously 5 times",     10,  0,  0, StepStir},
-    {"Steep",       "Full immersion brew",         90,  0,  0, StepWait},
-    {"Flip",        "Attach cap, flip onto mug",    0,  0,  0, StepFlip},
-    {"Press",       "Slow steady press ~30s",      30,  0,  0, StepPress},
-};
-static const BrewStep ap_hoffmann_steps[] = {
-    {"Setup",       "Filter in cap, no rinse",      0,  0,  0, StepPrep},
-    {"Add coffee",  "11g fine grind",               0, 11,  0, StepAdd},
-    {"Pour water",  "Add 200ml boiling",           10,  0, 20, StepPour},
-    {"Insert plgr", "Create seal, don't press",     0,  0,  0, StepWait},
-    {"Wait",        "Let it steep",               120,  0,  0, StepWait},
-    {"Swirl+wait",  "Gentle swirl, wait",          60,  0,  0, StepSwirl},
-    {"Press",       "Very gentle press to hiss",   30,  0,  0, StepPress},
-};
-static const BrewStep ap_iced_steps[] = {
-    {"Prep ice",    "Fill mug with 100g ice",       0,  0,  0, StepPrep},
-    {"Add coffee",  "20g fine grind",               0, 20,  0, StepAdd},
-    {"Pour water",  "120ml at 95C",                10,  0, 12, StepPour},
-    {"Stir",        "Stir well to saturate",       10,  0,  0, StepStir},
-    {"Steep",       "Short steep for strength",    45,  0,  0, StepWait},
-    {"Press",       "Press directly onto ice",     20,  0,  0, StepPress},
-};
-static const BrewStep ap_comp_steps[] = {
-    {"Invert",      "Plunger at 1, inverted",       0,  0,  0, StepPrep},
-    {"Add coffee",  "30g coarse grind",             0, 30,  0, StepAdd},
-    {"Bloom",       "Add 60ml, wet all grounds",   10,  0,  6, StepPour},
-    {"Bloom wait",  "Let CO2 escape",              30,  0,  0, StepWait},
-    {"Pour rest",   "Add 200ml more",              15,  0, 20, StepPour},
-    {"Stir",        "Gentle back-and-forth x3",     5,  0,  0, StepStir},
-    {"Flip",        "Attach cap, flip",             0,  0,  0, StepFlip},
-    {"Press",       "Slow 45s press",              45,  0,  0, StepPress},
+static const BrewStep aeropress_standard_steps[] = {
+    {3071,    0,   0,   0,   0, StepPrep, AdvanceDefault}, // Setup | Insert filter, rinse, on mug
+    {2683, 1523,   0,  15,   0, StepAdd, AdvanceDefault}, // Add coffee | 15g medium-fine grind
+    {2694, 2112,  10,   0,  20, StepPour, AdvanceDefault}, // Pour water | Add 200ml at 85C
+    {3112, 1786,   5,   0,   0, StepStir, AdvanceDefault}, // Stir | Stir gently 3 times
+    {3077, 1806,  60,   0,   0, StepWait, AdvanceDefault}, // Steep | Wait for extraction
+    {2545, 1293,  30,   0,   0, StepPress, AdvanceDefault}, // Press | Slow steady press ~30s
+};
+static const BrewStep aeropress_inverted_steps[] = {
+    {3011,   29,   0,   0,   0, StepPrep, AdvanceDefault}, // Invert | Plunger on bottom, no filter
+    {2683, 2129,   0,  17,   0, StepAdd, AdvanceDefault}, // Add coffee | 17g medium grind
+    {2694, 2146,  10,   0,  22, StepPour, AdvanceDefault}, // Pour water | Add 220ml at 90C
+    {3112, 1029,  10,   0,   0, StepStir, AdvanceDefault}, // Stir | Stir vigorously 5 times
+    {3077, 1826,  90,   0,   0, StepWait, AdvanceDefault}, // Steep | Full immersion brew
+    {3132,  444,   0,   0,   0, StepFlip, AdvanceDefault}, // Flip | Attach cap, flip onto mug
+    {2545, 1293,  30,   0,   0, StepPress, AdvanceDefault}, // Press | Slow steady press ~30s
+};
+static const BrewStep aeropress_hoffmann_steps[] = {
+    {3071, 1053,   0,   0,   0, StepPrep, AdvanceDefault}, // Setup | Filter in cap, no rinse
+    {2683, 2383,   0,  11,   0, StepAdd, AdvanceDefault}, // Add coffee | 11g fine grind
+    {2694, 2040,  10,   0,  20, StepPour, AdvanceDefault}, // Pour water | Add 200ml boiling
+    {2563,  704,   0,   0,   0, StepWait, AdvanceDefault}, // Insert plgr | Create seal, don't press
+    {3122, 2486, 120,   0,   0, StepWait, AdvanceDefault}, // Wait | Let it steep
+    {2705, 1926,  60,   0,   0, StepSwirl, AdvanceDefault}, // Swirl+wait | Gentle swirl, wait
+    {2545,  470,  30,   0,   0, StepPress, AdvanceDefault}, // Press | Very gentle press to hiss
+};
+static const BrewStep aeropress_iced_coffee_steps[] = {
+    {2911, 1316,   0,   0,   0, StepPrep, AdvanceDefault}, // Prep ice | Fill mug with 100g ice
+    {2683, 2398,   0,  20,   0, StepAdd, AdvanceDefault}, // Add coffee | 20g fine grind
+    {2694, 2499,  10,   0,  12, StepPour, AdvanceDefault}, // Pour water | 120ml at 95C
+    {3112, 1545,  10,   0,   0, StepStir, AdvanceDefault}, // Stir | Stir well to saturate
+    {3077,  729,  45,   0,   0, StepWait, AdvanceDefault}, // Steep | Short steep for strength
+    {2545, 1077,  20,   0,   0, StepPress, AdvanceDefault}, // Press | Press directly onto ice
+};
+static const BrewStep aeropress_competition_steps[] = {
+    {3011, 1339,   0,   0,   0, StepPrep, AdvanceDefault}, // Invert | Plunger at 1, inverted
+    {2683, 2163,   0,  30,   0, StepAdd, AdvanceDefault}, // Add coffee | 30g coarse grind
+    {3083,  496,  10,   0,   6, StepPour, AdvanceDefault}, // Bloom | Add 60ml, wet all grounds
+    {2716, 2413,  30,   0,   0, StepWait, AdvanceDefault}, // Bloom wait | Let CO2 escape
+    {2803, 2428,  15,   0,  20, StepPour, AdvanceDefault}, // Pour rest | Add 200ml more
+    {3112,  754,   5,   0,   0, StepStir, AdvanceDefault}, // Stir | Gentle back-and-forth x3
+    {3132, 2180,   0,   0,   0, StepFlip, AdvanceDefault}, // Flip | Attach cap, flip
+    {2545, 2443,  45,   0,   0, StepPress, AdvanceDefault}, // Press | Slow 45s press
 };
 static const Recipe aeropress_recipes[] = {
-    {"Standard",    "Medium-Fine", ap_standard_steps, 200,  85, 15, 6},
-    {"Inverted",    "Medium",      ap_inverted_steps, 220,  90, 17, 7},
-    {"Hoffmann",    "Fine",        ap_hoffmann_steps, 200, 100, 11, 7},
-    {"Iced Coffee", "Fine",        ap_iced_steps,     120,  95, 20, 6},
-    {"Competition", "Coarse",      ap_comp_steps,     260,  82, 30, 8},
+    {2893, 2551, aeropress_standard_steps, 200, 85, 15, 6}, // Standard
+    {2902, 3004, aeropress_inverted_steps, 220, 90, 17, 7}, // Inverted
+    {2516, 2558, aeropress_hoffmann_steps, 200, 100, 11, 7}, // Hoffmann
+    {2575, 2558, aeropress_iced_coffee_steps, 120, 95, 20, 6}, // Iced Coffee
+    {2587, 2742, aeropress_competition_steps, 260, 82, 30, 8}, // Competition
 };
 
 // ================================================================
 // POUR OVER
 // ================================================================
-static const BrewStep v60_classic_steps[] = {
-    {"Setup",       "Rinse filter with hot water",  0,  0,  0, StepPrep},
-    {"Add coffee",  "15g medium grind",             0, 15,  0, StepAdd},
-    {"Bloom",       "Pour 30ml, wet all grounds",   5,  0,  3, StepPour},
-    {"Bloom wait",  "Let grounds degas",           30,  0,  0, StepWait},
-    {"First pour",  "Pour to 150ml in circles",    30,  0, 12, StepPour},
-    {"Second pour", "Pour to 250ml in circles",    30,  0, 10, StepPour},
-    {"Drawdown",    "Wait for full drawdown",      60,  0,  0, StepWait},
-};
-static const BrewStep v60_hoffmann_steps[] = {
-    {"Setup",       "Rinse filter thoroughly",      0,  0,  0, StepPrep},
-    {"Add coffee",  "15g med-fine, dig a well",     0, 15,  0, StepAdd},
-    {"Bloom",       "Pour 50ml into the well",     10,  0,  5, StepPour},
-    {"Swirl",       "Swirl V60 to mix slurry",      0,  0,  0, StepSwirl},
-    {"Bloom wait",  "Let it degas",                35,  0,  0, StepWait},
-    {"Main pour",   "Pour to 250ml steadily",      30,  0, 20, StepPour},
-    {"Swirl",       "Gentle swirl, flatten bed",    0,  0,  0, StepSwirl},
-    {"Drawdown",    "Wait ~3:30 total",            90,  0,  0, StepWait},
-};
-static const BrewStep chemex_steps[] = {
-    {"Setup",       "Fold filter, rinse, discard",  0,  0,  0, StepPrep},
-    {"Add coffee",  "25g medium-coarse grind",      0, 25,  0, StepAdd},
-    {"Bloom",       "Pour 50ml gently",            10,  0,  5, StepPour},
-    {"Bloom wait",  "Let grounds degas",           30,  0,  0, StepWait},
-    {"First pour",  "Pour to 200ml in circles",    30,  0, 15, StepPour},
-    {"Pause",       "Let level drop slightly",     15,  0,  0, StepWait},
-    {"Final pour",  "Pour to 400ml in circles",    30,  0, 20, StepPour},
-    {"Drawdown",    "Wait for full drawdown",      90,  0,  0, StepWait},
-};
-static const BrewStep iced_v60_steps[] = {
-    {"Prep ice",    "Put 100g ice in server",       0,  0,  0, StepPrep},
-    {"Setup",       "Rinse filter with hot water",  0,  0,  0, StepPrep},
-    {"Add coffee",  "20g medium-fine grind",        0, 20,  0, StepAdd},
-    {"Bloom",       "Pour 40ml at 95C",             5,  0,  4, StepPour},
-    {"Bloom wait",  "Let grounds degas",           30,  0,  0, StepWait},
-    {"First pour",  "Pour to 100ml slowly",        25,  0,  6, StepPour},
-    {"Final pour",  "Pour to 150ml",               25,  0,  5, StepPour},
-    {"Drawdown",    "Wait, then swirl with ice",   60,  0,  0, StepWait},
-};
-static const Recipe pourover_recipes[] = {
-    {"V60 Classic",  "Medium",      v60_classic_steps,  250, 93, 15, 7},
-    {"V60 Hoffmann", "Medium-Fine", v60_hoffmann_steps, 250, 95, 15, 8},
-    {"Chemex",       "Med-Coarse",  chemex_steps,       400, 93, 25, 8},
-    {"Iced V60",     "Medium-Fine", iced_v60_steps,     150, 95, 20, 8},
+static const BrewStep pour_over_v60_classic_steps[] = {
+    {3071,  116,   0,   0,   0, StepPrep, AdvanceDefault}, // Setup | Rinse filter with hot water
+    {2683, 2197,   0,  15,   0, StepAdd, AdvanceDefault}, // Add coffee | 15g medium grind
+    {3083,  228,   5,   0,   3, StepPour, AdvanceDefault}, // Bloom | Pour 30ml, wet all grounds
+    {2716, 2058,  30,   0,   0, StepWait, AdvanceDefault}, // Bloom wait | Let grounds degas
+    {2727,  779,  30,   0,  12, StepPour, AdvanceDefault}, // First pour | Pour to 150ml in circles
+    {2611,  804,  30,   0,  10, StepPour, AdvanceDefault}, // Second pour | Pour to 250ml in circles
+    {2920, 1362,  60,   0,   0, StepWait, AdvanceDefault}, // Drawdown | Wait for full drawdown
+};
+static const BrewStep pour_over_v60_hoffmann_steps[] = {
+    {3071, 1101,   0,   0,   0, StepPrep, AdvanceDefault}, // Setup | Rinse filter thoroughly
+    {2683,  829,   0,  15,   0, StepAdd, AdvanceDefault}, // Add coffee | 15g med-fine, dig a well
+    {3083, 1125,  10,   0,   5, StepPour, AdvanceDefault}, // Bloom | Pour 50ml into the well
+    {3065, 1149,   0,   0,   0, StepSwirl, AdvanceDefault}, // Swirl | Swirl V60 to mix slurry
+    {2716, 2525,  35,   0,   0, StepWait, AdvanceDefault}, // Bloom wait | Let it degas
+    {2823, 1385,  30,   0,  20, StepPour, AdvanceDefault}, // Main pour | Pour to 250ml steadily
+    {3065,  522,   0,   0,   0, StepSwirl, AdvanceDefault}, // Swirl | Gentle swirl, flatten bed
+    {2920, 2214,  90,   0,   0, StepWait, AdvanceDefault}, // Drawdown | Wait ~3:30 total
+};
+static const BrewStep pour_over_chemex_steps[] = {
+    {3071,  144,   0,   0,   0, StepPrep, AdvanceDefault}, // Setup | Fold filter, rinse, discard
+    {2683, 1173,   0,  25,   0, StepAdd, AdvanceDefault}, // Add coffee | 25g medium-coarse grind
+    {3083, 2231,  10,   0,   5, StepPour, AdvanceDefault}, // Bloom | Pour 50ml gently
+    {2716, 2058,  30,   0,   0, StepWait, AdvanceDefault}, // Bloom wait | Let grounds degas
+    {2727,  854,  30,   0,  15, StepPour, AdvanceDefault}, // First pour | Pour to 200ml in circles
+    {3089, 1197,  15,   0,   0, StepWait, AdvanceDefault}, // Pause | Let level drop slightly
+    {2749,  879,  30,   0,  20, StepPour, AdvanceDefault}, // Final pour | Pour to 400ml in circles
+    {2920, 1362,  90,   0,   0, StepWait, AdvanceDefault}, // Drawdown | Wait for full drawdown
+};
+static const BrewStep pour_over_iced_v60_steps[] = {
+    {2911, 1408,   0,   0,   0, StepPrep, AdvanceDefault}, // Prep ice | Put 100g ice in server
+    {3071,  116,   0,   0,   0, StepPrep, AdvanceDefault}, // Setup | Rinse filter with hot water
+    {2683, 1567,   0,  20,   0, StepAdd, AdvanceDefault}, // Add coffee | 20g medium-fine grind
+    {3083, 2248,   5,   0,   4, StepPour, AdvanceDefault}, // Bloom | Pour 40ml at 95C
+    {2716, 2058,  30,   0,   0, StepWait, AdvanceDefault}, // Bloom wait | Let grounds degas
+    {2727, 1765,  25,   0,   6, StepPour, AdvanceDefault}, // First pour | Pour to 100ml slowly
+    {2749, 2458,  25,   0,   5, StepPour, AdvanceDefault}, // Final pour | Pour to 150ml
+    {2920,  548,  60,   0,   0, StepWait, AdvanceDefault}, // Drawdown | Wait, then swirl with ice
+};
+static const Recipe pour_over_recipes[] = {
+    {2599, 3004, pour_over_v60_classic_steps, 250, 93, 15, 7}, // V60 Classic
+    {2512, 2551, pour_over_v60_hoffmann_steps, 250, 95, 15, 8}, // V60 Hoffmann
+    {3018, 2738, pour_over_chemex_steps, 400, 93, 25, 8}, // Chemex
+    {2929, 2551, pour_over_iced_v60_steps, 150, 95, 20, 8}, // Iced V60
 };
 
 // ================================================================
 // FRENCH PRESS
 // ================================================================
-static const BrewStep fp_classic_steps[] = {
-    {"Preheat",     "Fill press with hot water",    0,  0,  0, StepPrep},
-    {"Discard",     "Empty preheat water",          0,  0,  0, StepPrep},
-    {"Add coffee",  "30g coarse grind",             0, 30,  0, StepAdd},
-    {"Pour water",  "Add 500ml at 93C",            15,  0, 50, StepPour},
-    {"Stir",        "Stir gently to saturate",      5,  0,  0, StepStir},
-    {"Steep",       "Wait, do not touch",         240,  0,  0, StepWait},
-    {"Press",       "Slow steady press",           20,  0,  0, StepPress},
-};
-static const BrewStep fp_hoffmann_steps[] = {
-    {"Preheat",     "Fill press with hot water",    0,  0,  0, StepPrep},
-    {"Discard",     "Empty preheat water",          0,  0,  0, StepPrep},
-    {"Add coffee",  "30g medium grind",             0, 30,  0, StepAdd},
-    {"Pour water",  "Add 500ml boiling",           15,  0, 50, StepPour},
-    {"Steep",       "Do NOT stir, just wait",     240,  0,  0, StepWait},
-    {"Break crust", "Stir top crust, scoop foam",  30,  0,  0, StepStir},
-    {"Wait more",   "Let fines settle",           300,  0,  0, StepWait},
-    {"Pour gently", "Pour without pressing",        0,  0,  0, StepPress},
-};
-static const BrewStep fp_strong_steps[] = {
-    {"Preheat",     "Fill press with hot water",    0,  0,  0, StepPrep},
-    {"Discard",     "Empty preheat water",          0,  0,  0, StepPrep},
-    {"Add coffee",  "36g coarse grind",             0, 36,  0, StepAdd},
-    {"Bloom",       "Add 70ml, wet grounds",       10,  0,  7, StepPour},
-    {"Bloom wait",  "Let CO2 escape",              30,  0,  0, StepWait},
-    {"Pour rest",   "Add 430ml at 96C",            15,  0, 43, StepPour},
-    {"Stir",        "Stir vigorously 5 times",      5,  0,  0, StepStir},
-    {"Steep",       "Full extraction",            300,  0,  0, StepWait},
-    {"Press",       "Slow steady press",           20,  0,  0, StepPress},
-};
-static const Recipe frenchpress_recipes[] = {
-    {"Classic",     "Coarse",  fp_classic_steps,  500, 93, 30, 7},
-    {"Hoffmann",    "Medium",  fp_hoffmann_steps, 500, 100, 30, 8},
-    {"Strong",      "Coarse",  fp_strong_steps,   500, 96, 36, 9},
+static const BrewStep french_press_classic_steps[] = {
+    {2974,  574,   0,   0,   0, StepPrep, AdvanceDefault}, // Preheat | Fill press with hot water
+    {2982, 1846,   0,   0,   0, StepPrep, AdvanceDefault}, // Discard | Empty preheat water
+    {2683, 2163,   0,  30,   0, StepAdd, AdvanceDefault}, // Add coffee | 30g coarse grind
+    {2694, 2265,  15,   0,  50, StepPour, AdvanceDefault}, // Pour water | Add 500ml at 93C
+    {3112, 1221,   5,   0,   0, StepStir, AdvanceDefault}, // Stir | Stir gently to saturate
+    {3077, 1945, 240,   0,   0, StepWait, AdvanceDefault}, // Steep | Wait, do not touch
+    {2545, 2076,  20,   0,   0, StepPress, AdvanceDefault}, // Press | Slow steady press
+};
+static const BrewStep french_press_hoffmann_steps[] = {
+    {2974,  574,   0,   0,   0, StepPrep, AdvanceDefault}, // Preheat | Fill press with hot water
+    {2982, 1846,   0,   0,   0, StepPrep, AdvanceDefault}, // Discard | Empty preheat water
+    {2683, 2282,   0,  30,   0, StepAdd, AdvanceDefault}, // Add coffee | 30g medium grind
+    {2694, 2094,  15,   0,  50, StepPour, AdvanceDefault}, // Pour water | Add 500ml boiling
+    {3077, 1431, 240,   0,   0, StepWait, AdvanceDefault}, // Steep | Do NOT stir, just wait
+    {2623,  255,  30,   0,   0, StepStir, AdvanceDefault}, // Break crust | Stir top crust, scoop foam
+    {2833, 2299, 300,   0,   0, StepWait, AdvanceDefault}, // Wait more | Let fines settle
+    {2635, 1589,   0,   0,   0, StepPress, AdvanceDefault}, // Pour gently | Pour without pressing
+};
+static const BrewStep french_press_strong_steps[] = {
+    {2974,  574,   0,   0,   0, StepPrep, AdvanceDefault}, // Preheat | Fill press with hot water
+    {2982, 1846,   0,   0,   0, StepPrep, AdvanceDefault}, // Discard | Empty preheat water
+    {2683, 2316,   0,  36,   0, StepAdd, AdvanceDefault}, // Add coffee | 36g coarse grind
+    {3083, 1611,  10,   0,   7, StepPour, AdvanceDefault}, // Bloom | Add 70ml, wet grounds
+    {2716, 2413,  30,   0,   0, StepWait, AdvanceDefault}, // Bloom wait | Let CO2 escape
+    {2803, 2333,  15,   0,  43, StepPour, AdvanceDefault}, // Pour rest | Add 430ml at 96C
+    {3112, 1029,   5,   0,   0, StepStir, AdvanceDefault}, // Stir | Stir vigorously 5 times
+    {3077, 2367, 300,   0,   0, StepWait, AdvanceDefault}, // Steep | Full extraction
+    {2545, 2076,  20,   0,   0, StepPress, AdvanceDefault}, // Press | Slow steady press
+};
+static const Recipe french_press_recipes[] = {
+    {2603, 2742, french_press_classic_steps, 500, 93, 30, 7}, // Classic
+    {2516, 3004, french_press_hoffmann_steps, 500, 100, 30, 8}, // Hoffmann
+    {3025, 2742, french_press_strong_steps, 500, 96, 36, 9}, // Strong
 };
 
 // ================================================================
 // MOKA POT
 // ================================================================
-static const BrewStep moka_classic_steps[] = {
-    {"Boil water",  "Pre-boil water in kettle",     0,  0,  0, StepPrep},
-    {"Fill base",   "Hot water to valve line",       0,  0, 20, StepAdd},
-    {"Add coffee",  "Fill basket, level off",        0, 15,  0, StepAdd},
-    {"Assemble",    "Screw top tight (use towel)",   0,  0,  0, StepPrep},
-    {"Heat",        "Medium heat, lid open",        60,  0,  0, StepWait},
-    {"Watch",       "Coffee starts flowing",        60,  0,  0, StepWait},
-    {"Remove",      "When hissing/blonding starts",  0,  0,  0, StepPrep},
-    {"Cool base",   "Run base under cold water",     0,  0,  0, StepPrep},
-};
-static const BrewStep moka_hoffmann_steps[] = {
-    {"Boil water",  "Pre-boil water in kettle",     0,  0,  0, StepPrep},
-    {"Fill base",   "Hot water below valve",         0,  0, 20, StepAdd},
-    {"Add coffee",  "Fill basket, don't tamp",       0, 15,  0, StepAdd},
-    {"Assemble",    "Screw on (towel for heat)",     0,  0,  0, StepPrep},
-    {"Low heat",    "Lowest heat setting",          45,  0,  0, StepWait},
-    {"Watch flow",  "Should flow like warm honey",  60,  0,  0, StepWait},
-    {"Lid open",    "Watch color, wait for blonde",  0,  0,  0, StepWait},
-    {"Remove+cool", "Cold towel on base to stop",    0,  0,  0, StepPrep},
-    {"Stir+serve",  "Stir in pot then pour",         0,  0,  0, StepStir},
-};
-static const BrewStep moka_iced_steps[] = {
-    {"Prep ice",    "Fill glass with ice",           0,  0,  0, StepPrep},
-    {"Boil water",  "Pre-boil water in kettle",     0,  0,  0, StepPrep},
-    {"Fill base",   "Hot water to valve line",       0,  0, 20, StepAdd},
-    {"Add coffee",  "Fill basket, level off",        0, 18,  0, StepAdd},
-    {"Assemble",    "Screw top on tight",            0,  0,  0, StepPrep},
-    {"Heat",        "Medium heat, lid open",        60,  0,  0, StepWait},
-    {"Watch",       "Remove when hissing starts",   60,  0,  0, StepWait},
-    {"Pour on ice", "Pour directly over ice",        0,  0,  0, StepPour},
-};
-static const Recipe moka_recipes[] = {
-    {"Classic",     "Fine",    moka_classic_steps,  200, 100, 15, 8},
-    {"Hoffmann",    "Fine",    moka_hoffmann_steps, 200, 100, 15, 9},
-    {"Iced Moka",   "Fine",    moka_iced_steps,     200, 100, 18, 8},
+static const BrewStep moka_pot_classic_steps[] = {
+    {2760,  904,   0,   0,   0, StepPrep, AdvanceDefault}, // Boil water | Pre-boil water in kettle
+    {2843, 1245,   0,   0,  20, StepAdd, AdvanceDefault}, // Fill base | Hot water to valve line
+    {2683, 1454,   0,  15,   0, StepAdd, AdvanceDefault}, // Add coffee | Fill basket, level off
+    {2947,  172,   0,   0,   0, StepPrep, AdvanceDefault}, // Assemble | Screw top tight (use towel)
+    {3157, 1633,  60,   0,   0, StepWait, AdvanceDefault}, // Heat | Medium heat, lid open
+    {3095, 1655,  60,   0,   0, StepWait, AdvanceDefault}, // Watch | Coffee starts flowing
+    {3032,   58,   0,   0,   0, StepPrep, AdvanceDefault}, // Remove | When hissing/blonding starts
+    {2853,  600,   0,   0,   0, StepPrep, AdvanceDefault}, // Cool base | Run base under cold water
+};
+static const BrewStep moka_pot_hoffmann_steps[] = {
+    {2760,  904,   0,   0,   0, StepPrep, AdvanceDefault}, // Boil water | Pre-boil water in kettle
+    {2843, 1677,   0,   0,  20, StepAdd, AdvanceDefault}, // Fill base | Hot water below valve
+    {2683, 1269,   0,  15,   0, StepAdd, AdvanceDefault}, // Add coffee | Fill basket, don't tamp
+    {2947,  626,   0,   0,   0, StepPrep, AdvanceDefault}, // Assemble | Screw on (towel for heat)
+    {2956, 1866,  45,   0,   0, StepWait, AdvanceDefault}, // Low heat | Lowest heat setting
+    {2771,  200,  60,   0,   0, StepWait, AdvanceDefault}, // Watch flow | Should flow like warm honey
+    {2965,   87,   0,   0,   0, StepWait, AdvanceDefault}, // Lid open | Watch color, wait for blonde
+    {2647,  282,   0,   0,   0, StepPrep, AdvanceDefault}, // Remove+cool | Cold towel on base to stop
+    {2782, 1699,   0,   0,   0, StepStir, AdvanceDefault}, // Stir+serve | Stir in pot then pour
+};
+static const BrewStep moka_pot_iced_moka_steps[] = {
+    {2911, 1886,   0,   0,   0, StepPrep, AdvanceDefault}, // Prep ice | Fill glass with ice
+    {2760,  904,   0,   0,   0, StepPrep, AdvanceDefault}, // Boil water | Pre-boil water in kettle
+    {2843, 1245,   0,   0,  20, StepAdd, AdvanceDefault}, // Fill base | Hot water to valve line
+    {2683, 1454,   0,  18,   0, StepAdd, AdvanceDefault}, // Add coffee | Fill basket, level off
+    {2947, 1964,   0,   0,   0, StepPrep, AdvanceDefault}, // Assemble | Screw top on tight
+    {3157, 1633,  60,   0,   0, StepWait, AdvanceDefault}, // Heat | Medium heat, lid open
+    {3095,  309,  60,   0,   0, StepWait, AdvanceDefault}, // Watch | Remove when hissing starts
+    {2659, 1477,   0,   0,   0, StepPour, AdvanceDefault}, // Pour on ice | Pour directly over ice
+};
+static const Recipe moka_pot_recipes[] = {
+    {2603, 2558, moka_pot_classic_steps, 200, 100, 15, 8}, // Classic
+    {2516, 2558, moka_pot_hoffmann_steps, 200, 100, 15, 9}, // Hoffmann
+    {2863, 2558, moka_pot_iced_moka_steps, 200, 100, 18, 8}, // Iced Moka
 };
 
 // ================================================================
 // COLD BREW
 // ================================================================
-static const BrewStep cb_standard_steps[] = {
-    {"Add coffee",  "100g coarse grind to jar",      0,100,  0, StepAdd},
-    {"Add water",   "Add 1000ml room temp water",    0,  0,100, StepPour},
-    {"Stir",        "Stir to fully saturate",       15,  0,  0, StepStir},
-    {"Cover",       "Seal jar, into fridge",         0,  0,  0, StepPrep},
-    {"Steep",       "12-24hrs in fridge",             0,  0,  0, StepWait},
-    {"Filter",      "Strain through fine filter",    0,  0,  0, StepPrep},
-};
-static const BrewStep cb_concentrate_steps[] = {
-    {"Add coffee",  "150g coarse grind to jar",      0,150,  0, StepAdd},
-    {"Add water",   "Add 750ml room temp water",     0,  0, 75, StepPour},
-    {"Stir",        "Stir to fully wet grounds",    15,  0,  0, StepStir},
-    {"Cover",       "Seal jar, into fridge",         0,  0,  0, StepPrep},
-    {"Steep",       "16-24hrs in fridge",             0,  0,  0, StepWait},
-    {"Filter",      "Strain through fine filter",    0,  0,  0, StepPrep},
-    {"Dilute",      "Mix 1:1 with water or milk",    0,  0,  0, StepPrep},
-};
-static const BrewStep cb_japanese_steps[] = {
-    {"Add coffee",  "50g medium-fine to dripper",    0, 50,  0, StepAdd},
-    {"Prep ice",    "300g ice in server below",      0,  0,  0, StepPrep},
-    {"First pour",  "100ml room temp water",        10,  0, 10, StepPour},
-    {"Wait",        "Let it drip slowly",           60,  0,  0, StepWait},
-    {"Second pour", "100ml more water",             10,  0, 10, StepPour},
-    {"Wait",        "Let it drip through",          60,  0,  0, StepWait},
-    {"Final pour",  "100ml more water",             10,  0, 10, StepPour},
-    {"Drawdown",    "Wait for full drip",           90,  0,  0, StepWait},
-    {"Swirl",       "Swirl to melt ice, serve",      0,  0,  0, StepSwirl},
-};
-static const Recipe coldbrew_recipes[] = {
-    {"Standard",      "Coarse",      cb_standard_steps,    1000, 20, 100, 6},
-    {"Concentrate",   "Coarse",      cb_concentrate_steps,  750, 20, 150, 7},
-    {"Japanese Iced", "Medium-Fine", cb_japanese_steps,     300, 20,  50, 9},
+static const BrewStep cold_brew_standard_steps[] = {
+    {2683,  929,   0, 100,   0, StepAdd, AdvanceDefault}, // Add coffee | 100g coarse grind to jar
+    {2883,  336,   0,   0, 100, StepPour, AdvanceDefault}, // Add water | Add 1000ml room temp water
+    {3112, 1500,  15,   0,   0, StepStir, AdvanceDefault}, // Stir | Stir to fully saturate
+    {3101, 1721,   0,   0,   0, StepPrep, AdvanceDefault}, // Cover | Seal jar, into fridge
+    {3077, 1983,   0,   0,   0, StepWait, AdvanceDefault}, // Steep | 12-24hrs in fridge
+    {3039,  363,   0,   0,   0, StepPrep, AdvanceDefault}, // Filter | Strain through fine filter
+};
+static const BrewStep cold_brew_concentrate_steps[] = {
+    {2683,  954,   0, 150,   0, StepAdd, AdvanceDefault}, // Add coffee | 150g coarse grind to jar
+    {2883,  652,   0,   0,  75, StepPour, AdvanceDefault}, // Add water | Add 750ml room temp water
+    {3112,  678,  15,   0,   0, StepStir, AdvanceDefault}, // Stir | Stir to fully wet grounds
+    {3101, 1721,   0,   0,   0, StepPrep, AdvanceDefault}, // Cover | Seal jar, into fridge
+    {3077, 2002,   0,   0,   0, StepWait, AdvanceDefault}, // Steep | 16-24hrs in fridge
+    {3039,  363,   0,   0,   0, StepPrep, AdvanceDefault}, // Filter | Strain through fine filter
+    {3046,  390,   0,   0,   0, StepPrep, AdvanceDefault}, // Dilute | Mix 1:1 with water or milk
+};
+static const BrewStep cold_brew_japanese_iced_steps[] = {
+    {2683,  417,   0,  50,   0, StepAdd, AdvanceDefault}, // Add coffee | 50g medium-fine to dripper
+    {2911,  979,   0,   0,   0, StepPrep, AdvanceDefault}, // Prep ice | 300g ice in server below
+    {2997,   28,   2,   2,   0, StepRepeat, AdvanceDefault}, // repeat next 2 x2
+    {3152, 1743,  10,   0,  10, StepPour, AdvanceDefault}, // Pour | 100ml room temp water
+    {3122, 1906,  60,   0,   0, StepWait, AdvanceDefault}, // Wait | Let it drip through
+    {2749, 2350,  10,   0,  10, StepPour, AdvanceDefault}, // Final pour | 100ml more water
+    {2920, 2021,  90,   0,   0, StepWait, AdvanceDefault}, // Drawdown | Wait for full drip
+    {3065, 1004,   0,   0,   0, StepSwirl, AdvanceDefault}, // Swirl | Swirl to melt ice, serve
+};
+static const Recipe cold_brew_recipes[] = {
+    {2893, 2742, cold_brew_standard_steps, 1000, 20, 100, 6}, // Standard
+    {2671, 2742, cold_brew_concentrate_steps, 750, 20, 150, 7}, // Concentrate
+    {2472, 2551, cold_brew_japanese_iced_steps, 300, 20, 50, 8}, // Japanese Iced
 };
 
 // ================================================================
 // METHODS
 // ================================================================
 const BrewMethod methods[] = {
-    {"AeroPress",    aeropress_recipes,   5},
-    {"Pour Over",    pourover_recipes,    4},
-    {"French Press", frenchpress_recipes, 3},
-    {"Moka Pot",     moka_recipes,        3},
-    {"Cold Brew",    coldbrew_recipes,    3},
+    {2793, aeropress_recipes, 5}, // AeroPress
+    {2813, pour_over_recipes, 4}, // Pour Over
+    {2538, french_press_recipes, 3}, // French Press
+    {2938, moka_pot_recipes, 3}, // Moka Pot
+    {2873, cold_brew_recipes, 3}, // Cold Brew
 };
 const uint8_t method_count = sizeof(methods) / sizeof(methods[0]);
@@ -0,0 +1,326 @@
+#include "coffee_timer.h"
+#include <expansion/expansion.h>
+#include <furi_hal_serial_control.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================
+// Ring
+// ============================================================
+static void ring_put(SensorRing* r, uint8_t b) {
+    uint32_t head = r->head;
+    if(head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) >= SENSOR_RING_SIZE) {
+        r->dropped++;
+        return;
+    }
+    r->buf[head & (SENSOR_RING_SIZE - 1)] = b;
+    __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+}
+
+static bool ring_get(SensorRing* r, uint8_t* b) {
+    uint32_t tail = r->tail;
+    if(__atomic_load_n(&r->head, __ATOMIC_ACQUIRE) == tail) return false;
+    *b = r->buf[tail & (SENSOR_RING_SIZE - 1)];
+    __atomic_store_n(&r->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+// ============================================================
+// Parsing, shared with the host tools
+// ============================================================
+// The first number in a scale's line, in 0.1 g: "ST,GS,+  12.34 g",
+// "-0.5g", "W 1.250kg". Grams unless "kg" follows; oz and lb lines
+// are refused.
+bool sensor_parse(const char* line, int32_t* dg) {
+    const char* p = line;
+    while(*p && (*p < '0' || *p > '9')) p++;
+    if(!*p) return false;
+    const char* q = p;
+    while(q > line && q[-1] == ' ') q--;
+    bool neg = q > line && q[-1] == '-';
+
+    int64_t v = 0;          // 0.0001 units
+    uint8_t digits = 0;
+    for(; *p >= '0' && *p <= '9'; p++)
+        if(digits++ < 6) v = v * 10 + (*p - '0');
+    v *= 10000;
+    if(*p == '.') {
+        int64_t place = 1000;
+        for(p++; *p >= '0' && *p <= '9'; p++, place /= 10) v += (*p - '0') * place;
+    }
+    while(*p == ' ') p++;
+    if(*p == 'o' || *p == 'l') return false;
+    if(*p != 'k') v = (v + 500) / 1000;     // g: 0.0001 g -> 0.1 g; kg: already 0.1 g
+    *dg = (int32_t)(neg ? -v : v);
+    return true;
+}
+
+static int32_t median3(int32_t a, int32_t b, int32_t c) {
+    if(a > b) {
+        int32_t t = a;
+        a = b;
+        b = t;
+    }
+    return c < a ? a : c > b ? b : c;
+}
+
+// ============================================================
+// Readings (main thread, app mutex held)
+// ============================================================
+// Readings go in as grams; a steady weight only often enough to keep
+// a replay from going stale
+static void record_reading(AppSensor* s, int32_t x, uint32_t now) {
+    if(!s->rec) return;
+    if(s->rec_len > 0 && x == s->rec_last && now - s->rec_tick < SENSOR_STALE_MS / 2) return;
+    int32_t a = x < 0 ? -x : x;
+    int n = snprintf(s->rec + s->rec_len, SENSOR_TRACE_MAX - s->rec_len, "%lu %s%ld.%ld\n",
+        (unsigned long)(now - s->tare_tick), x < 0 ? "-" : "", (long)(a / 10), (long)(a % 10));
+    if(n <= 0 || s->rec_len + n >= SENSOR_TRACE_MAX) return;
+    s->rec_len += (uint16_t)n;
+    s->rec_last = x;
+    s->rec_tick = now;
+}
+
+// A spike from a bumped scale is dropped by the median of three; the
+// running average (1/4 per reading) smooths what is left
+static void take_line(AppSensor* s, const char* line, uint32_t now) {
+    int32_t x;
+    if(!sensor_parse(line, &x)) {
+        s->bad_lines++;
+        return;
+    }
+    record_reading(s, x, now);
+    bool fresh = s->raw_count == 0 || now - s->last_tick >= SENSOR_STALE_MS;
+    if(fresh) s->raw_count = 0;
+    s->raw[s->raw_next] = x;
+    s->raw_next = (s->raw_next + 1) % 3;
+    if(s->raw_count < 3) s->raw_count++;
+    int32_t med = s->raw_count < 3 ? x : median3(s->raw[0], s->raw[1], s->raw[2]);
+
+    s->weight = fresh ? med : s->weight + (med - s->weight) / 4;
+    if(s->tare_pending) {
+        s->tare = s->weight;
+        s->tare_pending = false;
+    }
+    if(fresh) {
+        s->flow = 0;
+        s->flow_ref = s->weight;
+        s->flow_tick = now;
+    } else if(now - s->flow_tick >= SENSOR_FLOW_MS) {
+        s->flow = (s->weight - s->flow_ref) * 1000 / (int32_t)(now - s->flow_tick);
+        s->flow_ref = s->weight;
+        s->flow_tick = now;
+    }
+    s->last_tick = now;
+    s->readings++;
+}
+
+// Trace source: pushes the records whose time has come
+static void trace_feed(AppSensor* s, uint32_t now) {
+    if(!s->trace || s->trace_loading || !s->playing) return;
+    uint32_t at = now - s->tare_tick;
+    while(s->trace_pos < s->trace_len) {
+        const char* rec = s->trace + s->trace_pos;
+        char* body;
+        if(strtoul(rec, &body, 10) > at) break;
+        const char* nl = strchr(body, '\n');
+        const char* end = nl ? nl : s->trace + s->trace_len;
+        for(const char* c = body; c < end; c++) ring_put(&s->ring, (uint8_t)*c);
+        ring_put(&s->ring, '\n');
+        s->trace_pos = (size_t)(end - s->trace) + (nl ? 1 : 0);
+    }
+}
+
+// Hands this brew's recording to the storage worker
+static void record_save(CoffeeApp* app) {
+    AppSensor* s = &app->sensor;
+    if(!s->rec) return;
+    if(s->rec_len == 0) {
+        free(s->rec);
+    } else {
+        StorageRequest req = {.op = StorageOpSaveScaleTrace, .data = (uint8_t*)s->rec, .len = s->rec_len};
+        storage_post(app, &req);
+    }
+    s->rec = NULL;
+    s->rec_len = 0;
+}
+
+// Drains the ring into the filtered weight. Out of a brew the trace
+// stops and the recording is saved.
+void sensor_poll(CoffeeApp* app, bool brewing) {
+    AppSensor* s = &app->sensor;
+    if(s->source == SensorOff) return;
+    uint32_t now = furi_get_tick();
+    if(!brewing) {
+        s->playing = false;
+        record_save(app);
+    }
+    if(s->source == SensorTrace) trace_feed(s, now);
+
+    uint8_t b;
+    while(ring_get(&s->ring, &b)) {
+        if(b != '\n' && b != '\r') {
+            if(s->line_len + 1 < SENSOR_LINE_MAX) s->line[s->line_len++] = (char)b;
+            else s->overlong = true;
+            continue;
+        }
+        s->line[s->line_len] = '\0';
+        if(s->overlong) s->bad_lines++;
+        else if(s->line_len > 0) take_line(s, s->line, now);
+        s->line_len = 0;
+        s->overlong = false;
+    }
+}
+
+// Brew start: the next reading is zero, and a trace plays from here
+void sensor_tare(CoffeeApp* app) {
+    AppSensor* s = &app->sensor;
+    if(s->source == SensorOff) return;
+    record_save(app);
+    s->tare_pending = true;
+    s->raw_count = 0;
+    s->step = UINT8_MAX;
+    s->below = false;
+    s->tare_tick = furi_get_tick();
+    if(!s->trace_loading) s->trace_pos = 0;
+    s->playing = true;
+    if(s->source == SensorUart) {
+        s->rec = malloc(SENSOR_TRACE_MAX);
+        s->rec_len = 0;
+    }
+}
+
+bool sensor_live(const AppSensor* s, uint32_t now) {
+    return s->source != SensorOff && s->raw_count > 0 && !s->tare_pending &&
+           now - s->last_tick < SENSOR_STALE_MS;
+}
+
+int32_t sensor_poured(const AppSensor* s) {
+    return s->weight - s->tare;
+}
+
+const char* sensor_source_name(SensorSource source) {
+    switch(source) {
+    case SensorUart:  return "uart";
+    case SensorTrace: return "trace";
+    default:          return "off";
+    }
+}
+
+// ============================================================
+// Sources
+// ============================================================
+// Runs in the UART interrupt, one byte per call
+static void sensor_rx(FuriHalSerialHandle* handle, FuriHalSerialRxEvent event, void* ctx) {
+    AppSensor* s = ctx;
+    if(event & FuriHalSerialRxEventData) ring_put(&s->ring, furi_hal_serial_async_rx(handle));
+}
+
+// The trace is read by the storage worker; it plays once loaded
+bool sensor_start(CoffeeApp* app, SensorSource source) {
+    AppSensor* s = &app->sensor;
+    if(s->source == source) return true;
+    sensor_stop(app);
+    s->ring.head = s->ring.tail = 0;
+    s->line_len = 0;
+    s->overlong = false;
+    s->raw_count = 0;
+    s->playing = false;
+
+    if(source == SensorUart) {
+        // An expansion module would hold the same pins
+        Expansion* expansion = furi_record_open(RECORD_EXPANSION);
+        expansion_disable(expansion);
+        furi_record_close(RECORD_EXPANSION);
+        s->serial = furi_hal_serial_control_acquire(FuriHalSerialIdUsart);
+        if(!s->serial) {
+            expansion = furi_record_open(RECORD_EXPANSION);
+            expansion_enable(expansion);
+            furi_record_close(RECORD_EXPANSION);
+            FURI_LOG_E(COFFEE_TIMER_TAG, "Scale UART busy");
+            return false;
+        }
+        furi_hal_serial_init(s->serial, SENSOR_BAUD);
+        furi_hal_serial_async_rx_start(s->serial, sensor_rx, s, false);
+    } else if(source == SensorTrace && !s->trace_loading) {
+        s->trace_loading = true;
+        StorageRequest req = {.op = StorageOpLoadScaleTrace};
+        storage_post(app, &req);
+    }
+    s->source = source;
+    return true;
+}
+
+void sensor_stop(CoffeeApp* app) {
+    AppSensor* s = &app->sensor;
+    if(s->source == SensorUart) {
+        furi_hal_serial_async_rx_stop(s->serial);
+        furi_hal_serial_deinit(s->serial);
+        furi_hal_serial_control_release(s->serial);
+        s->serial = NULL;
+        Expansion* expansion = furi_record_open(RECORD_EXPANSION);
+        expansion_enable(expansion);
+        furi_record_close(RECORD_EXPANSION);
+    }
+    record_save(app);
+    // A load in flight still owns the buffer; its completion frees it
+    if(!s->trace_loading) {
+        free(s->trace);
+        s->trace = NULL;
+    }
+    s->source = SensorOff;
+    s->playing = false;
+}
+
+void sensor_trace_loaded(CoffeeApp* app, bool ok) {
+    AppSensor* s = &app->sensor;
+    s->trace_loading = false;
+    if(!ok) FURI_LOG_E(COFFEE_TIMER_TAG, "No scale trace to replay");
+    if(s->source != SensorTrace) {
+        free(s->trace);
+        s->trace = NULL;
+    }
+}
+
+// ============================================================
+// Storage worker side
+// ============================================================
+bool sensor_trace_write(Storage* storage, const uint8_t* data, uint16_t len) {
+    storage_simply_mkdir(storage, APP_DATA_PATH(""));
+    File* file = storage_file_alloc(storage);
+    bool ok = false;
+    if(storage_file_open(file, SENSOR_TRACE_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS))
+        ok = storage_file_write(file, data, len) == len;
+    storage_file_close(file);
+    storage_file_free(file);
+    return ok;
+}
+
+// Fills app->sensor.trace; the main thread keeps out until the completion
+bool sensor_trace_load(CoffeeApp* app) {
+    AppSensor* s = &app->sensor;
+    char* buf = malloc(SENSOR_TRACE_MAX + 1);
+    if(!buf) return false;
+
+    File* file = storage_file_alloc(app->storage);
+    size_t len = 0;
+    if(storage_file_open(file, SENSOR_TRACE_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        uint16_t n;
+        while(len < SENSOR_TRACE_MAX &&
+              (n = storage_file_read(file, buf + len, (uint16_t)(SENSOR_TRACE_MAX - len))) > 0)
+            len += n;
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+
+    if(len == 0) {
+        free(buf);
+        return false;
+    }
+    buf[len] = '\0';
+    free(s->trace);
+    s->trace = buf;
+    s->trace_len = len;
+    s->trace_pos = 0;
+    return true;
+}
@@ -0,0 +1,273 @@
+#include "coffee_timer.h"
+#include <string.h>
+
+// ============================================================
+// Step model
+// ============================================================
+// Only a timed wait runs without the barista; a brew's first step is
+// always theirs, since someone has to start it
+static bool hands_free(const ServiceBrew* b, uint8_t i) {
+    return i > 0 && b->type[i] == StepWait && b->dur[i] > 0;
+}
+
+static int32_t hands_ms(const ServiceBrew* b, uint8_t i) {
+    return (int32_t)(b->dur[i] > 0 ? b->dur[i] : SERVICE_MANUAL_SEC) * 1000;
+}
+
+// Waits from step up; returns their length and moves step past them
+static int32_t skip_waits(const ServiceBrew* b, uint8_t* step) {
+    int32_t ms = 0;
+    while(*step < b->step_count && hands_free(b, *step)) ms += b->dur[(*step)++] * 1000;
+    return ms;
+}
+
+// ============================================================
+// Planner: one simulated barista, times in ms from now
+// ============================================================
+typedef struct {
+    uint8_t step;
+    bool started;
+    bool waited;            // ready is the end of a wait
+    int32_t ready;
+} SimBrew;
+
+typedef struct {
+    int8_t first;           // opening move, -1 if none
+    int32_t idle;           // time before it
+    int32_t late;           // worst step start after its wait ended
+} SimOut;
+
+static int32_t simulate(
+    const AppService* sv, const uint8_t* order, SimBrew* sim, int8_t last, int32_t t, SimOut* out);
+
+// Dry run of the brews already going, optionally with brew i started
+// now; returns how late the worst step after a wait would be
+static int32_t lateness(const AppService* sv, const SimBrew* sim, int8_t last, int32_t t, int8_t i) {
+    SimBrew dry[SERVICE_MAX_BREWS];
+    memcpy(dry, sim, sv->count * sizeof(SimBrew));
+    if(i >= 0) {
+        dry[i].started = true;
+        dry[i].ready = t;
+        last = i;
+    }
+    SimOut out;
+    simulate(sv, NULL, dry, last, t, &out);
+    return out.late;
+}
+
+// Greedy list schedule. The brew in hand keeps the barista until its
+// next wait; then a brew whose wait is over goes, the most overdue one
+// first; otherwise the next brew in order starts, if that makes no wait
+// run over by more than SERVICE_LATE_SEC (or any more than it already
+// will). A NULL order starts nothing new. Returns when the last brew
+// finishes.
+static int32_t simulate(
+    const AppService* sv, const uint8_t* order, SimBrew* sim, int8_t last, int32_t t, SimOut* out) {
+    int32_t t0 = t, end = t;
+    out->first = -1;
+    out->idle = 0;
+    out->late = 0;
+    for(;;) {
+        int8_t pick = -1;
+        int32_t due = INT32_MAX;
+        for(uint8_t i = 0; i < sv->count; i++) {
+            const SimBrew* sb = &sim[i];
+            if(!sb->started || sb->step >= sv->brew[i].step_count) continue;
+            if(sb->ready <= t && (pick < 0 || sb->ready < sim[pick].ready)) pick = (int8_t)i;
+            if(sb->ready < due) due = sb->ready;
+        }
+        if(last >= 0 && sim[last].step < sv->brew[last].step_count && sim[last].ready <= t)
+            pick = last;
+        for(uint8_t k = 0; pick < 0 && order && k < sv->count; k++) {
+            uint8_t i = order[k];
+            if(sim[i].started) continue;
+            int32_t base = due == INT32_MAX ? 0 : lateness(sv, sim, last, t, -1);
+            if(base < SERVICE_LATE_SEC * 1000) base = SERVICE_LATE_SEC * 1000;
+            if(due == INT32_MAX || lateness(sv, sim, last, t, (int8_t)i) <= base) pick = (int8_t)i;
+            break;
+        }
+        if(pick < 0) {
+            if(due == INT32_MAX) break;
+            t = due;    // nothing fits: stand by for the next wait to end
+            continue;
+        }
+        if(out->first < 0) {
+            out->first = pick;
+            out->idle = t - t0;
+        }
+        const ServiceBrew* b = &sv->brew[pick];
+        SimBrew* sb = &sim[pick];
+        if(sb->waited && t - sb->ready > out->late) out->late = t - sb->ready;
+        last = pick;
+        sb->started = true;
+        t += hands_ms(b, sb->step++);
+        int32_t wait = skip_waits(b, &sb->step);
+        sb->ready = t + wait;
+        sb->waited = wait > 0;
+        if(sb->ready > end) end = sb->ready;
+    }
+    return end > t ? end : t;
+}
+
+// The live session as the planner sees it; the step in hand counts as
+// done when it is due to be
+static int32_t sim_from_live(const AppService* sv, uint32_t now, SimBrew* sim) {
+    int32_t busy = 0;
+    for(uint8_t i = 0; i < sv->count; i++) {
+        const ServiceBrew* b = &sv->brew[i];
+        sim[i].step = b->step;
+        sim[i].started = b->started;
+        sim[i].ready = b->started ? (int32_t)(b->ready - now) : 0;
+        sim[i].waited = b->started && !b->alerted;
+    }
+    if(sv->act >= 0) {
+        const ServiceBrew* b = &sv->brew[sv->act];
+        SimBrew* sb = &sim[sv->act];
+        busy = (int32_t)(sv->act_started - now) + hands_ms(b, sb->step);
+        if(busy < 0) busy = 0;
+        sb->started = true;
+        sb->step++;
+        int32_t wait = skip_waits(b, &sb->step);
+        sb->ready = busy + wait;
+        sb->waited = wait > 0;
+    }
+    return busy;
+}
+
+static bool next_permutation(uint8_t* p, uint8_t n) {
+    int i = n - 2;
+    while(i >= 0 && p[i] >= p[i + 1]) i--;
+    if(i < 0) return false;
+    int j = n - 1;
+    while(p[j] <= p[i]) j--;
+    uint8_t t = p[i];
+    p[i] = p[j];
+    p[j] = t;
+    for(int a = i + 1, z = n - 1; a < z; a++, z--) {
+        t = p[a];
+        p[a] = p[z];
+        p[z] = t;
+    }
+    return true;
+}
+
+// Tries every start order (24 at most) and keeps the quickest; ties go
+// to queue order
+void service_plan(AppService* sv) {
+    uint8_t order[SERVICE_MAX_BREWS];
+    SimBrew sim[SERVICE_MAX_BREWS];
+    SimOut out;
+    int32_t best = INT32_MAX;
+    for(uint8_t i = 0; i < sv->count; i++) order[i] = i;
+    do {
+        memset(sim, 0, sizeof(sim));
+        int32_t end = simulate(sv, order, sim, -1, 0, &out);
+        if(end < best) {
+            best = end;
+            memcpy(sv->order, order, sv->count);
+        }
+    } while(next_permutation(order, sv->count));
+    sv->plan_sec = sv->count ? (uint32_t)(best + 999) / 1000 : 0;
+
+    uint32_t serial = 0;
+    for(uint8_t i = 0; i < sv->count; i++) {
+        const ServiceBrew* b = &sv->brew[i];
+        for(uint8_t k = 0; k < b->step_count; k++)
+            serial += hands_free(b, k) ? b->dur[k] * 1000U : (uint32_t)hands_ms(b, k);
+    }
+    sv->serial_sec = (serial + 999) / 1000;
+}
+
+// ============================================================
+// Live session (main thread, app mutex held)
+// ============================================================
+void service_start(AppService* sv, uint32_t now) {
+    for(uint8_t i = 0; i < sv->count; i++) {
+        ServiceBrew* b = &sv->brew[i];
+        b->step = 0;
+        b->started = false;
+        b->alerted = false;
+        b->ready = now;
+    }
+    sv->act = -1;
+    sv->last = -1;
+    sv->active = true;
+    sv->started = now;
+    sv->ended = now;
+}
+
+// The brew to act on next and how long until then
+int8_t service_next(const AppService* sv, uint32_t now, uint32_t* wait_ms) {
+    SimBrew sim[SERVICE_MAX_BREWS];
+    SimOut out;
+    int32_t busy = sim_from_live(sv, now, sim);
+    simulate(sv, sv->order, sim, sv->act >= 0 ? sv->act : sv->last, busy, &out);
+    *wait_ms = (uint32_t)out.idle;
+    return out.first;
+}
+
+// Milliseconds until the last brew is done, replanned from now
+uint32_t service_eta(const AppService* sv, uint32_t now) {
+    SimBrew sim[SERVICE_MAX_BREWS];
+    SimOut out;
+    int32_t busy = sim_from_live(sv, now, sim);
+    return (uint32_t)simulate(sv, sv->order, sim, sv->act >= 0 ? sv->act : sv->last, busy, &out);
+}
+
+// The barista finished the step in hand; the waits after it start now
+void service_step_done(AppService* sv, uint32_t now) {
+    if(sv->act < 0) return;
+    ServiceBrew* b = &sv->brew[sv->act];
+    b->started = true;
+    b->step++;
+    int32_t wait = skip_waits(b, &b->step);
+    b->ready = now + (uint32_t)wait;
+    b->alerted = wait == 0;
+    sv->last = sv->act;
+    sv->act = -1;
+}
+
+// True once per wait that has run out
+bool service_wait_over(AppService* sv, uint32_t now) {
+    bool over = false;
+    for(uint8_t i = 0; i < sv->count; i++) {
+        ServiceBrew* b = &sv->brew[i];
+        if(b->started && !b->alerted && (int32_t)(now - b->ready) >= 0) {
+            b->alerted = true;
+            over = true;
+        }
+    }
+    return over;
+}
+
+bool service_finished(const AppService* sv, uint32_t now) {
+    if(sv->act >= 0) return false;
+    for(uint8_t i = 0; i < sv->count; i++) {
+        const ServiceBrew* b = &sv->brew[i];
+        if(b->step < b->step_count || (int32_t)(now - b->ready) < 0) return false;
+    }
+    return true;
+}
+
+// Batches count as that many drinks
+uint8_t service_drinks(const AppService* sv) {
+    uint8_t n = 0;
+    for(uint8_t i = 0; i < sv->count; i++) n += sv->brew[i].batch;
+    return n;
+}
+
+// ============================================================
+// Queue edits
+// ============================================================
+void service_remove(AppService* sv, uint8_t idx) {
+    if(idx >= sv->count) return;
+    memmove(&sv->brew[idx], &sv->brew[idx + 1], (sv->count - idx - 1) * sizeof(ServiceBrew));
+    sv->count--;
+    if(sv->sel >= sv->count && sv->sel > 0) sv->sel--;
+}
+
+// The custom recipe in slot was deleted: drop its brews
+void service_forget_custom(AppService* sv, uint8_t slot) {
+    for(uint8_t i = sv->count; i-- > 0;)
+        if(sv->brew[i].custom && sv->brew[i].recipe == slot) service_remove(sv, i);
+}
@@ -1,40 +1,72 @@
 #include "coffee_timer.h"
 
-void settings_load(CoffeeApp* app) {
-    Settings* set = &app->settings;
+// settings.bin from before the store: the raw struct
+static bool settings_import(Storage* storage, Settings* set) {
+    File* file = storage_file_alloc(storage);
+    bool ok = storage_file_open(file, SAVE_PATH, FSAM_READ, FSOM_OPEN_EXISTING) &&
+              storage_file_read(file, set, sizeof(Settings)) > 0;
+    storage_file_close(file);
+    storage_file_free(file);
+    return ok;
+}
+
+void settings_defaults(Settings* set) {
     set->last_method = 0;
     set->last_recipe = 0;
     set->auto_advance = false;
     set->sound_on = true;
     set->led_on = true;
     set->fav_count = 0;
+    set->power_save_types = POWER_SAVE_DEFAULT;
+    set->last_ratio_adjust = 0;
+    set->launch = LaunchMenu;
+    set->scale_source = SensorOff;
     memset(set->favourites, 0, sizeof(set->favourites));
+}
 
-    Storage* storage = furi_record_open(RECORD_STORAGE);
-    File* file = storage_file_alloc(storage);
-    if(storage_file_open(file, SAVE_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
-        storage_file_read(file, set, sizeof(Settings));
+// Storage worker, first request: opens the store and reads the settings
+// from it, or from an old settings.bin. A shorter record, from an older
+// version, leaves the defaults after it. NULL only when out of memory.
+Settings* settings_load(Storage* storage, AppStore* store) {
+    Settings* set = malloc(sizeof(Settings));
+    if(!set) return NULL;
+    settings_defaults(set);
+    store_open(storage, store);
+    bool stored = store_get(storage, store, StoreKeySettings, set, sizeof(Settings)) > 0;
+    bool imported = !stored && settings_import(storage, set);
+    if(stored || imported) {
         if(set->last_method >= method_count) set->last_method = 0;
         if(set->last_method < method_count &&
            set->last_recipe >= methods[set->last_method].recipe_count)
             set->last_recipe = 0;
         if(set->fav_count > 8) set->fav_count = 0;
+        set->power_save_types &= (1u << StepTypeCount) - 1;
+        if(set->last_ratio_adjust < -5 || set->last_ratio_adjust > 5) set->last_ratio_adjust = 0;
+        if(set->launch >= LaunchCount) set->launch = LaunchMenu;
+        if(set->scale_source >= SensorSourceCount) set->scale_source = SensorOff;
     }
-    storage_file_close(file);
-    storage_file_free(file);
-    furi_record_close(RECORD_STORAGE);
+    if(imported && settings_write(storage, store, set)) storage_simply_remove(storage, SAVE_PATH);
+    return set;
 }
 
+// Marks the settings for saving; the main loop posts one snapshot per
+// pass, however many changes it made
 void settings_save(CoffeeApp* app) {
-    Storage* storage = furi_record_open(RECORD_STORAGE);
-    storage_simply_mkdir(storage, APP_DATA_PATH(""));
-    File* file = storage_file_alloc(storage);
-    if(storage_file_open(file, SAVE_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
-        storage_file_write(file, &app->settings, sizeof(Settings));
-    }
-    storage_file_close(file);
-    storage_file_free(file);
-    furi_record_close(RECORD_STORAGE);
+    app->settings_dirty = true;
+}
+
+// Queues a snapshot for the storage worker. A full queue leaves the
+// settings dirty for the next pass; a replay's settings are its own and
+// wait for the user's to come back. Before the stored ones arrive there
+// is nothing to save over them.
+void settings_flush(CoffeeApp* app) {
+    if(!app->settings_dirty || !app->settings_loaded || app->trace.mode == TraceReplaying) return;
+    StorageRequest req = {.op = StorageOpSaveSettings, .settings = app->settings};
+    if(storage_post(app, &req)) app->settings_dirty = false;
+}
+
+bool settings_write(Storage* storage, AppStore* store, const Settings* set) {
+    return store_put(storage, store, StoreKeySettings, set, sizeof(Settings));
 }
 
 bool settings_is_favourite(Settings* set, uint8_t method, uint8_t recipe) {
@@ -61,20 +93,37 @@ void settings_toggle_favourite(Settings* set, uint8_t method, uint8_t recipe) {
     }
 }
 
-uint8_t adjusted_coffee(uint8_t base, int8_t adj) {
-    int16_t val = (int16_t)base + adj;
-    if(val < 1) val = 1;
-    if(val > 200) val = 200;
-    return (uint8_t)val;
+// Dose adjust keeps the brew ratio, so every amount scales by
+// (coffee + adj) * batch / coffee. Q16 keeps it integer-only.
+uint32_t dose_scale_q16(uint8_t base_coffee, int8_t adj, uint8_t batch) {
+    if(batch == 0) batch = 1;
+    if(base_coffee == 0) return (uint32_t)batch << 16;
+    int32_t coffee = (int32_t)base_coffee + adj;
+    if(coffee < 1) coffee = 1;
+    return ((uint32_t)coffee * batch << 16) / base_coffee;
 }
 
-uint16_t adjusted_water(uint16_t base_ml, uint8_t base_coffee, int8_t adj) {
-    if(base_coffee == 0) return base_ml;
-    float ratio = (float)base_ml / (float)base_coffee;
-    int16_t coffee = (int16_t)base_coffee + adj;
-    if(coffee < 1) coffee = 1;
-    int16_t water = (int16_t)(ratio * (float)coffee + 0.5f);
-    if(water < 10) water = 10;
-    if(water > 2000) water = 2000;
-    return (uint16_t)water;
+uint16_t dose_scale(uint16_t base, uint32_t factor_q16) {
+    uint64_t v = ((uint64_t)base * factor_q16 + 0x8000) >> 16;
+    return (v > 0xFFFF) ? 0xFFFF : (uint16_t)v;
+}
+
+// Step text with its amounts scaled: every number written straight
+// before "g" or "ml", so "Pour to 250ml" reads "Pour to 500ml" at x2
+void dose_scale_text(const char* src, uint32_t factor_q16, char* dst, size_t n) {
+    size_t o = 0;
+    while(*src && o + 1 < n) {
+        if(*src < '0' || *src > '9') {
+            dst[o++] = *src++;
+            continue;
+        }
+        const char* start = src;
+        uint32_t v = 0;
+        while(*src >= '0' && *src <= '9') v = v * 10 + (uint32_t)(*src++ - '0');
+        bool amount = (*src == 'g' || (src[0] == 'm' && src[1] == 'l')) && v <= 0xFFFF;
+        int k = amount ? snprintf(dst + o, n - o, "%u", dose_scale((uint16_t)v, factor_q16)) :
+                         snprintf(dst + o, n - o, "%.*s", (int)(src - start), start);
+        o += (size_t)k < n - o ? (size_t)k : n - o - 1;
+    }
+    dst[o] = 0;
 }
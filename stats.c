@@ -0,0 +1,213 @@
+#include "coffee_timer.h"
+#include <furi_hal.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================
+// Running statistics
+// ============================================================
+// Built-ins by position; customs by name, since their order changes
+uint16_t stats_key(bool custom, uint8_t method, uint8_t recipe, const char* name) {
+    if(!custom) return (uint16_t)(1 + (method << 6) + recipe);
+    uint32_t h = 2166136261u;
+    while(*name) {
+        h ^= (uint8_t)*name++;
+        h *= 16777619u;
+    }
+    return (uint16_t)(0x8000 | ((h ^ (h >> 15)) & 0x7FFF));
+}
+
+// Once n reaches STATS_MAX_N it stays there: each new sample first sheds
+// one average sample's worth of m2, so the estimate follows recent brews
+void stats_add(RecipeStats* rs, uint8_t row, uint32_t ms) {
+    if(row >= MAX_STEPS || ms > STATS_MAX_MS) return;
+    StepStat* st = &rs->row[row];
+    float x = (float)ms / 1000.0f;
+    if(st->n < STATS_MAX_N)
+        st->n++;
+    else
+        st->m2 *= (float)(st->n - 1) / (float)st->n;
+    float delta = x - st->mean_sec;
+    st->mean_sec += delta / (float)st->n;
+    st->m2 += delta * (x - st->mean_sec);
+}
+
+float stats_variance(const StepStat* st) {
+    return st->n > 1 ? st->m2 / (float)(st->n - 1) : 0.0f;
+}
+
+// Chan et al. pairwise combine: exact, so samples taken while the history
+// was loading lose nothing
+static void stats_merge(StepStat* into, const StepStat* b) {
+    if(b->n == 0) return;
+    if(into->n == 0) {
+        *into = *b;
+        return;
+    }
+    float na = (float)into->n, nb = (float)b->n, n = na + nb;
+    float delta = b->mean_sec - into->mean_sec;
+    into->mean_sec += delta * nb / n;
+    into->m2 += b->m2 + delta * delta * na * nb / n;
+    if(n > STATS_MAX_N) {
+        into->m2 *= (float)(STATS_MAX_N - 1) / (n - 1.0f);
+        into->n = STATS_MAX_N;
+    } else {
+        into->n = (uint16_t)n;
+    }
+}
+
+// ============================================================
+// Brew lifecycle (main thread, app mutex held)
+// ============================================================
+void stats_begin(CoffeeApp* app, uint16_t key) {
+    AppStats* s = &app->stats;
+    if(s->cur.key == key && !s->dirty && !s->loading) return;  // already current
+    stats_flush(app);
+    memset(&s->cur, 0, sizeof(RecipeStats));
+    s->cur.key = key;
+    s->loading = true;
+    s->dirty = false;
+    s->flush_after_load = false;
+    StorageRequest req = {.op = StorageOpLoadStats, .key = key};
+    storage_post(app, &req);
+}
+
+// Takes ownership of loaded (may be NULL: no history yet)
+void stats_loaded(CoffeeApp* app, RecipeStats* loaded) {
+    AppStats* s = &app->stats;
+    if(loaded && loaded->key == s->cur.key && s->loading) {
+        for(uint8_t r = 0; r < MAX_STEPS; r++) {
+            StepStat mine = s->cur.row[r];
+            s->cur.row[r] = loaded->row[r];
+            stats_merge(&s->cur.row[r], &mine);
+        }
+    }
+    free(loaded);
+    if(!s->loading) return;
+    s->loading = false;
+    if(s->flush_after_load) stats_flush(app);
+}
+
+// Hands a copy to the storage worker; waits for the history first so
+// a quick brew can't overwrite it
+void stats_flush(CoffeeApp* app) {
+    AppStats* s = &app->stats;
+    if(!s->dirty) return;
+    if(s->loading) {
+        s->flush_after_load = true;
+        return;
+    }
+    RecipeStats* copy = malloc(sizeof(RecipeStats));
+    if(!copy) return;
+    *copy = s->cur;
+    s->dirty = false;
+    s->flush_after_load = false;
+    StorageRequest req = {.op = StorageOpSaveStats, .data = (uint8_t*)copy, .len = sizeof(RecipeStats)};
+    storage_post(app, &req);
+}
+
+// ============================================================
+// Storage worker side: a RecipeStats per StoreKeyStats slot. Which
+// recipe each slot holds, and how many samples, is read once a run.
+// ============================================================
+static uint32_t stats_samples(const RecipeStats* rs) {
+    uint32_t n = 0;
+    for(uint8_t r = 0; r < MAX_STEPS; r++) n += rs->row[r].n;
+    return n;
+}
+
+// stats.bin from before the store: STATS_SLOTS raw records, moved into
+// the same slots and then removed
+static void stats_import(Storage* storage, AppStore* store) {
+    File* file = storage_file_alloc(storage);
+    bool ok = storage_file_open(file, STATS_PATH, FSAM_READ, FSOM_OPEN_EXISTING);
+    RecipeStats rs;
+    for(uint8_t i = 0; ok && i < STATS_SLOTS && storage_file_read(file, &rs, sizeof(rs)) == sizeof(rs); i++)
+        if(rs.key != 0) ok = store_put(storage, store, StoreKeyStats + i, &rs, sizeof(rs));
+    storage_file_close(file);
+    storage_file_free(file);
+    if(ok) storage_simply_remove(storage, STATS_PATH);
+}
+
+static void stats_index(Storage* storage, AppStore* store) {
+    if(store->stats_read) return;
+    stats_import(storage, store);
+    RecipeStats rs;
+    for(uint8_t i = 0; i < STATS_SLOTS; i++) {
+        bool got = store_get(storage, store, StoreKeyStats + i, &rs, sizeof(rs)) == sizeof(rs);
+        store->stats_key[i] = got ? rs.key : 0;
+        store->stats_n[i] = got ? stats_samples(&rs) : 0;
+    }
+    store->stats_read = true;
+}
+
+RecipeStats* stats_load(Storage* storage, AppStore* store, uint16_t key) {
+    stats_index(storage, store);
+    uint8_t i = 0;
+    while(i < STATS_SLOTS && store->stats_key[i] != key) i++;
+    if(i == STATS_SLOTS) return NULL;
+    RecipeStats* rs = malloc(sizeof(RecipeStats));
+    if(rs && (store_get(storage, store, StoreKeyStats + i, rs, sizeof(RecipeStats)) != sizeof(RecipeStats) ||
+              rs->key != key)) {
+        free(rs);
+        rs = NULL;
+    }
+    return rs;
+}
+
+// Same key's slot, else the first free one, else the least used
+bool stats_write(Storage* storage, AppStore* store, const RecipeStats* rs) {
+    stats_index(storage, store);
+    uint8_t pick = STATS_SLOTS, least = 0;
+    for(uint8_t i = 0; i < STATS_SLOTS; i++) {
+        if(store->stats_key[i] == rs->key) {
+            pick = i;
+            break;
+        }
+        if(store->stats_key[i] == 0 && pick == STATS_SLOTS) pick = i;
+        if(store->stats_n[i] < store->stats_n[least]) least = i;
+    }
+    if(pick == STATS_SLOTS) pick = least;
+    if(!store_put(storage, store, StoreKeyStats + pick, rs, sizeof(RecipeStats))) return false;
+    store->stats_key[pick] = rs->key;
+    store->stats_n[pick] = stats_samples(rs);
+    return true;
+}
+
+// ============================================================
+// Brew log
+// ============================================================
+// Main thread, at a brew's end
+void stats_log_brew(CoffeeApp* app) {
+    const AppState* s = &app->s;
+    uint32_t sec = s->total_elapsed_ms / 1000;
+    StorageRequest req = {.op = StorageOpLogBrew};
+    req.brew.time = furi_hal_rtc_get_timestamp();
+    req.brew.key = app->stats.cur.key;
+    req.brew.total_sec = sec > UINT16_MAX ? UINT16_MAX : (uint16_t)sec;
+    req.brew.coffee_g = app->scale.coffee_g;
+    req.brew.water_ml = app->scale.water_ml;
+    req.brew.ratio_adjust = s->ratio_adjust;
+    req.brew.batch = s->batch;
+    req.brew.auto_advance = app->settings.auto_advance;
+    storage_post(app, &req);
+}
+
+// Storage worker. Records go round STATS_LOG_SIZE keys; the newest
+// number is looked for once a run.
+bool stats_log_write(Storage* storage, AppStore* store, BrewLogEntry* e) {
+    if(!store->brew_seq_read) {
+        for(uint8_t i = 0; i < STATS_LOG_SIZE; i++) {
+            BrewLogEntry old;
+            if(store_get(storage, store, StoreKeyBrewLog + i, &old, sizeof(old)) == sizeof(old) &&
+               old.seq > store->brew_seq)
+                store->brew_seq = old.seq;
+        }
+        store->brew_seq_read = true;
+    }
+    e->seq = store->brew_seq + 1;
+    if(!store_put(storage, store, StoreKeyBrewLog + e->seq % STATS_LOG_SIZE, e, sizeof(BrewLogEntry)))
+        return false;
+    store->brew_seq = e->seq;
+    return true;
+}
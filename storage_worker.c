@@ -0,0 +1,138 @@
+#include "coffee_timer.h"
+
+// Requests that carry a heap buffer the worker frees
+static void request_free(const StorageRequest* req) {
+    if(req->op == StorageOpSaveRecipe) free(req->recipe);
+    if(req->op == StorageOpSaveTrace || req->op == StorageOpSaveStats ||
+       req->op == StorageOpSaveScaleTrace || req->op == StorageOpSyncCustom ||
+       req->op == StorageOpDumpMetrics)
+        free(req->data);
+}
+
+// ============================================================
+// Worker: owns the storage handle, runs requests in order and
+// reports each one back to the main queue
+// ============================================================
+static void storage_complete(CoffeeApp* app, StorageResult* res, uint32_t t0) {
+    AppEvent ev = {.type = AppEventStorage, .tick = furi_get_tick(), .storage = *res};
+    ev.storage.duration_ms = furi_get_tick() - t0;
+    // Bounded wait: after the main loop exits nobody drains the queue
+    if(furi_message_queue_put(app->queue, &ev, 100) != FuriStatusOk) {
+        free(res->settings);
+        free(res->stats);
+        free(res->sync);
+    }
+}
+
+static int32_t storage_worker(void* ctx) {
+    CoffeeApp* app = ctx;
+    StorageRequest req;
+
+    while(true) {
+        if(furi_message_queue_get(app->storage_queue, &req, FuriWaitForever) != FuriStatusOk)
+            continue;
+        if(req.op == StorageOpStop) break;
+
+        uint32_t t0 = furi_get_tick();
+        StorageResult res = {.op = req.op};
+        bool ok = false;
+
+        switch(req.op) {
+        case StorageOpLoadSettings:
+            res.settings = settings_load(app->storage, &app->store);
+            ok = res.settings != NULL;
+            break;
+        case StorageOpLoadCustom:
+            res.count = custom_recipes_load(app);
+            ok = true;
+            break;
+        case StorageOpSaveSettings:
+            ok = settings_write(app->storage, &app->store, &req.settings);
+            break;
+        case StorageOpSaveRecipe:
+            ok = custom_recipe_store(app->storage, &app->store, req.slot, req.recipe, req.exported);
+            free(req.recipe);
+            break;
+        case StorageOpRemoveRecipe:
+            ok = custom_recipe_remove(app->storage, &app->store, req.slot);
+            break;
+        case StorageOpDumpMetrics:
+            ok = metrics_write(app->storage, req.data, req.len);
+            free(req.data);
+            break;
+        case StorageOpSaveTrace:
+            ok = trace_write(app->storage, req.data, req.len);
+            free(req.data);
+            break;
+        case StorageOpLoadTrace:
+            ok = trace_load(app);
+            break;
+        case StorageOpLoadStats:
+            res.stats = stats_load(app->storage, &app->store, req.key);
+            ok = true;
+            break;
+        case StorageOpSaveStats:
+            ok = stats_write(app->storage, &app->store, (const RecipeStats*)req.data);
+            free(req.data);
+            break;
+        case StorageOpSaveScaleTrace:
+            ok = sensor_trace_write(app->storage, req.data, req.len);
+            free(req.data);
+            break;
+        case StorageOpLoadScaleTrace:
+            ok = sensor_trace_load(app);
+            break;
+        case StorageOpSyncCustom:
+            res.sync = custom_recipes_scan(
+                app->storage, &app->store, (const CustomFileRef*)req.data,
+                (uint8_t)(req.len / sizeof(CustomFileRef)));
+            free(req.data);
+            ok = true;
+            break;
+        case StorageOpExportCustom:
+            ok = custom_recipes_export(app->storage, &app->store);
+            break;
+        case StorageOpLogBrew:
+            ok = stats_log_write(app->storage, &app->store, &req.brew);
+            break;
+        default:
+            break;
+        }
+        res.ok = ok;
+        storage_complete(app, &res, t0);
+    }
+    return 0;
+}
+
+// ============================================================
+// Public API
+// ============================================================
+void storage_worker_start(CoffeeApp* app) {
+    app->storage = furi_record_open(RECORD_STORAGE);
+    app->storage_queue = furi_message_queue_alloc(STORAGE_QUEUE_LEN, sizeof(StorageRequest));
+    app->storage_thread = furi_thread_alloc_ex("CoffeeStorage", 2048, storage_worker, app);
+    furi_thread_start(app->storage_thread);
+}
+
+// Requests queued before the stop still run, so pending saves land
+void storage_worker_stop(CoffeeApp* app) {
+    StorageRequest req = {.op = StorageOpStop};
+    furi_message_queue_put(app->storage_queue, &req, FuriWaitForever);
+    furi_thread_join(app->storage_thread);
+    furi_thread_free(app->storage_thread);
+
+    while(furi_message_queue_get(app->storage_queue, &req, 0) == FuriStatusOk) request_free(&req);
+    furi_message_queue_free(app->storage_queue);
+    furi_record_close(RECORD_STORAGE);
+}
+
+// Callers hold the app mutex, so a full queue costs a dropped request,
+// not a stalled UI. At exit nothing else waits on the lock.
+bool storage_post(CoffeeApp* app, const StorageRequest* req) {
+    uint32_t timeout = app->storage_closing ? FuriWaitForever : furi_ms_to_ticks(STORAGE_POST_MS);
+    if(furi_message_queue_put(app->storage_queue, req, timeout) == FuriStatusOk) return true;
+    app->metrics.storage_drops++;
+    FURI_LOG_W(COFFEE_TIMER_TAG, "Storage queue full, op %d dropped", req->op);
+    request_free(req);
+    return false;
+}
@@ -0,0 +1,223 @@
+#include "coffee_timer.h"
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================
+// Records: header, then len bytes of value. The CRC covers key,
+// len and value, so a write cut short reads as the end of the log.
+// ============================================================
+// CRC-8, polynomial 0x07 as in telemetry frames, carried across calls
+static uint8_t crc8_add(uint8_t crc, const void* data, size_t n) {
+    const uint8_t* p = data;
+    while(n--) {
+        crc ^= *p++;
+        for(uint8_t b = 0; b < 8; b++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+static uint8_t header_crc(const StoreHeader* h) {
+    uint8_t crc = crc8_add(0, &h->key, sizeof(h->key));
+    return crc8_add(crc, &h->len, sizeof(h->len));
+}
+
+// ============================================================
+// Index: where each live key's latest value sits in the log
+// ============================================================
+static StoreEntry* store_find(AppStore* st, uint16_t key) {
+    for(uint8_t i = 0; i < st->count; i++)
+        if(st->entry[i].key == key) return &st->entry[i];
+    return NULL;
+}
+
+// A zero len drops the key; false if a new key finds the index full
+static bool index_set(AppStore* st, uint16_t key, uint16_t len, uint32_t at) {
+    StoreEntry* e = store_find(st, key);
+    if(e) {
+        st->live -= sizeof(StoreHeader) + e->len;
+        if(len == 0) {
+            *e = st->entry[--st->count];
+            return true;
+        }
+    } else {
+        if(len == 0) return true;
+        if(st->count >= STORE_KEYS_MAX) return false;
+        e = &st->entry[st->count++];
+    }
+    e->key = key;
+    e->len = len;
+    e->at = at;
+    st->live += sizeof(StoreHeader) + len;
+    return true;
+}
+
+// ============================================================
+// Open: one pass over the log, in chunks, builds the index
+// ============================================================
+typedef struct {
+    File* file;
+    uint16_t pos;
+    uint16_t fill;
+    uint8_t buf[STORE_READ_CHUNK];
+} StoreReader;
+
+// n bytes into dst (NULL skips them), folded into crc; false at the end
+static bool reader_take(StoreReader* r, void* dst, uint16_t n, uint8_t* crc) {
+    uint8_t* out = dst;
+    while(n > 0) {
+        if(r->pos == r->fill) {
+            r->fill = storage_file_read(r->file, r->buf, sizeof(r->buf));
+            r->pos = 0;
+            if(r->fill == 0) return false;
+        }
+        uint16_t k = r->fill - r->pos;
+        if(k > n) k = n;
+        if(crc) *crc = crc8_add(*crc, r->buf + r->pos, k);
+        if(out) {
+            memcpy(out, r->buf + r->pos, k);
+            out += k;
+        }
+        r->pos += k;
+        n -= k;
+    }
+    return true;
+}
+
+// Stops at the first record that doesn't check out; the next write
+// cuts the log there
+static void store_scan(AppStore* st, File* file) {
+    StoreReader* r = malloc(sizeof(StoreReader));
+    if(!r) return;
+    r->file = file;
+    r->pos = r->fill = 0;
+    StoreHeader h;
+    while(reader_take(r, &h, sizeof(h), NULL)) {
+        if(h.magic != STORE_MAGIC || h.len > STORE_VALUE_MAX) break;
+        uint8_t crc = header_crc(&h);
+        if(!reader_take(r, NULL, h.len, &crc) || crc != h.crc) break;
+        index_set(st, h.key, h.len, st->size + sizeof(h));
+        st->size += sizeof(h) + h.len;
+    }
+    free(r);
+}
+
+bool store_open(Storage* storage, AppStore* st) {
+    memset(st, 0, sizeof(AppStore));
+    FileInfo info;
+    // A compaction cut short: the old log is whole until the new one
+    // takes its name
+    if(storage_common_stat(storage, STORE_PATH, &info) == FSE_OK)
+        storage_simply_remove(storage, STORE_TMP_PATH);
+    else if(storage_common_stat(storage, STORE_TMP_PATH, &info) == FSE_OK)
+        storage_common_rename(storage, STORE_TMP_PATH, STORE_PATH);
+
+    if(storage_common_stat(storage, STORE_PATH, &info) != FSE_OK) {
+        st->open = true;            // nothing stored yet
+        return true;
+    }
+    File* file = storage_file_alloc(storage);
+    if(storage_file_open(file, STORE_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        store_scan(st, file);
+        st->open = true;
+        if(st->size < info.size)
+            FURI_LOG_W(COFFEE_TIMER_TAG, "Store: %lu bytes past the last good record",
+                (unsigned long)(info.size - st->size));
+        FURI_LOG_I(COFFEE_TIMER_TAG, "Store: %u keys, %lu of %lu bytes live",
+            st->count, (unsigned long)st->live, (unsigned long)st->size);
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    return st->open;
+}
+
+// ============================================================
+// Reads and writes (storage worker, or before its first request)
+// ============================================================
+// Up to cap bytes of key's value; the bytes read, 0 if it has none
+uint16_t store_get(Storage* storage, AppStore* st, uint16_t key, void* buf, uint16_t cap) {
+    StoreEntry* e = store_find(st, key);
+    if(!e) return 0;
+    uint16_t n = e->len < cap ? e->len : cap;
+    File* file = storage_file_alloc(storage);
+    bool ok = storage_file_open(file, STORE_PATH, FSAM_READ, FSOM_OPEN_EXISTING) &&
+              storage_file_seek(file, e->at, true) && storage_file_read(file, buf, n) == n;
+    storage_file_close(file);
+    storage_file_free(file);
+    return ok ? n : 0;
+}
+
+// Appends key's new value, or with len 0 its removal. Anything past the
+// last good record, from a torn write, is cut off first.
+bool store_put(Storage* storage, AppStore* st, uint16_t key, const void* value, uint16_t len) {
+    if(!st->open || len > STORE_VALUE_MAX) return false;
+    StoreEntry* e = store_find(st, key);
+    if(len == 0 && !e) return true;
+    if(!e && st->count >= STORE_KEYS_MAX) {
+        FURI_LOG_E(COFFEE_TIMER_TAG, "Store: no room for key %04x", key);
+        return false;
+    }
+    StoreHeader h = {.magic = STORE_MAGIC, .key = key, .len = len};
+    h.crc = crc8_add(header_crc(&h), value, len);
+
+    storage_simply_mkdir(storage, APP_DATA_PATH(""));
+    File* file = storage_file_alloc(storage);
+    bool ok = false;
+    if(storage_file_open(file, STORE_PATH, FSAM_READ_WRITE, FSOM_OPEN_ALWAYS) &&
+       storage_file_seek(file, st->size, true)) {
+        if(storage_file_size(file) > st->size) storage_file_truncate(file);
+        ok = storage_file_write(file, &h, sizeof(h)) == sizeof(h) &&
+             (len == 0 || storage_file_write(file, value, len) == len);
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    if(!ok) return false;
+
+    index_set(st, key, len, st->size + sizeof(h));
+    st->size += sizeof(h) + len;
+    if(st->size >= STORE_COMPACT_MIN && st->live * 2 < st->size) store_compact(storage, st);
+    return true;
+}
+
+// ============================================================
+// Compaction: the live records go to a new log, which then takes
+// the old one's name
+// ============================================================
+bool store_compact(Storage* storage, AppStore* st) {
+    uint8_t* buf = malloc(STORE_VALUE_MAX);
+    uint32_t* at = malloc(STORE_KEYS_MAX * sizeof(uint32_t));
+    File* in = storage_file_alloc(storage);
+    File* out = storage_file_alloc(storage);
+    uint32_t size = 0;
+    bool ok = buf && at && storage_file_open(in, STORE_PATH, FSAM_READ, FSOM_OPEN_EXISTING) &&
+              storage_file_open(out, STORE_TMP_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS);
+    for(uint8_t i = 0; ok && i < st->count; i++) {
+        const StoreEntry* e = &st->entry[i];
+        StoreHeader h = {.magic = STORE_MAGIC, .key = e->key, .len = e->len};
+        ok = storage_file_seek(in, e->at, true) && storage_file_read(in, buf, e->len) == e->len;
+        if(!ok) break;
+        h.crc = crc8_add(header_crc(&h), buf, e->len);
+        ok = storage_file_write(out, &h, sizeof(h)) == sizeof(h) &&
+             storage_file_write(out, buf, e->len) == e->len;
+        at[i] = size + sizeof(h);
+        size += sizeof(h) + e->len;
+    }
+    if(ok) ok = storage_file_sync(out);
+    storage_file_close(in);
+    storage_file_close(out);
+    storage_file_free(in);
+    storage_file_free(out);
+    if(ok) ok = storage_common_rename(storage, STORE_TMP_PATH, STORE_PATH) == FSE_OK;
+
+    if(ok) {
+        FURI_LOG_I(COFFEE_TIMER_TAG, "Store compacted: %lu -> %lu bytes",
+            (unsigned long)st->size, (unsigned long)size);
+        for(uint8_t i = 0; i < st->count; i++) st->entry[i].at = at[i];
+        st->size = st->live = size;
+    } else {
+        storage_simply_remove(storage, STORE_TMP_PATH);
+        FURI_LOG_E(COFFEE_TIMER_TAG, "Store compaction failed");
+    }
+    free(buf);
+    free(at);
+    return ok;
+}
@@ -0,0 +1,138 @@
+#include "coffee_timer.h"
+#include <furi_hal_usb_cdc.h>
+#include <string.h>
+
+// ============================================================
+// Framing, shared with the host decoder
+// ============================================================
+static uint8_t crc8(const uint8_t* p, size_t n) {
+    uint8_t crc = 0;
+    while(n--) {
+        crc ^= *p++;
+        for(uint8_t b = 0; b < 8; b++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+static uint8_t* put16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static uint16_t get16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+// Fills frame (TELEMETRY_FRAME_LEN bytes) and returns its length
+size_t telemetry_encode(const TelemetryState* st, uint8_t seq, uint8_t* frame) {
+    uint8_t* p = frame;
+    *p++ = TELEMETRY_SYNC;
+    *p++ = TELEMETRY_PAYLOAD_LEN;
+    *p++ = TELEMETRY_VERSION;
+    *p++ = seq;
+    *p++ = st->flags;
+    *p++ = st->method;
+    *p++ = st->recipe;
+    *p++ = st->step;
+    *p++ = st->step_count;
+    p = put16(p, st->step_sec);
+    p = put16(p, st->remaining_sec);
+    p = put16(p, st->total_sec);
+    p = put16(p, st->water_ml);
+    *p = crc8(frame + 1, (size_t)(p - frame - 1));
+    return (size_t)(p - frame + 1);
+}
+
+// frame starts at the sync byte; false on a bad length, version or CRC
+bool telemetry_parse(const uint8_t* frame, size_t len, TelemetryState* st, uint8_t* seq) {
+    if(len < TELEMETRY_FRAME_LEN || frame[0] != TELEMETRY_SYNC) return false;
+    if(frame[1] != TELEMETRY_PAYLOAD_LEN || frame[2] != TELEMETRY_VERSION) return false;
+    if(crc8(frame + 1, TELEMETRY_PAYLOAD_LEN + 1) != frame[TELEMETRY_FRAME_LEN - 1]) return false;
+    const uint8_t* p = frame + 3;
+    *seq = *p++;
+    st->flags = *p++;
+    st->method = *p++;
+    st->recipe = *p++;
+    st->step = *p++;
+    st->step_count = *p++;
+    st->step_sec = get16(p);
+    st->remaining_sec = get16(p + 2);
+    st->total_sec = get16(p + 4);
+    st->water_ml = get16(p + 6);
+    return true;
+}
+
+// ============================================================
+// USB side
+// ============================================================
+// Runs in the USB interrupt
+static void telemetry_tx_done(void* ctx) {
+    CoffeeApp* app = ctx;
+    app->telemetry.tx_busy = false;
+}
+
+static CdcCallbacks telemetry_cdc_cb = {
+    .tx_ep_callback = telemetry_tx_done,
+};
+
+// Switches USB to dual CDC so the CLI keeps interface 0
+bool telemetry_start(CoffeeApp* app) {
+    AppTelemetry* t = &app->telemetry;
+    if(t->active) return true;
+    if(furi_hal_usb_is_locked()) return false;
+    t->prev_usb = furi_hal_usb_get_config();
+    if(t->prev_usb != &usb_cdc_dual && !furi_hal_usb_set_config(&usb_cdc_dual, NULL)) return false;
+    furi_hal_cdc_set_callbacks(TELEMETRY_CDC_IF, &telemetry_cdc_cb, app);
+    t->tx_busy = false;
+    t->have_last = false;
+    t->pending = false;
+    t->active = true;
+    return true;
+}
+
+void telemetry_stop(CoffeeApp* app) {
+    AppTelemetry* t = &app->telemetry;
+    if(!t->active) return;
+    furi_hal_cdc_set_callbacks(TELEMETRY_CDC_IF, NULL, NULL);
+    if(t->prev_usb != &usb_cdc_dual) furi_hal_usb_set_config(t->prev_usb, NULL);
+    t->active = false;
+}
+
+// Times tick on both ends, so only discrete changes count
+static bool state_changed(const TelemetryState* a, const TelemetryState* b) {
+    return a->flags != b->flags || a->method != b->method || a->recipe != b->recipe ||
+           a->step != b->step || a->step_count != b->step_count ||
+           a->step_sec != b->step_sec || a->water_ml != b->water_ml;
+}
+
+// Main loop, app mutex held. One transfer in flight; a change that finds
+// the endpoint busy is sent on a later pass with the state of that pass.
+void telemetry_update(CoffeeApp* app, const TelemetryState* st) {
+    AppTelemetry* t = &app->telemetry;
+    if(!t->active) return;
+    if(!t->pending && t->have_last && !state_changed(st, &t->last)) return;
+    t->pending = true;
+
+    uint32_t now = furi_get_tick();
+    if(t->tx_busy) {
+        // Nobody reading: the endpoint still holds the last frame, and
+        // the latest state goes out once the host takes it
+        if(!t->tx_stalled && now - t->tx_tick >= TELEMETRY_STALL_MS) {
+            t->tx_stalled = true;
+            t->stalls++;
+        }
+        return;
+    }
+
+    uint8_t frame[TELEMETRY_FRAME_LEN];
+    size_t len = telemetry_encode(st, t->seq++, frame);
+    t->last = *st;
+    t->have_last = true;
+    t->pending = false;
+    t->tx_busy = true;
+    t->tx_stalled = false;
+    t->tx_tick = now;
+    t->frames++;
+    furi_hal_cdc_send(TELEMETRY_CDC_IF, frame, (uint16_t)len);
+}
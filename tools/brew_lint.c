@@ -0,0 +1,224 @@
+// .brew file checker.
+//
+// Runs custom recipe files through the app's own parser (custom.c) and
+// reports, per line, what it would read differently from what was written:
+// unknown step types, cut-off text, numbers that don't fit, REPEAT counts
+// out of range, water totals that don't add up, and files the app would
+// skip. Directories are read like the app's custom folder.
+//
+// Build instructions are in README.md under "Host tools".
+//   brew_lint PATH... [--json] [--werror]
+//
+// Messages are "path:line: error|warning: text" (line 0 is the whole file),
+// then a summary. --json prints one JSON object with every file's findings
+// instead. The exit status is 1 if any file has an error (or, with
+// --werror, a warning), 2 on bad usage.
+
+#include "coffee_timer.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define LINT_MAX_DIAGS 64
+
+typedef struct {
+    uint16_t line;
+    BrewDiagLevel level;
+    char msg[96];
+} LintDiag;
+
+typedef struct {
+    char path[512];
+    char name[NAME_LEN];
+    bool loaded;
+    uint8_t count;
+    uint16_t dropped;           // past LINT_MAX_DIAGS
+    LintDiag diag[LINT_MAX_DIAGS];
+} LintFile;
+
+typedef struct {
+    bool json;
+    unsigned files, errors, warnings;
+    bool first;                 // no JSON file written yet
+} Lint;
+
+static void collect(void* ctx, uint16_t line, BrewDiagLevel level, const char* msg) {
+    LintFile* lf = ctx;
+    if(lf->count >= LINT_MAX_DIAGS) {
+        lf->dropped++;
+        return;
+    }
+    LintDiag* d = &lf->diag[lf->count++];
+    d->line = line;
+    d->level = level;
+    snprintf(d->msg, sizeof(d->msg), "%s", msg);
+}
+
+static void json_str(const char* s) {
+    putchar('"');
+    for(; *s; s++) {
+        if(*s == '"' || *s == '\\')
+            printf("\\%c", *s);
+        else if((unsigned char)*s < 0x20)
+            printf("\\u%04x", (unsigned char)*s);
+        else
+            putchar(*s);
+    }
+    putchar('"');
+}
+
+static void lint_print(Lint* l, const LintFile* lf) {
+    l->files++;
+    for(uint8_t i = 0; i < lf->count; i++) {
+        if(lf->diag[i].level == BrewDiagError)
+            l->errors++;
+        else
+            l->warnings++;
+    }
+
+    if(!l->json) {
+        for(uint8_t i = 0; i < lf->count; i++) {
+            const LintDiag* d = &lf->diag[i];
+            printf("%s:%u: %s: %s\n", lf->path, d->line,
+                d->level == BrewDiagError ? "error" : "warning", d->msg);
+        }
+        if(lf->dropped) printf("%s: %u more not shown\n", lf->path, lf->dropped);
+        return;
+    }
+
+    printf("%s\n  {\"path\": ", l->first ? "" : ",");
+    l->first = false;
+    json_str(lf->path);
+    printf(", \"name\": ");
+    json_str(lf->name);
+    printf(", \"loaded\": %s, \"diagnostics\": [", lf->loaded ? "true" : "false");
+    for(uint8_t i = 0; i < lf->count; i++) {
+        const LintDiag* d = &lf->diag[i];
+        printf("%s{\"line\": %u, \"level\": \"%s\", \"message\": ", i ? ", " : "", d->line,
+            d->level == BrewDiagError ? "error" : "warning");
+        json_str(d->msg);
+        printf("}");
+    }
+    printf("]}");
+}
+
+// Reads at most what the app reads, and says so if there is more
+static void lint_file(const char* path, const char* fname, LintFile* lf) {
+    memset(lf, 0, sizeof(LintFile));
+    snprintf(lf->path, sizeof(lf->path), "%s", path);
+    BrewDiag diag = {.fn = collect, .ctx = lf};
+
+    FILE* fp = fopen(path, "rb");
+    if(!fp) {
+        collect(lf, 0, BrewDiagError, "can't open the file");
+        return;
+    }
+    char buf[BREW_FILE_MAX];
+    size_t n = fread(buf, 1, BREW_FILE_MAX - 1, fp);
+    bool more = fgetc(fp) != EOF;
+    fclose(fp);
+    buf[n] = 0;
+    if(more) collect(lf, 0, BrewDiagError, "longer than 1023 bytes: the app reads only that much");
+    if(strlen(fname) >= sizeof(((CustomRecipe*)0)->filename))
+        collect(lf, 0, BrewDiagWarning, "file name over 31 characters: the app can't save or delete it");
+
+    CustomRecipe cr;
+    lf->loaded = custom_recipe_parse(buf, &cr, &diag);
+    snprintf(lf->name, sizeof(lf->name), "%s", cr.name);
+}
+
+static bool is_brew(const char* name) {
+    size_t len = strlen(name);
+    return len >= 6 && strcasecmp(name + len - 5, ".brew") == 0;
+}
+
+static int by_name(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+// A folder as the app sees it: .brew files only, one recipe per name, and
+// no more than MAX_CUSTOM_RECIPES of them
+static void lint_dir(Lint* l, const char* dir, LintFile* lf) {
+    DIR* d = opendir(dir);
+    if(!d) {
+        perror(dir);
+        l->errors++;
+        return;
+    }
+    char* names[256];
+    size_t count = 0;
+    struct dirent* de;
+    while((de = readdir(d)) != NULL && count < 256)
+        if(is_brew(de->d_name)) names[count++] = strdup(de->d_name);
+    closedir(d);
+    qsort(names, count, sizeof(char*), by_name);
+
+    char seen[256][NAME_LEN];
+    unsigned loaded = 0;
+    for(size_t i = 0; i < count; i++) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s", dir, names[i]);
+        lint_file(path, names[i], lf);
+        if(lf->loaded) {
+            for(unsigned k = 0; k < loaded; k++) {
+                if(strcasecmp(seen[k], lf->name) == 0) {
+                    collect(lf, 0, BrewDiagWarning, "another file in this folder has the same name");
+                    break;
+                }
+            }
+            memcpy(seen[loaded], lf->name, NAME_LEN);
+            if(++loaded == MAX_CUSTOM_RECIPES + 1)
+                collect(lf, 0, BrewDiagWarning, "more than 4 recipes: the app loads the first 4 it reads");
+        }
+        lint_print(l, lf);
+        free(names[i]);
+    }
+}
+
+int main(int argc, char** argv) {
+    Lint l = {.first = true};
+    bool werror = false;
+    int paths = 0;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--json") == 0)
+            l.json = true;
+        else if(strcmp(argv[i], "--werror") == 0)
+            werror = true;
+        else if(argv[i][0] == '-' && argv[i][1]) {
+            fprintf(stderr, "usage: %s PATH... [--json] [--werror]\n", argv[0]);
+            return 2;
+        } else
+            paths++;
+    }
+    if(paths == 0) {
+        fprintf(stderr, "usage: %s PATH... [--json] [--werror]\n", argv[0]);
+        return 2;
+    }
+
+    static LintFile lf;
+    if(l.json) printf("{\"files\": [");
+    for(int i = 1; i < argc; i++) {
+        const char* path = argv[i];
+        if(path[0] == '-' && path[1]) continue;
+        struct stat st;
+        if(stat(path, &st) != 0) {
+            perror(path);
+            l.errors++;
+        } else if(S_ISDIR(st.st_mode)) {
+            lint_dir(&l, path, &lf);
+        } else {
+            const char* base = strrchr(path, '/');
+            lint_file(path, base ? base + 1 : path, &lf);
+            lint_print(&l, &lf);
+        }
+    }
+
+    if(l.json)
+        printf("%s], \"files_checked\": %u, \"errors\": %u, \"warnings\": %u}\n",
+            l.first ? "" : "\n", l.files, l.errors, l.warnings);
+    else
+        fprintf(stderr, "%u files, %u errors, %u warnings\n", l.files, l.errors, l.warnings);
+    return l.errors || (werror && l.warnings) ? 1 : 0;
+}
@@ -0,0 +1,327 @@
+// Deterministic brew timing benchmark.
+//
+// Runs every built-in recipe through the app's own timer callbacks, input
+// handler and main loop on a virtual 1 ms clock, with injected dropped and
+// late timer ticks, late deadline timers and contended mutex acquires.
+// For each run it reports how far the brew clock the barista sees drifted
+// from the real running time, how late step completion fired, and how far
+// from the deadline the next timed step's clock started where
+// auto-advance hands a step on.
+//
+// Build instructions are in README.md under "Host tools".
+//   brew_sim [--seed N] [--profile ideal|load|heavy] [--max-err MS]
+
+#include "../coffee_timer.c"
+#include "host.h"
+
+#define SIM_TICK_MS      100
+#define SIM_LOOP_MS      100
+#define SIM_LIMIT_MS     (2UL * 60 * 60 * 1000)
+#define SIM_MANUAL_MS    1500
+#define SIM_REACT_MS     700
+#define SIM_AUTO_WAIT_MS 3000
+#define SIM_PAUSE_MS     4000
+
+// ============================================================
+// Fault profiles
+// ============================================================
+typedef struct {
+    const char* name;
+    uint16_t drop_permille;     // timer tick never delivered
+    uint16_t late_permille;     // tick delivered after its period
+    uint16_t late_max_ms;
+    uint16_t lock_permille;     // app mutex held when the tick arrives
+    uint16_t lock_max_ms;
+} FaultProfile;
+
+static const FaultProfile profiles[] = {
+    {"ideal", 0, 0, 0, 0, 0},
+    {"load", 20, 100, 30, 30, 40},
+    {"heavy", 80, 300, 60, 100, 80},
+};
+
+typedef enum {
+    ScriptStraight,     // OK through every step
+    ScriptPause,        // pause halfway through each timed step
+    ScriptNav,          // Right then Left on the third step
+    ScriptAuto,         // auto_advance on
+    ScriptCount,
+} Script;
+
+static const char* script_names[ScriptCount] = {"straight", "pause", "nav", "auto"};
+
+typedef struct {
+    int32_t err_ms;         // app total minus real running time
+    uint32_t done_lag_ms;   // worst deadline -> step_complete
+    uint32_t auto_lag_ms;   // worst |deadline - handed-on timed step's start|
+    bool finished;
+} SimResult;
+
+// ============================================================
+// Deterministic PRNG (xorshift32)
+// ============================================================
+static uint32_t rng_state;
+
+static uint32_t rng_next(void) {
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return rng_state = x;
+}
+
+static bool rng_permille(uint16_t p) {
+    return p > 0 && (rng_next() % 1000) < p;
+}
+
+static uint32_t rng_range(uint32_t lo, uint32_t hi) {
+    return lo + rng_next() % (hi - lo + 1);
+}
+
+// ============================================================
+// Simulation
+// ============================================================
+// A tap: the press, then the short press the firmware reports on release
+static void press(CoffeeApp* app, InputKey key) {
+    InputEvent ev = {.sequence = 0, .key = key, .type = InputTypePress};
+    input_cb(&ev, app);
+    ev.type = InputTypeShort;
+    input_cb(&ev, app);
+}
+
+static SimResult simulate(uint8_t method, uint8_t recipe, Script script, const FaultProfile* fp) {
+    SimResult res = {0};
+    host_clock_set(0);
+    CoffeeApp* app = app_alloc();
+    app->settings.auto_advance = (script == ScriptAuto);
+
+    app->s.cur_method = method;
+    app->s.cur_recipe = recipe;
+    app->s.using_custom = false;
+    app->s.screen = ScreenRecipeInfo;
+
+    // Start somewhere inside a timer period, like a real button press
+    uint32_t now = rng_range(1, SIM_TICK_MS - 1);
+    host_clock_set(now);
+    press(app, InputKeyOk);
+
+    uint32_t next_tick = SIM_TICK_MS;
+    uint32_t tick_at = 0;           // pending delivery, 0 = none
+    bool tick_blocked = false;
+    uint32_t deadline_fire = 0;     // pending deadline callback, 0 = none
+    uint32_t next_loop = now;
+
+    uint32_t true_running = 0;
+    uint32_t step_true = 0;
+    uint8_t last_step = 0xFF;
+    uint32_t deadline_at = 0;
+    bool done_seen = false;
+    StepAdvance last_adv = AdvanceConfirm;
+    uint16_t last_dur = 0;
+    uint32_t action_at = 0;
+    InputKey action_key = InputKeyOk;
+    bool paused_once = false;
+    uint8_t nav_stage = 0;
+
+    while(now < SIM_LIMIT_MS) {
+        host_clock_set(now);
+
+        // Timer service: schedule this period's tick, then deliver it
+        if(now >= next_tick) {
+            next_tick += SIM_TICK_MS;
+            if(!rng_permille(fp->drop_permille)) {
+                uint32_t delay = 0;
+                tick_blocked = false;
+                if(rng_permille(fp->late_permille)) delay += rng_range(1, fp->late_max_ms);
+                if(rng_permille(fp->lock_permille)) {
+                    uint32_t hold = rng_range(1, fp->lock_max_ms);
+                    if(hold > 10) tick_blocked = true;
+                    else delay += hold;
+                }
+                tick_at = now + delay;
+            }
+        }
+        if(tick_at != 0 && now >= tick_at) {
+            tick_at = 0;
+            if(tick_blocked) host_mutex_fail_next(1);
+            tick_cb(app);
+            host_mutex_fail_next(0);
+        }
+        // The deadline timer only posts to the queue; the timer service
+        // may still run it late
+        if(host_timer_due(app->deadline))
+            deadline_fire = now + (rng_permille(fp->late_permille) ? rng_range(1, fp->late_max_ms) : 0);
+        if(deadline_fire != 0 && now >= deadline_fire) {
+            deadline_fire = 0;
+            deadline_cb(app);
+        }
+
+        // Barista
+        if(action_at != 0 && now >= action_at) {
+            action_at = 0;
+            press(app, action_key);
+        }
+
+        // Main loop wakes on input or after its queue timeout
+        if(furi_message_queue_get_count(app->queue) > 0 || now >= next_loop) {
+            app_process(app, 0);
+            next_loop = now + SIM_LOOP_MS;
+        }
+
+        AppState* s = &app->s;
+        if(s->screen == ScreenComplete) {
+            res.finished = true;
+            break;
+        }
+
+        if(s->cur_step != last_step) {
+            // Chained or armed, the step's clock carried on into this one
+            uint32_t carried = 0;
+            if(last_adv != AdvanceConfirm) {
+                // Where the deadline is still to come on the real clock, it
+                // is when the step would have run out
+                uint32_t due = deadline_at ? deadline_at : now + last_dur * 1000U - step_true;
+                int32_t lag = (int32_t)(now - s->step_elapsed_ms - due);
+                if(lag < 0) lag = -lag;
+                // A manual step has no clock to start: an armed one waits
+                // for OK, and that reaction isn't lag
+                if(get_sdur(app, s->cur_step) > 0 && (uint32_t)lag > res.auto_lag_ms)
+                    res.auto_lag_ms = (uint32_t)lag;
+                carried = now > due ? now - due : 0;
+            }
+            step_true = carried;
+            last_step = s->cur_step;
+            deadline_at = 0;
+            done_seen = false;
+            paused_once = false;
+            action_at = 0;
+        }
+
+        uint16_t dur = get_sdur(app, s->cur_step);
+        last_dur = dur;
+        last_adv = s->screen == ScreenBrewing ? get_sadvance(app, s->cur_step) : AdvanceConfirm;
+
+        if(s->screen == ScreenBrewing && action_at == 0) {
+            if(dur == 0) {
+                action_at = now + SIM_MANUAL_MS;
+                action_key = InputKeyOk;
+            } else if(script == ScriptPause && !paused_once && step_true >= dur * 500U) {
+                paused_once = true;
+                action_at = now + 1;
+                action_key = InputKeyOk;
+            } else if(s->timer_state == TimerPaused) {
+                action_at = now + SIM_PAUSE_MS;
+                action_key = InputKeyOk;
+            } else if(s->step_complete) {
+                // A chained step moves on by itself; OK is only a fallback
+                action_at = now + (last_adv == AdvanceChain ? SIM_AUTO_WAIT_MS : SIM_REACT_MS);
+                action_key = InputKeyOk;
+            }
+            if(script == ScriptNav && s->cur_step == 2 && nav_stage == 0) {
+                nav_stage = 1;
+                action_at = now + 1000;
+                action_key = InputKeyRight;
+            } else if(script == ScriptNav && s->cur_step == 3 && nav_stage == 1) {
+                nav_stage = 2;
+                action_at = now + 1000;
+                action_key = InputKeyLeft;
+            }
+        }
+
+        // Reference clock: what an accurate timer would have counted
+        if(s->screen == ScreenBrewing && s->timer_state == TimerRunning) {
+            true_running++;
+            step_true++;
+            if(dur > 0 && step_true == dur * 1000U) deadline_at = now;
+        }
+        if(s->step_complete && !done_seen) {
+            done_seen = true;
+            if(deadline_at != 0) {
+                uint32_t lag = now - deadline_at;
+                if(lag > res.done_lag_ms) res.done_lag_ms = lag;
+            } else if(dur > 0) {
+                // Completed before the real deadline: record as early
+                uint32_t early = dur * 1000U - step_true;
+                if(early > res.done_lag_ms) res.done_lag_ms = early;
+            }
+        }
+
+        now++;
+    }
+
+    res.err_ms = (int32_t)app->s.total_elapsed_ms - (int32_t)true_running;
+    app_free(app);
+    return res;
+}
+
+// ============================================================
+// Report
+// ============================================================
+int main(int argc, char** argv) {
+    uint32_t seed = 1;
+    const char* only = NULL;
+    long max_err = -1;
+
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        else if(strcmp(argv[i], "--profile") == 0 && i + 1 < argc)
+            only = argv[++i];
+        else if(strcmp(argv[i], "--max-err") == 0 && i + 1 < argc)
+            max_err = strtol(argv[++i], NULL, 0);
+        else {
+            fprintf(stderr, "usage: %s [--seed N] [--profile ideal|load|heavy] [--max-err MS]\n", argv[0]);
+            return 2;
+        }
+    }
+    if(seed == 0) seed = 1;
+
+    int32_t worst = 0;
+    bool unfinished = false;
+
+    for(size_t p = 0; p < COUNT_OF(profiles); p++) {
+        const FaultProfile* fp = &profiles[p];
+        if(only && strcmp(only, fp->name) != 0) continue;
+
+        printf("profile %s: drop %u.%u%%, late %u.%u%% <=%ums, lock %u.%u%% <=%ums\n",
+            fp->name,
+            fp->drop_permille / 10, fp->drop_permille % 10,
+            fp->late_permille / 10, fp->late_permille % 10, fp->late_max_ms,
+            fp->lock_permille / 10, fp->lock_permille % 10, fp->lock_max_ms);
+        printf("%-24s", "recipe (err ms)");
+        for(int sc = 0; sc < ScriptCount; sc++) printf("%9s", script_names[sc]);
+        printf("%10s%10s\n", "done lag", "auto lag");
+
+        for(uint8_t m = 0; m < method_count; m++) {
+            for(uint8_t r = 0; r < methods[m].recipe_count; r++) {
+                char label[40];
+                snprintf(label, sizeof(label), "%s/%s", rstr(methods[m].name), rstr(methods[m].recipes[r].name));
+                printf("%-24.24s", label);
+
+                uint32_t done_lag = 0, auto_lag = 0;
+                for(int sc = 0; sc < ScriptCount; sc++) {
+                    rng_state = seed ^ (uint32_t)((m << 16) | (r << 8) | sc);
+                    if(rng_state == 0) rng_state = 1;
+                    SimResult res = simulate(m, r, (Script)sc, fp);
+                    if(!res.finished) {
+                        unfinished = true;
+                        printf("%9s", "stuck");
+                        continue;
+                    }
+                    printf("%9ld", (long)res.err_ms);
+                    int32_t a = res.err_ms < 0 ? -res.err_ms : res.err_ms;
+                    if(a > worst) worst = a;
+                    if(res.done_lag_ms > done_lag) done_lag = res.done_lag_ms;
+                    if(res.auto_lag_ms > auto_lag) auto_lag = res.auto_lag_ms;
+                }
+                printf("%10lu%10lu\n", (unsigned long)done_lag, (unsigned long)auto_lag);
+            }
+        }
+        printf("\n");
+    }
+
+    printf("worst |err|: %ld ms\n", (long)worst);
+    if(unfinished) return 1;
+    if(max_err >= 0 && worst > max_err) return 1;
+    return 0;
+}
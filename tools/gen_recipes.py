@@ -0,0 +1,251 @@
+#!/usr/bin/env python3
+"""Generate recipes.c from recipes.def.
+
+Every instruction, detail, name and step-type string goes into one shared
+pool, stored once; a string that is the tail of a longer one points into
+it. The structs hold 16-bit offsets into that pool instead of pointers,
+so the FAP carries no relocation per string and each step is 10 bytes.
+
+A REPEAT|n ... END block becomes one StepRepeat row ahead of its body
+(duration_sec = n, weight_grams = body rows), as in the .brew format.
+An optional 7th step field (chain, arm, confirm) overrides the advance
+policy the [types] section gives the step's type.
+
+  python3 tools/gen_recipes.py            rewrite recipes.c
+  python3 tools/gen_recipes.py --check    fail if recipes.c is stale
+"""
+
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEF_PATH = os.path.join(ROOT, "recipes.def")
+OUT_PATH = os.path.join(ROOT, "recipes.c")
+
+# Must match coffee_timer.h
+MAX_STEPS = 10
+MAX_REPEAT = 20
+ADVANCE = {None: "AdvanceDefault", "chain": "AdvanceChain", "arm": "AdvanceArm",
+           "confirm": "AdvanceConfirm"}
+
+
+class DefError(Exception):
+    pass
+
+
+def parse(path):
+    types = []          # (token, name, advance)
+    methods = []        # {"name", "recipes": [...]}
+    section = None
+    recipe = None
+
+    with open(path, encoding="utf-8") as f:
+        for no, raw in enumerate(f, 1):
+            line = raw.rstrip("\n")
+            where = "%s:%d" % (os.path.basename(path), no)
+            if not line.strip() or line.startswith("#"):
+                continue
+
+            m = re.fullmatch(r"\[(types|method|recipe)(?: (.+))?\]", line)
+            if m:
+                section = m.group(1)
+                if section == "method":
+                    methods.append({"name": m.group(2), "recipes": []})
+                elif section == "recipe":
+                    if not methods:
+                        raise DefError("%s: recipe outside a method" % where)
+                    recipe = {"name": m.group(2), "header": {}, "steps": [], "body": False}
+                    methods[-1]["recipes"].append(recipe)
+                continue
+
+            if section == "types":
+                token, name, adv = line.split("|")
+                if adv not in ADVANCE:
+                    raise DefError("%s: unknown advance %s" % (where, adv))
+                types.append((token, name, adv))
+            elif section == "recipe":
+                if line == "---":
+                    recipe["body"] = True
+                elif recipe["body"] and line == "END":
+                    block = recipe.get("open")
+                    if block is None:
+                        raise DefError("%s: END without REPEAT" % where)
+                    body = len(recipe["steps"]) - block - 1
+                    if body == 0:
+                        raise DefError("%s: empty repeat block" % where)
+                    tok, ins, det, times, _, wd, adv = recipe["steps"][block]
+                    recipe["steps"][block] = (tok, ins, det, times, body, wd, adv)
+                    recipe["open"] = None
+                elif recipe["body"] and line.startswith("REPEAT|"):
+                    if recipe.get("open") is not None:
+                        raise DefError("%s: repeat blocks don't nest" % where)
+                    times = int(line.split("|")[1])
+                    if not 2 <= times <= MAX_REPEAT:
+                        raise DefError("%s: repeat count out of range" % where)
+                    recipe["open"] = len(recipe["steps"])
+                    recipe["steps"].append(("REPEAT", "Repeat", "", times, 0, 0, None))
+                elif not recipe["body"]:
+                    key, _, val = line.partition("=")
+                    recipe["header"][key] = val
+                else:
+                    f = line.split("|")
+                    if len(f) not in (6, 7):
+                        raise DefError("%s: expected 6 or 7 fields" % where)
+                    tok, ins, det, dur, wt, ml = f[:6]
+                    adv = f[6] if len(f) == 7 else None
+                    if adv is not None and adv not in ADVANCE:
+                        raise DefError("%s: unknown advance %s" % (where, adv))
+                    if tok not in [t for t, _, _ in types]:
+                        raise DefError("%s: unknown step type %s" % (where, tok))
+                    ml = int(ml)
+                    if ml % 10 or ml // 10 > 255:
+                        raise DefError("%s: water %d ml not storable" % (where, ml))
+                    if int(wt) > 255 or int(dur) > 65535:
+                        raise DefError("%s: value out of range" % where)
+                    recipe["steps"].append((tok, ins, det, int(dur), int(wt), ml // 10, adv))
+            else:
+                raise DefError("%s: line outside a section" % where)
+
+    for m in methods:
+        for r in m["recipes"]:
+            for key in ("grind", "coffee", "water", "temp"):
+                if key not in r["header"]:
+                    raise DefError("%s/%s: missing %s" % (m["name"], r["name"], key))
+            if not r["steps"]:
+                raise DefError("%s/%s: no steps" % (m["name"], r["name"]))
+            if r.get("open") is not None:
+                raise DefError("%s/%s: REPEAT without END" % (m["name"], r["name"]))
+            if len(r["steps"]) > MAX_STEPS:
+                raise DefError("%s/%s: more than %d rows" % (m["name"], r["name"], MAX_STEPS))
+    return types, methods
+
+
+def build_pool(strings):
+    # Longest first, so a shorter string can land inside an earlier one
+    order = sorted(dict.fromkeys(strings), key=lambda s: -len(s))
+    placed = []     # (string, offset)
+    offsets = {}
+    size = 0
+    for s in order:
+        for t, off in placed:
+            if t.endswith(s):
+                offsets[s] = off + len(t) - len(s)
+                break
+        else:
+            offsets[s] = size
+            placed.append((s, size))
+            size += len(s) + 1
+    if size > 0xFFFF:
+        raise DefError("string pool too large: %d bytes" % size)
+    return placed, offsets, size
+
+
+def c_str(s):
+    return '"' + s.replace("\\", "\\\\").replace('"', '\\"') + '\\0"'
+
+
+def slug(s):
+    return re.sub(r"[^a-z0-9]+", "_", s.lower()).strip("_")
+
+
+def generate(types, methods):
+    strings = []
+    for token, name, _ in types:
+        strings += [token, name]
+    for m in methods:
+        strings.append(m["name"])
+        for r in m["recipes"]:
+            strings += [r["name"], r["header"]["grind"]]
+            for st in r["steps"]:
+                strings += [st[1], st[2]]
+    placed, off, size = build_pool(strings)
+    literal_bytes = sum(len(s) + 1 for s in strings)
+    enum_of = {token: "Step" + name for token, name, _ in types}
+
+    o = []
+    o.append("// Generated by tools/gen_recipes.py from recipes.def. Do not edit.")
+    o.append("// %d strings in %d bytes (%d as separate literals)" % (len(strings), size, literal_bytes))
+    o.append('#include "coffee_timer.h"')
+    o.append("")
+    o.append("// " + "=" * 64)
+    o.append("// STRINGS")
+    o.append("// " + "=" * 64)
+    o.append("const char recipe_strings[] =")
+    for s, at in placed:
+        o.append("    /* %4d */ %s" % (at, c_str(s)))
+    o.append("    ;")
+    o.append("")
+    o.append("// " + "=" * 64)
+    o.append("// STEP TYPES")
+    o.append("// " + "=" * 64)
+    o.append("const StepTypeInfo step_types[StepTypeCount] = {")
+    for token, name, adv in types:
+        o.append("    [%s] = {%d, %d, %s}," % (enum_of[token], off[token], off[name], ADVANCE[adv]))
+    o.append("};")
+
+    seen = set()
+    for m in methods:
+        o.append("")
+        o.append("// " + "=" * 64)
+        o.append("// " + m["name"].upper())
+        o.append("// " + "=" * 64)
+        names = []
+        for r in m["recipes"]:
+            ident = "%s_%s_steps" % (slug(m["name"]), slug(r["name"]))
+            if ident in seen:
+                raise DefError("duplicate recipe %s/%s" % (m["name"], r["name"]))
+            seen.add(ident)
+            names.append(ident)
+            o.append("static const BrewStep %s[] = {" % ident)
+            for tok, ins, det, dur, wt, wd, adv in r["steps"]:
+                if tok == "REPEAT":
+                    o.append("    {%4d, %4d, %3d, %3d, %3d, %s, %s}, // repeat next %d x%d" % (
+                        off[ins], off[det], dur, wt, wd, enum_of[tok], ADVANCE[adv], wt, dur))
+                    continue
+                o.append("    {%4d, %4d, %3d, %3d, %3d, %s, %s}, // %s | %s" % (
+                    off[ins], off[det], dur, wt, wd, enum_of[tok], ADVANCE[adv], ins, det))
+            o.append("};")
+        m["array"] = "%s_recipes" % slug(m["name"])
+        o.append("static const Recipe %s[] = {" % m["array"])
+        for r, ident in zip(m["recipes"], names):
+            h = r["header"]
+            o.append("    {%4d, %4d, %s, %s, %s, %s, %d}, // %s" % (
+                off[r["name"]], off[h["grind"]], ident,
+                h["water"], h["temp"], h["coffee"], len(r["steps"]), r["name"]))
+        o.append("};")
+
+    o.append("")
+    o.append("// " + "=" * 64)
+    o.append("// METHODS")
+    o.append("// " + "=" * 64)
+    o.append("const BrewMethod methods[] = {")
+    for m in methods:
+        o.append("    {%4d, %s, %d}, // %s" % (off[m["name"]], m["array"], len(m["recipes"]), m["name"]))
+    o.append("};")
+    o.append("const uint8_t method_count = sizeof(methods) / sizeof(methods[0]);")
+    return "\n".join(o) + "\n"
+
+
+def main(argv):
+    check = "--check" in argv[1:]
+    try:
+        text = generate(*parse(DEF_PATH))
+    except (DefError, ValueError) as e:
+        print("gen_recipes: %s" % e, file=sys.stderr)
+        return 2
+
+    if check:
+        with open(OUT_PATH, encoding="utf-8") as f:
+            if f.read() != text:
+                print("gen_recipes: recipes.c is out of date", file=sys.stderr)
+                return 1
+        return 0
+
+    with open(OUT_PATH, "w", encoding="utf-8") as f:
+        f.write(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,297 @@
+#include "canvas_fb.h"
+#include <coffee_timer_icons.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FB_MAX_TEXT 32
+
+struct Icon {
+    uint8_t unused;
+};
+
+const Icon I_CoffeeCup_20x20;
+
+typedef struct {
+    int32_t x0, y0, x1, y1;
+} TextBox;
+
+struct Canvas {
+    uint8_t px[FB_HEIGHT][FB_WIDTH / 8];
+    Color color;
+    Font font;
+    uint32_t clipped;
+    TextBox text[FB_MAX_TEXT];
+    uint8_t text_count;
+};
+
+// ============================================================
+// Glyphs: 5x7, column-major, bit 0 = top row, ASCII 32..126
+// ============================================================
+static const uint8_t glyphs[95][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00},
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},
+    {0x36, 0x49, 0x55, 0x22, 0x50}, {0x00, 0x05, 0x03, 0x00, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00},
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x08, 0x2A, 0x1C, 0x2A, 0x08}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+    {0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x60, 0x60, 0x00, 0x00},
+    {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},
+    {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31}, {0x18, 0x14, 0x12, 0x7F, 0x10},
+    {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03},
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x36, 0x36, 0x00, 0x00},
+    {0x00, 0x56, 0x36, 0x00, 0x00}, {0x00, 0x08, 0x14, 0x22, 0x41}, {0x14, 0x14, 0x14, 0x14, 0x14},
+    {0x41, 0x22, 0x14, 0x08, 0x00}, {0x02, 0x01, 0x51, 0x09, 0x06}, {0x32, 0x49, 0x79, 0x41, 0x3E},
+    {0x7E, 0x11, 0x11, 0x11, 0x7E}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x01, 0x01},
+    {0x3E, 0x41, 0x41, 0x51, 0x32}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40},
+    {0x7F, 0x02, 0x04, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46},
+    {0x46, 0x49, 0x49, 0x49, 0x31}, {0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x40, 0x40, 0x3F},
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x7F, 0x20, 0x18, 0x20, 0x7F}, {0x63, 0x14, 0x08, 0x14, 0x63},
+    {0x03, 0x04, 0x78, 0x04, 0x03}, {0x61, 0x51, 0x49, 0x45, 0x43}, {0x00, 0x00, 0x7F, 0x41, 0x41},
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x41, 0x41, 0x7F, 0x00, 0x00}, {0x04, 0x02, 0x01, 0x02, 0x04},
+    {0x40, 0x40, 0x40, 0x40, 0x40}, {0x00, 0x01, 0x02, 0x04, 0x00}, {0x20, 0x54, 0x54, 0x54, 0x78},
+    {0x7F, 0x48, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x20}, {0x38, 0x44, 0x44, 0x48, 0x7F},
+    {0x38, 0x54, 0x54, 0x54, 0x18}, {0x08, 0x7E, 0x09, 0x01, 0x02}, {0x08, 0x14, 0x54, 0x54, 0x3C},
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x44, 0x3D, 0x00},
+    {0x00, 0x7F, 0x10, 0x28, 0x44}, {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x18, 0x04, 0x78},
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, {0x7C, 0x14, 0x14, 0x14, 0x08},
+    {0x08, 0x14, 0x14, 0x18, 0x7C}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x20},
+    {0x04, 0x3F, 0x44, 0x40, 0x20}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C},
+    {0x3C, 0x40, 0x30, 0x40, 0x3C}, {0x44, 0x28, 0x10, 0x28, 0x44}, {0x0C, 0x50, 0x50, 0x50, 0x3C},
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, {0x00, 0x00, 0x7F, 0x00, 0x00},
+    {0x00, 0x41, 0x36, 0x08, 0x00}, {0x08, 0x08, 0x2A, 0x1C, 0x08},
+};
+
+static const uint8_t* glyph(char ch) {
+    if(ch < 32 || ch > 126) ch = '?';
+    return glyphs[ch - 32];
+}
+
+// Used columns of a glyph; space keeps a fixed width
+static void glyph_span(const uint8_t* g, uint8_t* first, uint8_t* width) {
+    uint8_t lo = 0, hi = 4;
+    while(lo < 5 && g[lo] == 0) lo++;
+    if(lo == 5) {
+        *first = 0;
+        *width = 2;
+        return;
+    }
+    while(g[hi] == 0) hi--;
+    *first = lo;
+    *width = (uint8_t)(hi - lo + 1);
+}
+
+// Per font: glyph scale, extra bold column, ascent used for AlignTop
+typedef struct {
+    uint8_t scale;
+    uint8_t bold;
+    uint8_t height;
+} FontMetrics;
+
+static const FontMetrics font_metrics[FontTotalNumber] = {
+    [FontPrimary] = {1, 1, 8},
+    [FontSecondary] = {1, 0, 7},
+    [FontKeyboard] = {1, 0, 7},
+    [FontBigNumbers] = {2, 0, 14},
+};
+
+static const FontMetrics* metrics(const Canvas* c) {
+    return &font_metrics[c->font < FontTotalNumber ? c->font : FontSecondary];
+}
+
+// ============================================================
+// Pixels
+// ============================================================
+static bool fb_set(Canvas* c, int32_t x, int32_t y) {
+    if(x < 0 || y < 0 || x >= FB_WIDTH || y >= FB_HEIGHT) return false;
+    uint8_t bit = (uint8_t)(0x80 >> (x & 7));
+    uint8_t* p = &c->px[y][x >> 3];
+    if(c->color == ColorBlack) *p |= bit;
+    else if(c->color == ColorWhite) *p &= (uint8_t)~bit;
+    else *p ^= bit;
+    return true;
+}
+
+Canvas* canvas_fb_alloc(void) {
+    Canvas* c = calloc(1, sizeof(Canvas));
+    c->color = ColorBlack;
+    c->font = FontSecondary;
+    return c;
+}
+
+void canvas_fb_free(Canvas* canvas) {
+    free(canvas);
+}
+
+uint64_t canvas_fb_hash(const Canvas* canvas) {
+    uint64_t h = 14695981039346656037ULL;
+    const uint8_t* p = &canvas->px[0][0];
+    for(size_t i = 0; i < sizeof(canvas->px); i++) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+uint32_t canvas_fb_clipped(const Canvas* canvas) {
+    return canvas->clipped;
+}
+
+uint32_t canvas_fb_overlaps(const Canvas* canvas) {
+    uint32_t n = 0;
+    for(uint8_t i = 0; i < canvas->text_count; i++) {
+        const TextBox* a = &canvas->text[i];
+        for(uint8_t j = i + 1; j < canvas->text_count; j++) {
+            const TextBox* b = &canvas->text[j];
+            if(a->x0 < b->x1 && b->x0 < a->x1 && a->y0 < b->y1 && b->y0 < a->y1) n++;
+        }
+    }
+    return n;
+}
+
+bool canvas_fb_write_pbm(const Canvas* canvas, const char* path) {
+    FILE* fp = fopen(path, "wb");
+    if(!fp) return false;
+    fprintf(fp, "P4\n%d %d\n", FB_WIDTH, FB_HEIGHT);
+    fwrite(canvas->px, 1, sizeof(canvas->px), fp);
+    fclose(fp);
+    return true;
+}
+
+// ============================================================
+// Canvas API
+// ============================================================
+void canvas_clear(Canvas* canvas) {
+    memset(canvas->px, 0, sizeof(canvas->px));
+    canvas->color = ColorBlack;
+    canvas->clipped = 0;
+    canvas->text_count = 0;
+}
+
+void canvas_set_font(Canvas* canvas, Font font) {
+    canvas->font = font;
+}
+
+void canvas_set_color(Canvas* canvas, Color color) {
+    canvas->color = color;
+}
+
+uint16_t canvas_string_width(Canvas* canvas, const char* str) {
+    const FontMetrics* fm = metrics(canvas);
+    uint16_t w = 0;
+    for(; *str; str++) {
+        uint8_t first, width;
+        glyph_span(glyph(*str), &first, &width);
+        w += (uint16_t)((width + fm->bold + 1) * fm->scale);
+    }
+    return w;
+}
+
+// y is the baseline: the glyph's bottom row sits on it
+void canvas_draw_str(Canvas* canvas, int32_t x, int32_t y, const char* str) {
+    const FontMetrics* fm = metrics(canvas);
+    int32_t top = y - 7 * fm->scale + 1;
+    int32_t x0 = x;
+
+    for(; *str; str++) {
+        const uint8_t* g = glyph(*str);
+        uint8_t first, width;
+        glyph_span(g, &first, &width);
+        for(uint8_t col = 0; col < width + fm->bold; col++) {
+            uint8_t bits = 0;
+            if(col < width) bits |= g[first + col];
+            if(fm->bold && col > 0) bits |= g[first + col - 1];
+            for(uint8_t row = 0; row < 7; row++) {
+                if(!(bits & (1 << row))) continue;
+                for(uint8_t sy = 0; sy < fm->scale; sy++)
+                    for(uint8_t sx = 0; sx < fm->scale; sx++)
+                        if(!fb_set(canvas, x + col * fm->scale + sx, top + row * fm->scale + sy))
+                            canvas->clipped++;
+            }
+        }
+        x += (width + fm->bold + 1) * fm->scale;
+    }
+
+    if(canvas->text_count < FB_MAX_TEXT && x > x0) {
+        // Box excludes the trailing advance gap
+        canvas->text[canvas->text_count++] = (TextBox){x0, top, x - fm->scale, y + 1};
+    }
+}
+
+void canvas_draw_str_aligned(
+    Canvas* canvas, int32_t x, int32_t y, Align horizontal, Align vertical, const char* str) {
+    int32_t w = canvas_string_width(canvas, str);
+    int32_t h = metrics(canvas)->height;
+    if(horizontal == AlignRight) x -= w;
+    else if(horizontal == AlignCenter) x -= w / 2;
+    if(vertical == AlignTop) y += h;
+    else if(vertical == AlignCenter) y += h / 2;
+    canvas_draw_str(canvas, x, y, str);
+}
+
+void canvas_draw_line(Canvas* canvas, int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+    int32_t dx = abs(x2 - x1), sx = x1 < x2 ? 1 : -1;
+    int32_t dy = -abs(y2 - y1), sy = y1 < y2 ? 1 : -1;
+    int32_t err = dx + dy;
+    while(true) {
+        fb_set(canvas, x1, y1);
+        if(x1 == x2 && y1 == y2) break;
+        int32_t e2 = 2 * err;
+        if(e2 >= dy) { err += dy; x1 += sx; }
+        if(e2 <= dx) { err += dx; y1 += sy; }
+    }
+}
+
+void canvas_draw_box(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height) {
+    for(int32_t j = 0; j < (int32_t)height; j++)
+        for(int32_t i = 0; i < (int32_t)width; i++) fb_set(canvas, x + i, y + j);
+
+    // A white box (dialog background) hides the text under it
+    if(canvas->color != ColorWhite) return;
+    int32_t x1 = x + (int32_t)width, y1 = y + (int32_t)height;
+    uint8_t kept = 0;
+    for(uint8_t i = 0; i < canvas->text_count; i++) {
+        const TextBox* t = &canvas->text[i];
+        if(t->x0 < x1 && x < t->x1 && t->y0 < y1 && y < t->y1) continue;
+        canvas->text[kept++] = *t;
+    }
+    canvas->text_count = kept;
+}
+
+void canvas_draw_frame(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height) {
+    if(width == 0 || height == 0) return;
+    int32_t x2 = x + (int32_t)width - 1, y2 = y + (int32_t)height - 1;
+    canvas_draw_line(canvas, x, y, x2, y);
+    canvas_draw_line(canvas, x, y2, x2, y2);
+    if(height > 2) {
+        canvas_draw_line(canvas, x, y + 1, x, y2 - 1);
+        canvas_draw_line(canvas, x2, y + 1, x2, y2 - 1);
+    }
+}
+
+// Corners are cut diagonally rather than arced
+void canvas_draw_rframe(
+    Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height, size_t radius) {
+    int32_t r = (int32_t)radius;
+    if(2 * r >= (int32_t)width || 2 * r >= (int32_t)height) r = 0;
+    int32_t x2 = x + (int32_t)width - 1, y2 = y + (int32_t)height - 1;
+    canvas_draw_line(canvas, x + r, y, x2 - r, y);
+    canvas_draw_line(canvas, x + r, y2, x2 - r, y2);
+    canvas_draw_line(canvas, x, y + r, x, y2 - r);
+    canvas_draw_line(canvas, x2, y + r, x2, y2 - r);
+    if(r > 0) {
+        canvas_draw_line(canvas, x, y + r - 1, x + r - 1, y);
+        canvas_draw_line(canvas, x2 - r + 1, y, x2, y + r - 1);
+        canvas_draw_line(canvas, x, y2 - r + 1, x + r - 1, y2);
+        canvas_draw_line(canvas, x2 - r + 1, y2, x2, y2 - r + 1);
+    }
+}
+
+// The only icon is 20x20; a crossed frame marks where it lands
+void canvas_draw_icon(Canvas* canvas, int32_t x, int32_t y, const Icon* icon) {
+    UNUSED(icon);
+    canvas_draw_frame(canvas, x, y, 20, 20);
+    canvas_draw_line(canvas, x, y, x + 19, y + 19);
+    canvas_draw_line(canvas, x + 19, y, x, y + 19);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+// 128x64 1-bit framebuffer canvas for host tools that need pixels.
+// Link canvas_fb.c instead of canvas_host.c.
+//
+// Glyphs are a 5x7 set with proportional advances standing in for the
+// device fonts, so widths are close to the real ones but not exact.
+
+#include <gui/gui.h>
+
+#define FB_WIDTH 128
+#define FB_HEIGHT 64
+
+Canvas* canvas_fb_alloc(void);
+void canvas_fb_free(Canvas* canvas);
+
+// FNV-1a over the framebuffer
+uint64_t canvas_fb_hash(const Canvas* canvas);
+
+// Since the last canvas_clear: text pixels that fell off the screen, and
+// pairs of strings whose boxes intersect
+uint32_t canvas_fb_clipped(const Canvas* canvas);
+uint32_t canvas_fb_overlaps(const Canvas* canvas);
+
+bool canvas_fb_write_pbm(const Canvas* canvas, const char* path);
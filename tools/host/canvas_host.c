@@ -0,0 +1,77 @@
+#include <gui/gui.h>
+#include <coffee_timer_icons.h>
+
+// Draw calls are accepted and discarded; tools that need pixels link
+// their own canvas instead.
+
+struct Icon {
+    uint8_t unused;
+};
+
+const Icon I_CoffeeCup_20x20;
+
+void canvas_clear(Canvas* canvas) {
+    UNUSED(canvas);
+}
+
+void canvas_set_font(Canvas* canvas, Font font) {
+    UNUSED(canvas);
+    UNUSED(font);
+}
+
+void canvas_set_color(Canvas* canvas, Color color) {
+    UNUSED(canvas);
+    UNUSED(color);
+}
+
+void canvas_draw_str(Canvas* canvas, int32_t x, int32_t y, const char* str) {
+    UNUSED(canvas);
+    UNUSED(x);
+    UNUSED(y);
+    UNUSED(str);
+}
+
+void canvas_draw_str_aligned(
+    Canvas* canvas, int32_t x, int32_t y, Align horizontal, Align vertical, const char* str) {
+    UNUSED(horizontal);
+    UNUSED(vertical);
+    canvas_draw_str(canvas, x, y, str);
+}
+
+void canvas_draw_line(Canvas* canvas, int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+    UNUSED(canvas);
+    UNUSED(x1);
+    UNUSED(y1);
+    UNUSED(x2);
+    UNUSED(y2);
+}
+
+void canvas_draw_box(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height) {
+    UNUSED(canvas);
+    UNUSED(x);
+    UNUSED(y);
+    UNUSED(width);
+    UNUSED(height);
+}
+
+void canvas_draw_frame(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height) {
+    canvas_draw_box(canvas, x, y, width, height);
+}
+
+void canvas_draw_rframe(
+    Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height, size_t radius) {
+    UNUSED(radius);
+    canvas_draw_box(canvas, x, y, width, height);
+}
+
+void canvas_draw_icon(Canvas* canvas, int32_t x, int32_t y, const Icon* icon) {
+    UNUSED(canvas);
+    UNUSED(x);
+    UNUSED(y);
+    UNUSED(icon);
+}
+
+uint16_t canvas_string_width(Canvas* canvas, const char* str) {
+    UNUSED(canvas);
+    return (uint16_t)(strlen(str) * 5);
+}
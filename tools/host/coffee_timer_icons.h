@@ -0,0 +1,5 @@
+#pragma once
+
+#include <gui/gui.h>
+
+extern const Icon I_CoffeeCup_20x20;
@@ -0,0 +1,8 @@
+#pragma once
+
+#define RECORD_EXPANSION "expansion"
+
+typedef struct Expansion Expansion;
+
+void expansion_enable(Expansion* instance);
+void expansion_disable(Expansion* instance);
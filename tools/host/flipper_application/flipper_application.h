@@ -0,0 +1,11 @@
+#pragma once
+
+#include <furi.h>
+
+typedef struct {
+    const char* appid;
+    uint32_t ep_api_version;
+    const void* entry_point;
+} FlipperAppPluginDescriptor;
+
+typedef struct ElfApiInterface ElfApiInterface;
@@ -0,0 +1,81 @@
+#pragma once
+
+// Host stand-in for the subset of furi used by the app. Time is a virtual
+// millisecond clock advanced by the tool driving the app (see host.h).
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define UNUSED(x) (void)(x)
+#define FuriWaitForever 0xFFFFFFFFU
+#define APP_DATA_PATH(path) "/data/" path
+#define APP_ASSETS_PATH(path) "/assets/" path
+#define COUNT_OF(x) (sizeof(x) / sizeof(x[0]))
+
+#define FURI_LOG_E(tag, fmt, ...) ((void)0)
+#define FURI_LOG_W(tag, fmt, ...) ((void)0)
+#define FURI_LOG_I(tag, fmt, ...) ((void)0)
+#define FURI_LOG_D(tag, fmt, ...) ((void)0)
+
+typedef enum {
+    FuriStatusOk = 0,
+    FuriStatusError = -1,
+    FuriStatusErrorTimeout = -2,
+    FuriStatusErrorResource = -3,
+} FuriStatus;
+
+typedef enum {
+    FuriMutexTypeNormal,
+    FuriMutexTypeRecursive,
+} FuriMutexType;
+
+typedef enum {
+    FuriTimerTypeOnce,
+    FuriTimerTypePeriodic,
+} FuriTimerType;
+
+typedef struct FuriMutex FuriMutex;
+typedef struct FuriMessageQueue FuriMessageQueue;
+typedef struct FuriTimer FuriTimer;
+typedef struct FuriThread FuriThread;
+typedef void* FuriThreadId;
+typedef void (*FuriTimerCallback)(void* context);
+typedef int32_t (*FuriThreadCallback)(void* context);
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type);
+void furi_mutex_free(FuriMutex* mutex);
+FuriStatus furi_mutex_acquire(FuriMutex* mutex, uint32_t timeout);
+FuriStatus furi_mutex_release(FuriMutex* mutex);
+
+FuriMessageQueue* furi_message_queue_alloc(uint32_t msg_count, uint32_t msg_size);
+void furi_message_queue_free(FuriMessageQueue* queue);
+FuriStatus furi_message_queue_put(FuriMessageQueue* queue, const void* msg, uint32_t timeout);
+FuriStatus furi_message_queue_get(FuriMessageQueue* queue, void* msg, uint32_t timeout);
+uint32_t furi_message_queue_get_count(FuriMessageQueue* queue);
+
+FuriTimer* furi_timer_alloc(FuriTimerCallback callback, FuriTimerType type, void* context);
+void furi_timer_free(FuriTimer* timer);
+FuriStatus furi_timer_start(FuriTimer* timer, uint32_t ticks);
+FuriStatus furi_timer_stop(FuriTimer* timer);
+
+FuriThread* furi_thread_alloc_ex(
+    const char* name, uint32_t stack_size, FuriThreadCallback callback, void* context);
+void furi_thread_free(FuriThread* thread);
+void furi_thread_start(FuriThread* thread);
+bool furi_thread_join(FuriThread* thread);
+FuriThreadId furi_thread_get_current_id(void);
+uint32_t furi_thread_get_stack_space(FuriThreadId thread_id);
+
+uint32_t furi_get_tick(void);
+uint32_t furi_ms_to_ticks(uint32_t ms);
+void furi_delay_ms(uint32_t ms);
+
+void* furi_record_open(const char* name);
+void furi_record_close(const char* name);
+
+size_t memmgr_get_free_heap(void);
+size_t memmgr_get_minimum_free_heap(void);
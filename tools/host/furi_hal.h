@@ -0,0 +1,15 @@
+#pragma once
+
+#include <furi.h>
+
+// Cycle counter, kept in step with the virtual clock at 64 MHz
+typedef struct {
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+extern DWT_Type* DWT;
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void);
+
+// Wall clock: a fixed date plus virtual time, so runs repeat
+uint32_t furi_hal_rtc_get_timestamp(void);
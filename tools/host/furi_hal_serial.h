@@ -0,0 +1,29 @@
+#pragma once
+
+#include <furi.h>
+
+typedef enum {
+    FuriHalSerialIdUsart,
+    FuriHalSerialIdLpuart,
+    FuriHalSerialIdMax,
+} FuriHalSerialId;
+
+typedef enum {
+    FuriHalSerialRxEventData = (1 << 0),
+    FuriHalSerialRxEventIdle = (1 << 1),
+    FuriHalSerialRxEventFrameError = (1 << 2),
+    FuriHalSerialRxEventNoiseError = (1 << 3),
+    FuriHalSerialRxEventOverrunError = (1 << 4),
+} FuriHalSerialRxEvent;
+
+typedef struct FuriHalSerialHandle FuriHalSerialHandle;
+
+typedef void (*FuriHalSerialAsyncRxCallback)(
+    FuriHalSerialHandle* handle, FuriHalSerialRxEvent event, void* context);
+
+void furi_hal_serial_init(FuriHalSerialHandle* handle, uint32_t baud);
+void furi_hal_serial_deinit(FuriHalSerialHandle* handle);
+void furi_hal_serial_async_rx_start(
+    FuriHalSerialHandle* handle, FuriHalSerialAsyncRxCallback callback, void* context, bool report_errors);
+void furi_hal_serial_async_rx_stop(FuriHalSerialHandle* handle);
+uint8_t furi_hal_serial_async_rx(FuriHalSerialHandle* handle);
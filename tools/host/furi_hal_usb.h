@@ -0,0 +1,12 @@
+#pragma once
+
+#include <furi.h>
+
+typedef struct FuriHalUsbInterface FuriHalUsbInterface;
+
+extern FuriHalUsbInterface usb_cdc_single;
+extern FuriHalUsbInterface usb_cdc_dual;
+
+FuriHalUsbInterface* furi_hal_usb_get_config(void);
+bool furi_hal_usb_set_config(FuriHalUsbInterface* new_if, void* ctx);
+bool furi_hal_usb_is_locked(void);
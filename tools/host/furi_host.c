@@ -0,0 +1,658 @@
+#include "host.h"
+#include <furi_hal.h>
+#include <furi_hal_usb_cdc.h>
+#include <furi_hal_serial_control.h>
+#include <expansion/expansion.h>
+#include <loader/firmware_api/firmware_api.h>
+#include <flipper_application/plugins/plugin_manager.h>
+#include <gui/gui.h>
+#include <notification/notification_messages.h>
+#include <storage/storage.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ============================================================
+// Clock
+// ============================================================
+static uint32_t host_ms;
+static DWT_Type host_dwt;
+DWT_Type* DWT = &host_dwt;
+
+void host_clock_set(uint32_t ms) {
+    host_ms = ms;
+    host_dwt.CYCCNT = ms * 64000U;
+}
+
+void host_clock_advance(uint32_t ms) {
+    host_clock_set(host_ms + ms);
+}
+
+uint32_t furi_get_tick(void) {
+    return host_ms;
+}
+
+uint32_t furi_ms_to_ticks(uint32_t ms) {
+    return ms;
+}
+
+void furi_delay_ms(uint32_t ms) {
+    host_clock_advance(ms);
+}
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void) {
+    return 64;
+}
+
+uint32_t furi_hal_rtc_get_timestamp(void) {
+    return 1767225600u + host_ms / 1000;   // 2026-01-01
+}
+
+// ============================================================
+// Mutex
+// ============================================================
+struct FuriMutex {
+    bool held;
+};
+
+static uint32_t mutex_fail_count;
+
+void host_mutex_fail_next(uint32_t count) {
+    mutex_fail_count = count;
+}
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type) {
+    UNUSED(type);
+    return calloc(1, sizeof(FuriMutex));
+}
+
+void furi_mutex_free(FuriMutex* mutex) {
+    free(mutex);
+}
+
+FuriStatus furi_mutex_acquire(FuriMutex* mutex, uint32_t timeout) {
+    if(mutex->held) return FuriStatusErrorTimeout;
+    if(timeout != FuriWaitForever && mutex_fail_count > 0) {
+        mutex_fail_count--;
+        return FuriStatusErrorTimeout;
+    }
+    mutex->held = true;
+    return FuriStatusOk;
+}
+
+FuriStatus furi_mutex_release(FuriMutex* mutex) {
+    if(!mutex->held) return FuriStatusError;
+    mutex->held = false;
+    return FuriStatusOk;
+}
+
+// ============================================================
+// Message queue (single threaded: never blocks)
+// ============================================================
+struct FuriMessageQueue {
+    uint8_t* buf;
+    uint32_t msg_size;
+    uint32_t capacity;
+    uint32_t head;
+    uint32_t count;
+};
+
+FuriMessageQueue* furi_message_queue_alloc(uint32_t msg_count, uint32_t msg_size) {
+    FuriMessageQueue* q = calloc(1, sizeof(FuriMessageQueue));
+    q->buf = calloc(msg_count, msg_size);
+    q->msg_size = msg_size;
+    q->capacity = msg_count;
+    return q;
+}
+
+void furi_message_queue_free(FuriMessageQueue* queue) {
+    free(queue->buf);
+    free(queue);
+}
+
+FuriStatus furi_message_queue_put(FuriMessageQueue* queue, const void* msg, uint32_t timeout) {
+    UNUSED(timeout);
+    if(queue->count == queue->capacity) return FuriStatusErrorResource;
+    uint32_t tail = (queue->head + queue->count) % queue->capacity;
+    memcpy(queue->buf + tail * queue->msg_size, msg, queue->msg_size);
+    queue->count++;
+    return FuriStatusOk;
+}
+
+FuriStatus furi_message_queue_get(FuriMessageQueue* queue, void* msg, uint32_t timeout) {
+    UNUSED(timeout);
+    if(queue->count == 0) return FuriStatusErrorTimeout;
+    memcpy(msg, queue->buf + queue->head * queue->msg_size, queue->msg_size);
+    queue->head = (queue->head + 1) % queue->capacity;
+    queue->count--;
+    return FuriStatusOk;
+}
+
+uint32_t furi_message_queue_get_count(FuriMessageQueue* queue) {
+    return queue->count;
+}
+
+// ============================================================
+// Timers and threads: tools call the callbacks themselves
+// ============================================================
+struct FuriTimer {
+    FuriTimerCallback callback;
+    void* context;
+    bool started;
+    uint32_t due;               // clock time of the next expiry
+};
+
+FuriTimer* furi_timer_alloc(FuriTimerCallback callback, FuriTimerType type, void* context) {
+    UNUSED(type);
+    FuriTimer* t = calloc(1, sizeof(FuriTimer));
+    t->callback = callback;
+    t->context = context;
+    return t;
+}
+
+void furi_timer_free(FuriTimer* timer) {
+    free(timer);
+}
+
+FuriStatus furi_timer_start(FuriTimer* timer, uint32_t ticks) {
+    timer->started = true;
+    timer->due = furi_get_tick() + ticks;
+    return FuriStatusOk;
+}
+
+FuriStatus furi_timer_stop(FuriTimer* timer) {
+    timer->started = false;
+    return FuriStatusOk;
+}
+
+bool host_timer_due(FuriTimer* timer) {
+    if(!timer->started || (int32_t)(furi_get_tick() - timer->due) < 0) return false;
+    timer->started = false;
+    return true;
+}
+
+struct FuriThread {
+    FuriThreadCallback callback;
+    void* context;
+};
+
+FuriThread* furi_thread_alloc_ex(
+    const char* name, uint32_t stack_size, FuriThreadCallback callback, void* context) {
+    UNUSED(name);
+    UNUSED(stack_size);
+    FuriThread* t = calloc(1, sizeof(FuriThread));
+    t->callback = callback;
+    t->context = context;
+    return t;
+}
+
+void furi_thread_free(FuriThread* thread) {
+    free(thread);
+}
+
+void furi_thread_start(FuriThread* thread) {
+    UNUSED(thread);
+}
+
+bool furi_thread_join(FuriThread* thread) {
+    UNUSED(thread);
+    return true;
+}
+
+FuriThreadId furi_thread_get_current_id(void) {
+    return NULL;
+}
+
+uint32_t furi_thread_get_stack_space(FuriThreadId thread_id) {
+    UNUSED(thread_id);
+    return 0;
+}
+
+// ============================================================
+// Records, heap
+// ============================================================
+static uint8_t host_record;
+
+void* furi_record_open(const char* name) {
+    UNUSED(name);
+    return &host_record;
+}
+
+void furi_record_close(const char* name) {
+    UNUSED(name);
+}
+
+size_t memmgr_get_free_heap(void) {
+    return 0;
+}
+
+size_t memmgr_get_minimum_free_heap(void) {
+    return 0;
+}
+
+// ============================================================
+// Notifications
+// ============================================================
+struct NotificationMessage {
+    uint8_t id;
+};
+
+const NotificationMessage message_red_255, message_red_0;
+const NotificationMessage message_green_255, message_green_0;
+const NotificationMessage message_delay_50, message_delay_100;
+const NotificationMessage message_note_c7, message_note_e7, message_sound_off;
+const NotificationMessage message_vibro_on, message_vibro_off;
+
+const NotificationSequence sequence_single_vibro = {&message_vibro_on, NULL};
+const NotificationSequence sequence_double_vibro = {&message_vibro_on, NULL};
+const NotificationSequence sequence_display_backlight_enforce_on = {NULL};
+const NotificationSequence sequence_display_backlight_enforce_auto = {NULL};
+
+static uint32_t notification_count;
+
+uint32_t host_notification_count(void) {
+    return notification_count;
+}
+
+void notification_message(NotificationApp* app, const NotificationSequence* sequence) {
+    UNUSED(app);
+    UNUSED(sequence);
+    notification_count++;
+}
+
+void notification_message_block(NotificationApp* app, const NotificationSequence* sequence) {
+    notification_message(app, sequence);
+}
+
+// ============================================================
+// Input
+// ============================================================
+const char* input_get_key_name(InputKey key) {
+    static const char* names[InputKeyMAX] = {"Up", "Down", "Right", "Left", "OK", "Back"};
+    return key < InputKeyMAX ? names[key] : "Unknown";
+}
+
+const char* input_get_type_name(InputType type) {
+    static const char* names[InputTypeMAX] = {"Press", "Release", "Short", "Long", "Repeat"};
+    return type < InputTypeMAX ? names[type] : "Unknown";
+}
+
+// ============================================================
+// View port
+// ============================================================
+struct ViewPort {
+    uint8_t unused;
+};
+
+ViewPort* view_port_alloc(void) {
+    return calloc(1, sizeof(ViewPort));
+}
+
+void view_port_free(ViewPort* view_port) {
+    free(view_port);
+}
+
+void view_port_draw_callback_set(ViewPort* view_port, ViewPortDrawCallback callback, void* context) {
+    UNUSED(view_port);
+    UNUSED(callback);
+    UNUSED(context);
+}
+
+void view_port_input_callback_set(
+    ViewPort* view_port, ViewPortInputCallback callback, void* context) {
+    UNUSED(view_port);
+    UNUSED(callback);
+    UNUSED(context);
+}
+
+void view_port_update(ViewPort* view_port) {
+    UNUSED(view_port);
+}
+
+void gui_add_view_port(Gui* gui, ViewPort* view_port, GuiLayer layer) {
+    UNUSED(gui);
+    UNUSED(view_port);
+    UNUSED(layer);
+}
+
+void gui_remove_view_port(Gui* gui, ViewPort* view_port) {
+    UNUSED(gui);
+    UNUSED(view_port);
+}
+
+// ============================================================
+// Storage: APP_DATA_PATH("") maps onto a host directory
+// ============================================================
+struct File {
+    FILE* fp;
+    DIR* dir;
+    char dir_path[256];
+};
+
+static const char* storage_root;
+
+void host_storage_set_root(const char* dir) {
+    storage_root = dir;
+}
+
+static bool host_path(const char* path, char* out, size_t n) {
+    const char* prefix = APP_DATA_PATH("");
+    size_t plen = strlen(prefix);
+    if(!storage_root) return false;
+    if(strncmp(path, prefix, plen) == 0)
+        path += plen;
+    else if(strncmp(path, prefix, plen - 1) == 0 && path[plen - 1] == 0)
+        path += plen - 1;
+    else
+        return false;
+    snprintf(out, n, "%s/%s", storage_root, path);
+    return true;
+}
+
+File* storage_file_alloc(Storage* storage) {
+    UNUSED(storage);
+    return calloc(1, sizeof(File));
+}
+
+void storage_file_free(File* file) {
+    free(file);
+}
+
+bool storage_file_open(File* file, const char* path, FS_AccessMode access_mode, FS_OpenMode open_mode) {
+    char hp[512];
+    if(!host_path(path, hp, sizeof(hp))) return false;
+    const char* mode = "rb";
+    if(access_mode & FSAM_WRITE) {
+        if(open_mode == FSOM_CREATE_ALWAYS)
+            mode = (access_mode & FSAM_READ) ? "w+b" : "wb";
+        else if(open_mode == FSOM_OPEN_APPEND)
+            mode = "ab";
+        else
+            mode = "r+b";
+    }
+    file->fp = fopen(hp, mode);
+    if(!file->fp && (open_mode == FSOM_OPEN_ALWAYS || open_mode == FSOM_OPEN_APPEND))
+        file->fp = fopen(hp, "w+b");
+    return file->fp != NULL;
+}
+
+bool storage_file_close(File* file) {
+    if(file->fp) fclose(file->fp);
+    file->fp = NULL;
+    return true;
+}
+
+uint16_t storage_file_read(File* file, void* buff, uint16_t bytes_to_read) {
+    if(!file->fp) return 0;
+    return (uint16_t)fread(buff, 1, bytes_to_read, file->fp);
+}
+
+uint16_t storage_file_write(File* file, const void* buff, uint16_t bytes_to_write) {
+    if(!file->fp) return 0;
+    return (uint16_t)fwrite(buff, 1, bytes_to_write, file->fp);
+}
+
+bool storage_file_seek(File* file, uint32_t offset, bool from_start) {
+    if(!file->fp) return false;
+    return fseek(file->fp, (long)offset, from_start ? SEEK_SET : SEEK_CUR) == 0;
+}
+
+uint64_t storage_file_size(File* file) {
+    struct stat st;
+    if(!file->fp || fflush(file->fp) != 0 || fstat(fileno(file->fp), &st) != 0) return 0;
+    return (uint64_t)st.st_size;
+}
+
+// Cuts the file at the current position
+bool storage_file_truncate(File* file) {
+    if(!file->fp || fflush(file->fp) != 0) return false;
+    return ftruncate(fileno(file->fp), ftell(file->fp)) == 0;
+}
+
+bool storage_file_sync(File* file) {
+    return file->fp && fflush(file->fp) == 0;
+}
+
+bool storage_dir_open(File* file, const char* path) {
+    if(!host_path(path, file->dir_path, sizeof(file->dir_path))) return false;
+    file->dir = opendir(file->dir_path);
+    return file->dir != NULL;
+}
+
+bool storage_dir_close(File* file) {
+    if(file->dir) closedir(file->dir);
+    file->dir = NULL;
+    return true;
+}
+
+bool storage_dir_read(File* file, FileInfo* fileinfo, char* name, uint16_t name_length) {
+    if(!file->dir) return false;
+    struct dirent* de;
+    while((de = readdir(file->dir)) != NULL) {
+        if(strcmp(de->d_name, ".") == 0 || strcmp(de->d_name, "..") == 0) continue;
+        char full[512];
+        struct stat st;
+        snprintf(full, sizeof(full), "%s/%s", file->dir_path, de->d_name);
+        memset(fileinfo, 0, sizeof(FileInfo));
+        if(stat(full, &st) == 0) {
+            fileinfo->size = (uint64_t)st.st_size;
+            if(S_ISDIR(st.st_mode)) fileinfo->flags |= FSF_DIRECTORY;
+        }
+        snprintf(name, name_length, "%s", de->d_name);
+        return true;
+    }
+    return false;
+}
+
+FS_Error storage_common_stat(Storage* storage, const char* path, FileInfo* fileinfo) {
+    UNUSED(storage);
+    char hp[512];
+    struct stat st;
+    if(!host_path(path, hp, sizeof(hp)) || stat(hp, &st) != 0) return FSE_NOT_EXIST;
+    memset(fileinfo, 0, sizeof(FileInfo));
+    fileinfo->size = (uint64_t)st.st_size;
+    if(S_ISDIR(st.st_mode)) fileinfo->flags |= FSF_DIRECTORY;
+    return FSE_OK;
+}
+
+FS_Error storage_common_timestamp(Storage* storage, const char* path, uint32_t* timestamp) {
+    UNUSED(storage);
+    char hp[512];
+    struct stat st;
+    if(!host_path(path, hp, sizeof(hp)) || stat(hp, &st) != 0) return FSE_NOT_EXIST;
+    *timestamp = (uint32_t)st.st_mtime;
+    return FSE_OK;
+}
+
+// Replaces new_path if it exists, as the firmware does
+FS_Error storage_common_rename(Storage* storage, const char* old_path, const char* new_path) {
+    UNUSED(storage);
+    char ho[512], hn[512];
+    if(!host_path(old_path, ho, sizeof(ho)) || !host_path(new_path, hn, sizeof(hn)))
+        return FSE_INVALID_NAME;
+    return rename(ho, hn) == 0 ? FSE_OK : FSE_INTERNAL;
+}
+
+bool storage_simply_mkdir(Storage* storage, const char* path) {
+    UNUSED(storage);
+    char hp[512];
+    if(!host_path(path, hp, sizeof(hp))) return false;
+    return mkdir(hp, 0755) == 0;
+}
+
+bool storage_simply_remove(Storage* storage, const char* path) {
+    UNUSED(storage);
+    char hp[512];
+    if(!host_path(path, hp, sizeof(hp))) return false;
+    return remove(hp) == 0;
+}
+
+// ============================================================
+// USB CDC: one interface's output goes to a host descriptor
+// ============================================================
+struct FuriHalUsbInterface {
+    uint8_t channels;
+};
+
+FuriHalUsbInterface usb_cdc_single = {1};
+FuriHalUsbInterface usb_cdc_dual = {2};
+
+static FuriHalUsbInterface* host_usb = &usb_cdc_single;
+static int host_cdc_fd = -1;
+static uint8_t host_cdc_if;
+static CdcCallbacks* host_cdc_cb;
+static void* host_cdc_ctx;
+
+void host_cdc_set_fd(uint8_t if_num, int fd) {
+    host_cdc_if = if_num;
+    host_cdc_fd = fd;
+}
+
+FuriHalUsbInterface* furi_hal_usb_get_config(void) {
+    return host_usb;
+}
+
+bool furi_hal_usb_set_config(FuriHalUsbInterface* new_if, void* ctx) {
+    UNUSED(ctx);
+    host_usb = new_if;
+    return true;
+}
+
+bool furi_hal_usb_is_locked(void) {
+    return false;
+}
+
+void furi_hal_cdc_set_callbacks(uint8_t if_num, CdcCallbacks* cb, void* context) {
+    if(if_num != host_cdc_if) return;
+    host_cdc_cb = cb;
+    host_cdc_ctx = context;
+}
+
+// Completes at once: the transfer-done callback runs before returning
+void furi_hal_cdc_send(uint8_t if_num, uint8_t* buf, uint16_t len) {
+    if(if_num >= host_usb->channels) return;
+    if(if_num == host_cdc_if && host_cdc_fd >= 0) {
+        ssize_t n = write(host_cdc_fd, buf, len);
+        UNUSED(n);
+    }
+    if(if_num == host_cdc_if && host_cdc_cb && host_cdc_cb->tx_ep_callback)
+        host_cdc_cb->tx_ep_callback(host_cdc_ctx);
+}
+
+// ============================================================
+// UART: one port, fed by host_serial_feed as if bytes arrived
+// ============================================================
+struct FuriHalSerialHandle {
+    bool acquired;
+    FuriHalSerialAsyncRxCallback cb;
+    void* ctx;
+    uint8_t byte;
+};
+
+static FuriHalSerialHandle host_usart;
+
+FuriHalSerialHandle* furi_hal_serial_control_acquire(FuriHalSerialId serial_id) {
+    if(serial_id != FuriHalSerialIdUsart || host_usart.acquired) return NULL;
+    host_usart.acquired = true;
+    return &host_usart;
+}
+
+void furi_hal_serial_control_release(FuriHalSerialHandle* handle) {
+    handle->acquired = false;
+}
+
+void furi_hal_serial_init(FuriHalSerialHandle* handle, uint32_t baud) {
+    UNUSED(handle);
+    UNUSED(baud);
+}
+
+void furi_hal_serial_deinit(FuriHalSerialHandle* handle) {
+    UNUSED(handle);
+}
+
+void furi_hal_serial_async_rx_start(
+    FuriHalSerialHandle* handle, FuriHalSerialAsyncRxCallback callback, void* context, bool report_errors) {
+    UNUSED(report_errors);
+    handle->cb = callback;
+    handle->ctx = context;
+}
+
+void furi_hal_serial_async_rx_stop(FuriHalSerialHandle* handle) {
+    handle->cb = NULL;
+}
+
+uint8_t furi_hal_serial_async_rx(FuriHalSerialHandle* handle) {
+    return handle->byte;
+}
+
+void host_serial_feed(const void* data, size_t len) {
+    const uint8_t* p = data;
+    for(size_t i = 0; i < len && host_usart.cb; i++) {
+        host_usart.byte = p[i];
+        host_usart.cb(&host_usart, FuriHalSerialRxEventData, host_usart.ctx);
+    }
+}
+
+void expansion_enable(Expansion* instance) {
+    UNUSED(instance);
+}
+
+void expansion_disable(Expansion* instance) {
+    UNUSED(instance);
+}
+
+// ============================================================
+// Plugins: registered entry points stand in for .fal files
+// ============================================================
+#define HOST_PLUGINS_MAX 4
+
+static struct {
+    const char* path;
+    const FlipperAppPluginDescriptor* (*ep)(void);
+} host_plugins[HOST_PLUGINS_MAX];
+static uint8_t host_plugin_count;
+
+const ElfApiInterface* const firmware_api_interface = NULL;
+
+struct PluginManager {
+    const char* appid;
+    uint32_t api_version;
+    const FlipperAppPluginDescriptor* loaded;
+};
+
+void host_plugin_register(const char* path, const FlipperAppPluginDescriptor* (*ep)(void)) {
+    if(host_plugin_count < HOST_PLUGINS_MAX) {
+        host_plugins[host_plugin_count].path = path;
+        host_plugins[host_plugin_count].ep = ep;
+        host_plugin_count++;
+    }
+}
+
+PluginManager* plugin_manager_alloc(
+    const char* application_id, uint32_t api_version, const ElfApiInterface* api_interface) {
+    UNUSED(api_interface);
+    PluginManager* pm = calloc(1, sizeof(PluginManager));
+    pm->appid = application_id;
+    pm->api_version = api_version;
+    return pm;
+}
+
+void plugin_manager_free(PluginManager* manager) {
+    free(manager);
+}
+
+PluginManagerError plugin_manager_load_single(PluginManager* manager, const char* path) {
+    for(uint8_t i = 0; i < host_plugin_count; i++) {
+        if(strcmp(host_plugins[i].path, path) != 0) continue;
+        const FlipperAppPluginDescriptor* d = host_plugins[i].ep();
+        if(strcmp(d->appid, manager->appid) != 0) return PluginManagerErrorApplicationIdMismatch;
+        if(d->ep_api_version != manager->api_version) return PluginManagerErrorAPIVersionMismatch;
+        manager->loaded = d;
+        return PluginManagerErrorNone;
+    }
+    return PluginManagerErrorLoaderError;
+}
+
+const void* plugin_manager_get_ep(PluginManager* manager, uint32_t index) {
+    return index == 0 && manager->loaded ? manager->loaded->entry_point : NULL;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+// Controls for host tools driving the app against the furi stand-in
+
+#include <furi.h>
+#include <flipper_application/flipper_application.h>
+
+// Virtual millisecond clock returned by furi_get_tick()
+void host_clock_set(uint32_t ms);
+void host_clock_advance(uint32_t ms);
+
+// Whether a started timer has run out by the virtual clock; stops it.
+// Tools run the callback, and restart a periodic timer, themselves.
+bool host_timer_due(FuriTimer* timer);
+
+// Make the next `count` timed mutex acquires fail as if the lock were held
+void host_mutex_fail_next(uint32_t count);
+
+// Map APP_DATA_PATH("") onto a host directory; NULL disables storage
+void host_storage_set_root(const char* dir);
+
+// Number of notification sequences played so far
+uint32_t host_notification_count(void);
+
+// Send what the app writes to USB CDC interface if_num to fd (a file,
+// pipe or pty); -1 discards it
+void host_cdc_set_fd(uint8_t if_num, int fd);
+
+// Deliver bytes to the UART receive callback, one interrupt per byte
+void host_serial_feed(const void* data, size_t len);
+
+// Serve plugin_manager_load_single(path) from a plugin linked into the tool
+void host_plugin_register(const char* path, const FlipperAppPluginDescriptor* (*ep)(void));
@@ -0,0 +1,5 @@
+#pragma once
+
+#include <flipper_application/flipper_application.h>
+
+extern const ElfApiInterface* const firmware_api_interface;
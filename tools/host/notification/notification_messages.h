@@ -0,0 +1,14 @@
+#pragma once
+
+#include <notification/notification.h>
+
+extern const NotificationMessage message_red_255, message_red_0;
+extern const NotificationMessage message_green_255, message_green_0;
+extern const NotificationMessage message_delay_50, message_delay_100;
+extern const NotificationMessage message_note_c7, message_note_e7, message_sound_off;
+extern const NotificationMessage message_vibro_on, message_vibro_off;
+
+extern const NotificationSequence sequence_single_vibro;
+extern const NotificationSequence sequence_double_vibro;
+extern const NotificationSequence sequence_display_backlight_enforce_on;
+extern const NotificationSequence sequence_display_backlight_enforce_auto;
@@ -0,0 +1,504 @@
+// Headless render check.
+//
+// Draws every screen through draw_cb into a 128x64 framebuffer: menus for
+// each method, info and every brewing step for each built-in recipe, the
+// editor on a sample custom recipe, and the dialogs. Each frame is hashed
+// and compared with tools/render_golden.txt, text that runs off the screen
+// or into other text is reported, and the host time per screen is printed.
+//
+// Build instructions are in README.md under "Host tools".
+//   render_check [--update] [--layout] [--dump DIR] [--golden FILE] [--iters N]
+//
+// The host glyphs only approximate the device fonts, so layout counts are
+// a guide: a new warning after a change is worth a look on the device.
+
+#include "../coffee_timer.c"
+#include "host.h"
+#include "canvas_fb.h"
+#include <ctype.h>
+#include <time.h>
+
+// editor.c is linked in; on the device it is loaded as a plugin
+const FlipperAppPluginDescriptor* editor_plugin_ep(void);
+
+#define GOLDEN_DEFAULT "tools/render_golden.txt"
+#define MAX_CASES 1024
+#define CASE_NAME_LEN 64
+
+typedef struct {
+    char name[CASE_NAME_LEN];
+    uint64_t hash;
+} Golden;
+
+typedef struct {
+    CoffeeApp* app;
+    Canvas* canvas;
+    uint32_t iters;
+    bool list_layout;
+    const char* dump_dir;
+    Golden* golden;
+    uint16_t golden_count;
+    Golden* seen;
+    uint16_t seen_count;
+    uint16_t mismatches;
+    uint16_t missing;
+    uint16_t layout_warnings;
+    MetricTiming ns[ScreenCount];
+    uint16_t cases[ScreenCount];
+    uint16_t clipped[ScreenCount];     // cases with text off the screen
+    uint16_t overlapping[ScreenCount]; // cases with text running into text
+} Check;
+
+static uint64_t host_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void slug(char* out, size_t n, const char* s) {
+    size_t o = 0;
+    bool dash = false;
+    for(; *s && o + 1 < n; s++) {
+        if(isalnum((unsigned char)*s)) {
+            if(dash && o > 0 && o + 2 < n) out[o++] = '-';
+            out[o++] = (char)tolower((unsigned char)*s);
+            dash = false;
+        } else {
+            dash = true;
+        }
+    }
+    out[o] = 0;
+}
+
+static uint16_t golden_load(const char* path, Golden* g) {
+    FILE* fp = fopen(path, "r");
+    if(!fp) return 0;
+    uint16_t n = 0;
+    char line[128];
+    while(n < MAX_CASES && fgets(line, sizeof(line), fp)) {
+        unsigned long long h;
+        if(line[0] == '#') continue;
+        if(sscanf(line, "%63s %llx", g[n].name, &h) == 2) {
+            g[n].hash = h;
+            n++;
+        }
+    }
+    fclose(fp);
+    return n;
+}
+
+static bool golden_save(const char* path, const Golden* g, uint16_t n) {
+    FILE* fp = fopen(path, "w");
+    if(!fp) return false;
+    fprintf(fp, "# Generated by render_check --update. One frame hash per case.\n");
+    for(uint16_t i = 0; i < n; i++)
+        fprintf(fp, "%s %016llx\n", g[i].name, (unsigned long long)g[i].hash);
+    fclose(fp);
+    return true;
+}
+
+static const Golden* golden_find(const Check* ck, const char* name) {
+    for(uint16_t i = 0; i < ck->golden_count; i++)
+        if(strcmp(ck->golden[i].name, name) == 0) return &ck->golden[i];
+    return NULL;
+}
+
+// Render the app's current state as case `name`
+static void check_case(Check* ck, const char* name) {
+    CoffeeApp* app = ck->app;
+    Screen screen = app->s.screen;
+
+    // The debug screen shows the metrics that draw_cb itself updates
+    if(screen == ScreenDebug) metrics_reset(app);
+    draw_cb(ck->canvas, app);
+    uint64_t hash = canvas_fb_hash(ck->canvas);
+    uint32_t clipped = canvas_fb_clipped(ck->canvas);
+    uint32_t overlaps = canvas_fb_overlaps(ck->canvas);
+
+    for(uint32_t i = 0; i < ck->iters; i++) {
+        if(screen == ScreenDebug) metrics_reset(app);
+        uint64_t t0 = host_now_ns();
+        draw_cb(ck->canvas, app);
+        metrics_record(&ck->ns[screen], (uint32_t)(host_now_ns() - t0));
+    }
+
+    ck->cases[screen]++;
+    if(clipped) ck->clipped[screen]++;
+    if(overlaps) ck->overlapping[screen]++;
+    if(clipped || overlaps) {
+        if(ck->list_layout)
+            printf("layout  %-40s %lu px clipped, %lu overlaps\n",
+                name, (unsigned long)clipped, (unsigned long)overlaps);
+        ck->layout_warnings++;
+    }
+
+    const Golden* g = golden_find(ck, name);
+    if(!g) {
+        ck->missing++;
+    } else if(g->hash != hash) {
+        printf("CHANGED %-40s %016llx (golden %016llx)\n",
+            name, (unsigned long long)hash, (unsigned long long)g->hash);
+        ck->mismatches++;
+    }
+
+    if(ck->seen_count < MAX_CASES) {
+        Golden* s = &ck->seen[ck->seen_count++];
+        snprintf(s->name, sizeof(s->name), "%s", name);
+        s->hash = hash;
+    }
+
+    if(ck->dump_dir) {
+        char path[256];
+        snprintf(path, sizeof(path), "%s/%s.pbm", ck->dump_dir, name);
+        if(!canvas_fb_write_pbm(ck->canvas, path)) fprintf(stderr, "cannot write %s\n", path);
+    }
+}
+
+// ============================================================
+// Cases
+// ============================================================
+static void select_recipe(CoffeeApp* app, uint8_t m, uint8_t r, bool custom) {
+    AppState* s = &app->s;
+    s->method_sel = s->cur_method = m;
+    s->recipe_sel = s->cur_recipe = r;
+    s->using_custom = custom;
+    s->ratio_adjust = 0;
+    s->batch = 1;
+    apply_scale(app);
+}
+
+static void start_step(CoffeeApp* app, uint8_t i, uint32_t elapsed_ms) {
+    AppState* s = &app->s;
+    s->screen = ScreenBrewing;
+    s->cur_step = i;
+    s->step_elapsed_ms = elapsed_ms;
+    s->total_elapsed_ms = 30000 * i + elapsed_ms;
+    s->timer_state = TimerRunning;
+    s->step_complete = elapsed_ms >= get_sdur(app, i) * 1000U && get_sdur(app, i) > 0;
+    s->show_upcoming = false;
+    uint16_t water = 0;
+    for(uint8_t k = 0; k < i; k++) water += app->scale.step_ml[step_row(app, k)];
+    s->cumulative_water_ml = water;
+}
+
+static void check_menus(Check* ck) {
+    CoffeeApp* app = ck->app;
+    AppState* s = &app->s;
+    char name[CASE_NAME_LEN], ms[24];
+
+    // Method menu: one entry per method plus the custom entry
+    for(uint8_t m = 0; m <= method_count; m++) {
+        s->screen = ScreenMethodMenu;
+        s->method_sel = m;
+        snprintf(name, sizeof(name), "menu.%u", m);
+        check_case(ck, name);
+    }
+    for(uint8_t m = 0; m < method_count; m++) {
+        slug(ms, sizeof(ms), rstr(methods[m].name));
+        s->screen = ScreenRecipeMenu;
+        s->method_sel = m;
+        s->recipe_sel = 0;
+        snprintf(name, sizeof(name), "recipes.%s", ms);
+        check_case(ck, name);
+    }
+}
+
+static void check_recipe(Check* ck, uint8_t m, uint8_t r, bool custom) {
+    CoffeeApp* app = ck->app;
+    AppState* s = &app->s;
+    char name[CASE_NAME_LEN], ms[24], rs[24];
+
+    select_recipe(app, m, r, custom);
+    if(custom) snprintf(ms, sizeof(ms), "custom");
+    else slug(ms, sizeof(ms), rstr(methods[m].name));
+    slug(rs, sizeof(rs), get_rname(app));
+
+    s->screen = ScreenRecipeInfo;
+    snprintf(name, sizeof(name), "info.%s.%s", ms, rs);
+    check_case(ck, name);
+
+    uint8_t n = get_scount(app);
+    for(uint8_t i = 0; i < n; i++) {
+        uint16_t dur = get_sdur(app, i);
+        start_step(app, i, dur * 500U);
+        snprintf(name, sizeof(name), "brew.%s.%s.%u", ms, rs, i + 1);
+        check_case(ck, name);
+        if(dur > 0) {
+            start_step(app, i, dur * 1000U + 7000);
+            snprintf(name, sizeof(name), "brew.%s.%s.%u.over", ms, rs, i + 1);
+            check_case(ck, name);
+        }
+    }
+    if(n == 0) return;
+
+    start_step(app, 0, 0);
+    s->show_upcoming = true;
+    snprintf(name, sizeof(name), "brew.%s.%s.upcoming", ms, rs);
+    check_case(ck, name);
+
+    start_step(app, 0, 2000);
+    s->timer_state = TimerPaused;
+    snprintf(name, sizeof(name), "brew.%s.%s.paused", ms, rs);
+    check_case(ck, name);
+
+    s->screen = ScreenConfirmAbort;
+    s->timer_state = TimerRunning;
+    snprintf(name, sizeof(name), "abort.%s.%s", ms, rs);
+    check_case(ck, name);
+
+    start_step(app, n - 1, 0);
+    s->total_elapsed_ms = 245000;
+    s->screen = ScreenComplete;
+    snprintf(name, sizeof(name), "complete.%s.%s", ms, rs);
+    check_case(ck, name);
+}
+
+// A pour step with a live scale reading: poured against target, and flow
+static void check_scale(Check* ck) {
+    CoffeeApp* app = ck->app;
+    AppSensor* sn = &app->sensor;
+    select_recipe(app, 1, 0, false);
+    start_step(app, 4, 10000);
+    sn->source = SensorTrace;
+    sn->raw_count = 3;
+    sn->tare = 3500;
+    sn->weight = sn->tare + 912;
+    sn->flow = 45;
+    sn->last_tick = furi_get_tick();
+    check_case(ck, "brew.scale");
+    memset(sn, 0, sizeof(AppSensor));
+}
+
+// Auto-advance past a steep: the press timer runs, the screen waits for OK
+static void check_armed(Check* ck) {
+    CoffeeApp* app = ck->app;
+    select_recipe(app, 0, 0, false);
+    app->settings.auto_advance = true;
+    start_step(app, 4, 62000);
+    check_case(ck, "brew.armed");
+    app->settings.auto_advance = false;
+}
+
+// A custom recipe with a repeat block and every step type the editor shows
+static void add_sample_custom(CoffeeApp* app) {
+    CustomRecipe* cr = &app->custom[0];
+    custom_recipe_init_new(cr);
+    snprintf(cr->name, NAME_LEN, "Render Sample");
+    static const struct {
+        StepType type;
+        const char* inst;
+        uint16_t dur;
+        uint8_t weight;
+        uint8_t wml;
+    } rows[] = {
+        {StepAdd, "Add coffee", 0, 15, 0},
+        {StepPour, "Bloom", 30, 0, 5},
+        {StepRepeat, "Repeat", 3, 2, 0},
+        {StepPour, "Pour", 15, 0, 6},
+        {StepWait, "Wait", 20, 0, 0},
+        {StepSwirl, "Swirl", 5, 0, 0},
+    };
+    for(uint8_t i = 0; i < COUNT_OF(rows); i++) {
+        CustomStep* st = &cr->steps[i];
+        st->type = rows[i].type;
+        snprintf(st->instruction, NAME_LEN, "%s", rows[i].inst);
+        st->duration_sec = rows[i].dur;
+        st->weight_grams = rows[i].weight;
+        st->water_ml_div10 = rows[i].wml;
+    }
+    cr->step_count = COUNT_OF(rows);
+    for(uint8_t i = 0; i < cr->step_count; i++) step_auto_detail(&cr->steps[i]);
+    app->custom_order[0] = 0;
+    app->custom_count = 1;
+    app->custom_loaded = true;
+}
+
+static void check_editor(Check* ck) {
+    CoffeeApp* app = ck->app;
+    AppState* s = &app->s;
+    EditorState* ed = &app->editor;
+    char name[CASE_NAME_LEN];
+    editor_load(app, &editor_host);
+
+    for(uint8_t sel = 0; sel <= app->custom_count; sel++) {
+        s->screen = ScreenEditMenu;
+        ed->sel = sel;
+        snprintf(name, sizeof(name), "edit.menu.%u", sel);
+        check_case(ck, name);
+    }
+
+    ed->recipe_idx = 0;
+    for(uint8_t f = 0; f < EditFieldCount; f++) {
+        s->screen = ScreenEditRecipe;
+        ed->field = (EditField)f;
+        ed->editing = false;
+        snprintf(name, sizeof(name), "edit.recipe.%u", f);
+        check_case(ck, name);
+        ed->editing = true;
+        snprintf(name, sizeof(name), "edit.recipe.%u.editing", f);
+        check_case(ck, name);
+    }
+    ed->editing = false;
+    ed->field = EditFieldDelete;
+    s->screen = ScreenConfirmDelete;
+    check_case(ck, "edit.delete");
+
+    const CustomRecipe* cr = &app->custom[0];
+    for(uint8_t sel = 0; sel <= cr->step_count; sel++) {
+        s->screen = ScreenEditSteps;
+        ed->sel = sel;
+        snprintf(name, sizeof(name), "edit.steps.%u", sel);
+        check_case(ck, name);
+    }
+    for(uint8_t i = 0; i < cr->step_count; i++) {
+        ed->step_idx = i;
+        for(uint8_t f = 0; f < StepFieldCount; f++) {
+            s->screen = ScreenEditStep;
+            ed->step_field = (StepField)f;
+            snprintf(name, sizeof(name), "edit.step.%u.%u", i, f);
+            check_case(ck, name);
+        }
+    }
+    editor_unload(app);
+}
+
+// A three-brew service session: one frame per action, one per stand-by
+static void check_service(Check* ck) {
+    CoffeeApp* app = ck->app;
+    AppState* s = &app->s;
+    AppService* sv = &app->service;
+    char name[CASE_NAME_LEN];
+    static const uint8_t queue[][3] = {{0, 0, 1}, {1, 0, 2}, {0, 1, 1}};
+
+    for(uint8_t i = 0; i < COUNT_OF(queue); i++) {
+        select_recipe(app, queue[i][0], queue[i][1], false);
+        s->batch = queue[i][2];
+        service_queue_add(app);
+    }
+    s->screen = ScreenMethodMenu;
+    s->method_sel = method_count + 1;
+    check_case(ck, "menu.service");
+    sv->sel = 1;
+    service_refresh(app);
+    s->screen = ScreenServiceQueue;
+    check_case(ck, "service.queue");
+
+    service_start(sv, furi_get_tick());
+    s->screen = ScreenService;
+    uint8_t n = 0, idle = 0;
+    for(uint8_t guard = 0; guard < 100; guard++) {
+        service_step_update(app);
+        if(s->screen != ScreenService) break;
+        if(sv->act < 0) {
+            uint32_t wait;
+            service_next(sv, furi_get_tick(), &wait);
+            if(wait == 0) wait = 1000;   // only final waits left
+            host_clock_advance(wait / 2);
+            snprintf(name, sizeof(name), "service.idle.%u", ++idle);
+            check_case(ck, name);
+            host_clock_advance(wait - wait / 2);
+            continue;
+        }
+        const ServiceBrew* br = &sv->brew[sv->act];
+        uint32_t hands = (br->dur[br->step] ? br->dur[br->step] : SERVICE_MANUAL_SEC) * 1000U;
+        host_clock_advance(hands / 2);
+        snprintf(name, sizeof(name), "service.%u", ++n);
+        check_case(ck, name);
+        if(n == 3) {
+            s->screen = ScreenConfirmAbort;
+            check_case(ck, "service.abort");
+            s->screen = ScreenService;
+        }
+        host_clock_advance(hands - hands / 2);
+        service_step_done(sv, furi_get_tick());
+    }
+    check_case(ck, "service.complete");
+    sv->active = false;
+    sv->count = 0;
+}
+
+static void print_timing(const Check* ck) {
+    printf("\n%-10s %5s %5s %7s %9s %9s %9s\n",
+        "screen", "cases", "clip", "overlap", "min ns", "avg ns", "max ns");
+    for(uint8_t sc = 0; sc < ScreenCount; sc++) {
+        if(ck->cases[sc] == 0) continue;
+        const MetricTiming* t = &ck->ns[sc];
+        printf("%-10s %5u %5u %7u %9lu %9lu %9lu\n", metrics_screen_name((Screen)sc),
+            ck->cases[sc], ck->clipped[sc], ck->overlapping[sc], (unsigned long)t->min,
+            (unsigned long)(t->count ? t->sum / t->count : 0), (unsigned long)t->max);
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* golden_path = GOLDEN_DEFAULT;
+    bool update = false;
+    Check ck = {.iters = 200};
+
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--update") == 0)
+            update = true;
+        else if(strcmp(argv[i], "--layout") == 0)
+            ck.list_layout = true;
+        else if(strcmp(argv[i], "--dump") == 0 && i + 1 < argc)
+            ck.dump_dir = argv[++i];
+        else if(strcmp(argv[i], "--golden") == 0 && i + 1 < argc)
+            golden_path = argv[++i];
+        else if(strcmp(argv[i], "--iters") == 0 && i + 1 < argc)
+            ck.iters = (uint32_t)strtoul(argv[++i], NULL, 10);
+        else {
+            fprintf(stderr, "usage: %s [--update] [--layout] [--dump DIR] [--golden FILE] [--iters N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    ck.golden = calloc(MAX_CASES, sizeof(Golden));
+    ck.seen = calloc(MAX_CASES, sizeof(Golden));
+    if(!ck.golden || !ck.seen) return 1;
+    ck.golden_count = golden_load(golden_path, ck.golden);
+
+    host_clock_set(0);
+    host_plugin_register(EDITOR_PLUGIN_PATH, editor_plugin_ep);
+    CoffeeApp* app = app_alloc();
+    session_reset(app);
+    add_sample_custom(app);
+    ck.app = app;
+    ck.canvas = canvas_fb_alloc();
+
+    check_menus(&ck);
+    for(uint8_t m = 0; m < method_count; m++)
+        for(uint8_t r = 0; r < methods[m].recipe_count; r++) check_recipe(&ck, m, r, false);
+    check_recipe(&ck, method_count, 0, true);
+    select_recipe(app, 0, 0, false);
+    app->settings.launch = LaunchBrew;
+    app->s.screen = ScreenRecipeInfo;
+    check_case(&ck, "info.launch");
+    app->settings.launch = LaunchMenu;
+    check_scale(&ck);
+    check_armed(&ck);
+    check_editor(&ck);
+    app->s.screen = ScreenDebug;
+    check_case(&ck, "debug");
+    check_service(&ck);
+
+    print_timing(&ck);
+    printf("\n%u cases, %u changed, %u new, %u with layout warnings\n",
+        ck.seen_count, ck.mismatches, ck.missing, ck.layout_warnings);
+
+    int rc = 0;
+    if(update) {
+        if(!golden_save(golden_path, ck.seen, ck.seen_count)) {
+            fprintf(stderr, "cannot write %s\n", golden_path);
+            rc = 1;
+        } else {
+            printf("wrote %s\n", golden_path);
+        }
+    } else if(ck.mismatches || ck.missing) {
+        rc = 1;
+    }
+
+    canvas_fb_free(ck.canvas);
+    app_free(app);
+    free(ck.golden);
+    free(ck.seen);
+    return rc;
+}
@@ -0,0 +1,90 @@
+// Brew telemetry decoder.
+//
+// Reads the frames the app streams on its second USB serial port (turn it
+// on with a long Up on the metrics screen) and prints one line per record.
+// PATH can be the serial device, a pty, a file or "-" for stdin; a tty is
+// switched to raw mode first. Bytes that don't form a valid frame are
+// skipped and counted.
+//
+// Build instructions are in README.md under "Host tools".
+//   telemetry_decode PATH
+
+#include "coffee_timer.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+static void print_state(uint8_t seq, const TelemetryState* st) {
+    printf("#%-3u ", seq);
+    if(!(st->flags & (TELEMETRY_F_BREWING | TELEMETRY_F_COMPLETE))) {
+        printf("idle\n");
+        return;
+    }
+    const char* name = "?";
+    if(st->flags & TELEMETRY_F_CUSTOM)
+        name = "custom";
+    else if(st->method < method_count && st->recipe < methods[st->method].recipe_count)
+        name = rstr(methods[st->method].recipes[st->recipe].name);
+
+    printf("%-14s step %u/%u ", name, st->step + 1, st->step_count);
+    if(st->step_sec > 0)
+        printf("%3us left of %3us", st->remaining_sec, st->step_sec);
+    else
+        printf("%-17s", "manual");
+    printf("  water %4uml  total %u:%02u", st->water_ml, st->total_sec / 60, st->total_sec % 60);
+    if(st->flags & TELEMETRY_F_PAUSED) printf("  paused");
+    if(st->flags & TELEMETRY_F_STEP_DUE) printf("  due");
+    if(st->flags & TELEMETRY_F_COMPLETE) printf("  complete");
+    printf("\n");
+    fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    if(argc != 2) {
+        fprintf(stderr, "usage: %s PATH\n", argv[0]);
+        return 2;
+    }
+    int fd = strcmp(argv[1], "-") == 0 ? STDIN_FILENO : open(argv[1], O_RDONLY | O_NOCTTY);
+    if(fd < 0) {
+        perror(argv[1]);
+        return 1;
+    }
+    if(isatty(fd)) {
+        struct termios tio;
+        if(tcgetattr(fd, &tio) == 0) {
+            cfmakeraw(&tio);
+            tcsetattr(fd, TCSANOW, &tio);
+        }
+    }
+
+    uint8_t buf[256];
+    size_t have = 0;
+    unsigned long frames = 0, skipped = 0;
+    for(;;) {
+        ssize_t n = read(fd, buf + have, sizeof(buf) - have);
+        if(n <= 0) break;
+        have += (size_t)n;
+
+        size_t at = 0;
+        while(have - at >= TELEMETRY_FRAME_LEN) {
+            TelemetryState st;
+            uint8_t seq;
+            if(telemetry_parse(buf + at, have - at, &st, &seq)) {
+                print_state(seq, &st);
+                frames++;
+                at += TELEMETRY_FRAME_LEN;
+            } else {
+                skipped++;
+                at++;
+            }
+        }
+        memmove(buf, buf + at, have - at);
+        have -= at;
+    }
+
+    fprintf(stderr, "%lu frames, %lu bytes skipped\n", frames, skipped);
+    if(fd != STDIN_FILENO) close(fd);
+    return 0;
+}
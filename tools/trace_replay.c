@@ -0,0 +1,197 @@
+// Input trace replay.
+//
+// Feeds an input.trace recorded on the device (metrics screen, [<]Rec)
+// through the app's input callback, timer and main loop on a virtual 1 ms
+// clock, at the recorded spacing. Prints one line per event with the state
+// it left behind, so runs from two builds can be diffed, and ends with a
+// digest of those lines plus the host time spent in the app.
+//
+// Build instructions are in README.md under "Host tools".
+//   trace_replay FILE [--quiet] [--data DIR] [--telemetry PATH] [--scale TRACE]
+//
+// --telemetry turns the USB telemetry stream on and writes its frames to
+// PATH (a file, FIFO or pty), for tools/telemetry_decode.
+// --scale plays a scale.trace as the weight input of every brew, and adds
+// the poured weight to each state line.
+
+#include "../coffee_timer.c"
+#include "host.h"
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+// editor.c is linked in; on the device it is loaded as a plugin
+const FlipperAppPluginDescriptor* editor_plugin_ep(void);
+
+#define REPLAY_TICK_MS 100
+#define REPLAY_LOOP_MS 100
+#define REPLAY_TAIL_MS 1000
+
+static uint64_t host_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// FNV-1a over the state lines
+static uint32_t digest_add(uint32_t h, const char* s) {
+    while(*s) {
+        h ^= (uint8_t)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// One spare byte, so text can be NUL-terminated
+static uint8_t* read_file(const char* path, size_t cap, size_t* len) {
+    FILE* fp = fopen(path, "rb");
+    if(!fp) return NULL;
+    uint8_t* buf = malloc(cap + 1);
+    *len = buf ? fread(buf, 1, cap, fp) : 0;
+    fclose(fp);
+    return buf;
+}
+
+typedef struct {
+    uint64_t app_ns;        // host time inside the app
+    uint32_t now;           // virtual clock
+    uint32_t next_tick;
+    uint32_t next_loop;
+} Replay;
+
+// Run the timer and main loop up to virtual time `until`
+static void run_until(CoffeeApp* app, Replay* r, uint32_t until) {
+    while(r->now < until) {
+        r->now++;
+        host_clock_set(r->now);
+        uint64_t t0 = host_now_ns();
+        if(r->now >= r->next_tick) {
+            r->next_tick += REPLAY_TICK_MS;
+            tick_cb(app);
+        }
+        if(host_timer_due(app->deadline)) deadline_cb(app);
+        if(r->now >= r->next_loop || furi_message_queue_get_count(app->queue) > 0) {
+            app_process(app, 0);
+            draw_cb(NULL, app);
+            r->next_loop = r->now + REPLAY_LOOP_MS;
+        }
+        r->app_ns += host_now_ns() - t0;
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* path = NULL;
+    const char* telemetry = NULL;
+    const char* scale = NULL;
+    bool quiet = false;
+
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--quiet") == 0)
+            quiet = true;
+        else if(strcmp(argv[i], "--data") == 0 && i + 1 < argc)
+            host_storage_set_root(argv[++i]);
+        else if(strcmp(argv[i], "--telemetry") == 0 && i + 1 < argc)
+            telemetry = argv[++i];
+        else if(strcmp(argv[i], "--scale") == 0 && i + 1 < argc)
+            scale = argv[++i];
+        else if(argv[i][0] != '-' && !path)
+            path = argv[i];
+        else {
+            fprintf(stderr, "usage: %s FILE [--quiet] [--data DIR] [--telemetry PATH] [--scale TRACE]\n",
+                argv[0]);
+            return 2;
+        }
+    }
+    if(!path) {
+        fprintf(stderr, "usage: %s FILE [--quiet] [--data DIR] [--telemetry PATH] [--scale TRACE]\n",
+            argv[0]);
+        return 2;
+    }
+    int telemetry_fd = -1;
+    if(telemetry) {
+        telemetry_fd = open(telemetry, O_WRONLY | O_CREAT | O_TRUNC | O_NOCTTY, 0644);
+        if(telemetry_fd < 0) {
+            perror(telemetry);
+            return 1;
+        }
+        host_cdc_set_fd(TELEMETRY_CDC_IF, telemetry_fd);
+    }
+
+    size_t len = 0;
+    uint8_t* buf = read_file(path, TRACE_HEADER_SIZE + TRACE_MAX_EVENTS * TRACE_REC_SIZE, &len);
+    bool auto_adv = false;
+    if(!buf || !trace_check_header(buf, len, &auto_adv)) {
+        fprintf(stderr, "%s: not an input trace\n", path);
+        free(buf);
+        return 1;
+    }
+    uint16_t count = (uint16_t)((len - TRACE_HEADER_SIZE) / TRACE_REC_SIZE);
+
+    host_clock_set(0);
+    host_plugin_register(EDITOR_PLUGIN_PATH, editor_plugin_ep);
+    CoffeeApp* app = app_alloc();
+    session_reset(app);
+    app->settings.auto_advance = auto_adv;
+    if(telemetry_fd >= 0) telemetry_start(app);
+    if(scale) {
+        // Stands in for the storage worker's load of scale.trace
+        size_t slen = 0;
+        char* sbuf = (char*)read_file(scale, SENSOR_TRACE_MAX, &slen);
+        if(!sbuf) {
+            perror(scale);
+            app_free(app);
+            free(buf);
+            return 1;
+        }
+        sbuf[slen] = '\0';
+        app->sensor.source = SensorTrace;
+        app->sensor.trace = sbuf;
+        app->sensor.trace_len = slen;
+    }
+
+    Replay r = {.now = 0, .next_tick = REPLAY_TICK_MS, .next_loop = 0};
+    uint32_t at = 0;
+    uint32_t digest = 2166136261u;
+    uint16_t events = 0;
+    char line[96];
+
+    for(uint16_t i = 0; i < count; i++) {
+        InputEvent ev;
+        uint32_t dt;
+        bool is_event = trace_decode(buf + TRACE_HEADER_SIZE + i * TRACE_REC_SIZE, &dt, &ev);
+        at += dt;
+        run_until(app, &r, at);
+        if(!is_event) continue;
+
+        uint64_t t0 = host_now_ns();
+        input_cb(&ev, app);
+        app_process(app, 0);
+        draw_cb(NULL, app);
+        r.app_ns += host_now_ns() - t0;
+        r.next_loop = r.now + REPLAY_LOOP_MS;
+        events++;
+
+        AppState* s = &app->s;
+        snprintf(line, sizeof(line), "%-5s %-7s -> %-9s step %u el %lu tot %lu water %u\n",
+            input_get_key_name(ev.key), input_get_type_name(ev.type),
+            metrics_screen_name(s->screen), s->cur_step,
+            (unsigned long)s->step_elapsed_ms, (unsigned long)s->total_elapsed_ms,
+            s->cumulative_water_ml);
+        if(scale && sensor_live(&app->sensor, r.now))
+            snprintf(line + strlen(line) - 1, sizeof(line) - strlen(line) + 1, " poured %ld\n",
+                (long)sensor_poured(&app->sensor) / 10);
+        digest = digest_add(digest, line);
+        if(!quiet) printf("%9lu %s", (unsigned long)at, line);
+    }
+    run_until(app, &r, at + REPLAY_TAIL_MS);
+
+    printf("events %u over %lu ms, final %s, digest %08lx\n",
+        events, (unsigned long)at, metrics_screen_name(app->s.screen), (unsigned long)digest);
+    printf("app time %lu us (%lu ns/event)\n",
+        (unsigned long)(r.app_ns / 1000), (unsigned long)(events ? r.app_ns / events : 0));
+
+    app_free(app);
+    free(buf);
+    if(telemetry_fd >= 0) close(telemetry_fd);
+    return 0;
+}
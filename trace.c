@@ -0,0 +1,190 @@
+#include "coffee_timer.h"
+#include <stdlib.h>
+#include <string.h>
+
+// File: "CTR1", flags, 3 reserved, then TRACE_REC_SIZE-byte records:
+// delay since the previous record (ms, u16 LE) and key << 4 | type.
+// A record with TRACE_GAP instead of key/type only carries delay.
+#define TRACE_GAP 0xFF
+#define TRACE_FLAG_AUTO (1 << 0)
+#define TRACE_BUF_SIZE (TRACE_HEADER_SIZE + TRACE_MAX_EVENTS * TRACE_REC_SIZE)
+
+// ============================================================
+// Encoding, shared with the host replay tool
+// ============================================================
+static void trace_put(uint8_t* rec, uint16_t dt, uint8_t kt) {
+    rec[0] = (uint8_t)(dt & 0xFF);
+    rec[1] = (uint8_t)(dt >> 8);
+    rec[2] = kt;
+}
+
+bool trace_decode(const uint8_t* rec, uint32_t* dt, InputEvent* ev) {
+    *dt = (uint32_t)rec[0] | ((uint32_t)rec[1] << 8);
+    if(rec[2] == TRACE_GAP) return false;
+    ev->sequence = 0;
+    ev->key = (InputKey)(rec[2] >> 4);
+    ev->type = (InputType)(rec[2] & 0x0F);
+    return true;
+}
+
+bool trace_check_header(const uint8_t* buf, size_t len, bool* auto_advance) {
+    if(len < TRACE_HEADER_SIZE || memcmp(buf, "CTR1", 4) != 0) return false;
+    if((len - TRACE_HEADER_SIZE) % TRACE_REC_SIZE != 0) return false;
+    *auto_advance = buf[4] & TRACE_FLAG_AUTO;
+    return true;
+}
+
+// ============================================================
+// Recording (main thread, app mutex held)
+// ============================================================
+void trace_record_start(CoffeeApp* app) {
+    AppTrace* t = &app->trace;
+    if(t->mode != TraceIdle) return;
+    t->buf = malloc(TRACE_BUF_SIZE);
+    if(!t->buf) return;
+    memset(t->buf, 0, TRACE_HEADER_SIZE);
+    memcpy(t->buf, "CTR1", 4);
+    if(app->settings.auto_advance) t->buf[4] |= TRACE_FLAG_AUTO;
+    t->count = 0;
+    t->last_tick = furi_get_tick();
+    t->mode = TraceRecording;
+}
+
+// Hands the buffer to the storage worker, which writes and frees it
+void trace_record_stop(CoffeeApp* app) {
+    AppTrace* t = &app->trace;
+    if(t->mode != TraceRecording) return;
+    StorageRequest req = {.op = StorageOpSaveTrace};
+    req.data = t->buf;
+    req.len = (uint16_t)(TRACE_HEADER_SIZE + t->count * TRACE_REC_SIZE);
+    t->buf = NULL;
+    t->mode = TraceIdle;
+    storage_post(app, &req);
+}
+
+void trace_record(CoffeeApp* app, const InputEvent* ev, uint32_t tick) {
+    AppTrace* t = &app->trace;
+    if(t->mode != TraceRecording) return;
+    uint32_t dt = tick - t->last_tick;
+    t->last_tick = tick;
+
+    // Long pauses (a 4 min steep) become gap records; leave room for one event
+    while(dt > 0xFFFF && t->count + 1 < TRACE_MAX_EVENTS) {
+        trace_put(t->buf + TRACE_HEADER_SIZE + t->count++ * TRACE_REC_SIZE, 0xFFFF, TRACE_GAP);
+        dt -= 0xFFFF;
+    }
+    trace_put(
+        t->buf + TRACE_HEADER_SIZE + t->count++ * TRACE_REC_SIZE,
+        (uint16_t)(dt > 0xFFFF ? 0xFFFF : dt),
+        (uint8_t)((ev->key << 4) | ev->type));
+    if(t->count >= TRACE_MAX_EVENTS) trace_record_stop(app);
+}
+
+// ============================================================
+// Storage worker side
+// ============================================================
+bool trace_write(Storage* storage, const uint8_t* data, uint16_t len) {
+    storage_simply_mkdir(storage, APP_DATA_PATH(""));
+    File* file = storage_file_alloc(storage);
+    bool ok = false;
+    if(storage_file_open(file, TRACE_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS))
+        ok = storage_file_write(file, data, len) == len;
+    storage_file_close(file);
+    storage_file_free(file);
+    return ok;
+}
+
+// Fills app->trace; the main thread keeps out until the completion event
+bool trace_load(CoffeeApp* app) {
+    AppTrace* t = &app->trace;
+    uint8_t* buf = malloc(TRACE_BUF_SIZE);
+    if(!buf) return false;
+
+    File* file = storage_file_alloc(app->storage);
+    size_t len = 0;
+    if(storage_file_open(file, TRACE_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        uint16_t n;
+        while(len < TRACE_BUF_SIZE &&
+              (n = storage_file_read(file, buf + len, (uint16_t)(TRACE_BUF_SIZE - len))) > 0)
+            len += n;
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+
+    bool auto_adv;
+    if(!trace_check_header(buf, len, &auto_adv)) {
+        free(buf);
+        return false;
+    }
+    t->buf = buf;
+    t->count = (uint16_t)((len - TRACE_HEADER_SIZE) / TRACE_REC_SIZE);
+    return true;
+}
+
+// ============================================================
+// Replay: a thread posts the recorded inputs at their original
+// spacing (divided by speed) through the main queue
+// ============================================================
+static bool replay_post(CoffeeApp* app, AppEvent* ev) {
+    while(!app->trace.stop) {
+        if(furi_message_queue_put(app->queue, ev, 100) == FuriStatusOk) return true;
+    }
+    return false;
+}
+
+static int32_t replay_worker(void* ctx) {
+    CoffeeApp* app = ctx;
+    AppTrace* t = &app->trace;
+
+    for(uint16_t i = 0; i < t->count && !t->stop; i++) {
+        AppEvent ev = {.type = AppEventReplay};
+        uint32_t dt;
+        bool is_event = trace_decode(t->buf + TRACE_HEADER_SIZE + i * TRACE_REC_SIZE, &dt, &ev.input);
+
+        // Sleep in slices so a stop request is seen promptly
+        uint32_t wait = dt / t->speed;
+        while(wait > 0 && !t->stop) {
+            uint32_t slice = wait > 50 ? 50 : wait;
+            furi_delay_ms(slice);
+            wait -= slice;
+        }
+        if(!is_event) continue;
+        ev.tick = furi_get_tick();
+        if(!replay_post(app, &ev)) break;
+    }
+
+    if(!t->stop) {
+        AppEvent done = {.type = AppEventReplayDone, .tick = furi_get_tick()};
+        replay_post(app, &done);
+    }
+    return 0;
+}
+
+void trace_replay_start(CoffeeApp* app) {
+    AppTrace* t = &app->trace;
+    t->stop = false;
+    t->mode = TraceReplaying;
+    t->thread = furi_thread_alloc_ex("CoffeeReplay", 1024, replay_worker, app);
+    furi_thread_start(t->thread);
+}
+
+void trace_replay_stop(CoffeeApp* app) {
+    AppTrace* t = &app->trace;
+    if(t->thread) {
+        t->stop = true;
+        furi_thread_join(t->thread);
+        furi_thread_free(t->thread);
+        t->thread = NULL;
+        app->settings = t->user_settings;
+    }
+    free(t->buf);
+    t->buf = NULL;
+    t->count = 0;
+    t->mode = TraceIdle;
+}
+
+// On exit a recording is still saved; a replay is cut short
+void trace_shutdown(CoffeeApp* app) {
+    if(app->trace.mode == TraceRecording) trace_record_stop(app);
+    else if(app->trace.mode == TraceReplaying) trace_replay_stop(app);
+}